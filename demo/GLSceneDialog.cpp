@@ -90,8 +90,6 @@ GLSceneDialog::~GLSceneDialog()
 // Sphere at random position
 void myScene::Create_GLScene(void)
 {
-  TVector3D p;
-
   // Clear existing object
   ClearObject3D();
 
@@ -103,13 +101,18 @@ void myScene::Create_GLScene(void)
   AddObject3D(axis);
 
   // Sphere at random position, random color
-  for (int i=0; i<200; i++)
+  // The positions and the colors are drawn in parallel, the same seeds give the same scene
+  const int count = 200;
+  std::vector<TVector3D> positions(count);
+  std::vector<TVector4D> colors(count);
+  RandomPositions(positions.data(), count, TVector3D(-10, -10, -10), TVector3D(10, 10, 10), 1234);
+  RandomColors(colors.data(), count, 4321);
+  for (int i=0; i<count; i++)
   {
-  	p = {10.0f * GLRand(), 10.0f * GLRand(), 10.0f * GLRand()};
   	GLfloat r = 0.5; // Sphere
 //  	TVector3D r = TVector3D(GLRand(2.0), GLRand(2.0), GLRand(2.0)); // Ellipse
-  	TSphere *sphere = new TSphere(r, 36, 18, p);
-  	sphere->GetMaterial().SetColor(mfFront, msDiffuse, RandomColor());
+  	TSphere *sphere = new TSphere(r, 36, 18, positions[i]);
+  	sphere->GetMaterial().SetColor(mfFront, msDiffuse, colors[i]);
   	AddObject3D(sphere);
   }
 }
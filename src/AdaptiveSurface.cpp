@@ -0,0 +1,446 @@
+#include "AdaptiveSurface.h"
+#include <algorithm>
+#include <cstring>
+#include <queue>
+
+TAdaptiveSurface::TAdaptiveSurface(GLuint maxEvaluations, const TVector3D &pos) : TObject3D(pos)
+{
+	ObjectType = otAdaptiveSurface;
+
+	this->maxEvaluations = maxEvaluations;
+	tolerance = 0.001;
+	maxLevel = 10;
+	evaluations = 0;
+	_xMin = _yMin = 0.0;
+	stepX = stepY = 1.0;
+	Minimum = Maximum = 0.0;
+	SurfaceComputed = false;
+	vertexCount = 0;
+	indiceLength = 0;
+
+	useNormal = true;
+
+	material.SetColor(mfFront, msAmbient, {0.1, 0.1, 0.8, 1.0});
+	material.SetColor(mfFront, msDiffuse, GLColor_blue);
+
+	material.SetColor(mfBack, msAmbient, {0.2, 0.2, 0.2, 1.0});
+	material.SetColor(mfBack, msDiffuse, {0.8, 0.8, 0.8, 1.0});
+
+	DoPosition = true;
+}
+
+TAdaptiveSurface::~TAdaptiveSurface()
+{
+	FreeMesh();
+}
+
+/**
+ * Finest level of the quadtree, the lattice of the function has 2^level + 1 points
+ * along X and Y (default 10)
+ */
+void TAdaptiveSurface::SetMaxLevel(GLuint level)
+{
+	maxLevel = std::min(std::max(level, (GLuint) ADAPTIVE_BASE_LEVEL), (GLuint) ADAPTIVE_MAX_LEVEL);
+}
+
+/**
+ * The gradient is applied with a two colors color map
+ */
+void TAdaptiveSurface::SetColor(const TVector4D &begin, const TVector4D &end)
+{
+	SetColorMap(TColorMap(begin, end));
+}
+
+/**
+ * The color map is applied to the height of the vertex instead of the material
+ */
+void TAdaptiveSurface::ColorMapChanged(void)
+{
+	SetUseMaterial(false);
+}
+
+void TAdaptiveSurface::SetNormal(bool use)
+{
+	useNormal = use;
+}
+
+void TAdaptiveSurface::InitializeSurface(double xMin, double xMax, double yMin, double yMax)
+{
+	SurfaceComputed = false;
+	FreeMesh();
+	if (FunctionZ == NULL)
+		return;
+
+	const GLuint n = 1 << maxLevel;
+	_xMin = xMin;
+	_yMin = yMin;
+	stepX = (xMax - xMin) / n;
+	stepY = (yMax - yMin) / n;
+
+	try
+	{
+		Refine();
+		Balance();
+		Triangulate();
+		SurfaceComputed = (indiceLength > 0);
+	} catch (...)
+	{
+
+	}
+
+	// Only the mesh is needed now
+	evaluations = (GLuint) samples.size();
+	samples.clear();
+	splitCells.clear();
+}
+
+/**
+ * The function at the point (x, y) of the lattice, evaluated only once
+ */
+GLfloat TAdaptiveSurface::Sample(GLuint x, GLuint y)
+{
+	const uint64_t key = ((uint64_t) x << 32) | y;
+	std::unordered_map<uint64_t, GLfloat>::const_iterator it = samples.find(key);
+	if (it != samples.end())
+		return it->second;
+
+	const GLfloat z = (GLfloat) FunctionZ(_xMin + x * stepX, _yMin + y * stepY);
+	if (samples.empty())
+		Minimum = Maximum = z;
+	else
+	{
+		if (z < Minimum) Minimum = z;
+		if (z > Maximum) Maximum = z;
+	}
+	samples[key] = z;
+	return z;
+}
+
+/**
+ * Max of the second differences (xx, yy and xy) on the 3 x 3 points of the cell.
+ * These are the points of the 4 children, so a split evaluates only the points
+ * of the children.
+ */
+GLfloat TAdaptiveSurface::CellError(GLuint level, GLuint i, GLuint j)
+{
+	const GLuint s = 1 << (maxLevel - level);
+	const GLuint h = s >> 1;
+	const GLuint x0 = i * s;
+	const GLuint y0 = j * s;
+
+	GLfloat z[3][3];
+	for (int b = 0; b < 3; b++)
+		for (int a = 0; a < 3; a++)
+			z[a][b] = Sample(x0 + a * h, y0 + b * h);
+
+	GLfloat error = fabs(z[0][0] - z[2][0] - z[0][2] + z[2][2]) * 0.25f;
+	for (int k = 0; k < 3; k++)
+	{
+		error = std::max(error, (GLfloat) fabs(z[0][k] - 2.0f * z[1][k] + z[2][k]));
+		error = std::max(error, (GLfloat) fabs(z[k][0] - 2.0f * z[k][1] + z[k][2]));
+	}
+	return error;
+}
+
+/**
+ * Split the cell with the biggest error while it is over the tolerance and the
+ * budget allows it
+ */
+void TAdaptiveSurface::Refine(void)
+{
+	samples.clear();
+	splitCells.clear();
+	Minimum = Maximum = 0.0;
+
+	// The base levels are always split
+	for (GLuint l = 0; l < ADAPTIVE_BASE_LEVEL; l++)
+		for (GLuint j = 0; j < ((GLuint) 1 << l); j++)
+			for (GLuint i = 0; i < ((GLuint) 1 << l); i++)
+				splitCells.insert(CellKey(l, i, j));
+
+	std::priority_queue<TAdaptiveCell> queue;
+	const GLuint n = 1 << ADAPTIVE_BASE_LEVEL;
+	for (GLuint j = 0; j < n; j++)
+		for (GLuint i = 0; i < n; i++)
+			queue.push({ADAPTIVE_BASE_LEVEL, i, j, CellError(ADAPTIVE_BASE_LEVEL, i, j)});
+
+	while (!queue.empty())
+	{
+		const TAdaptiveCell cell = queue.top();
+		if (cell.error <= tolerance * (Maximum - Minimum))
+			break;
+
+		// The children of the finest level are not evaluated, else a split needs
+		// at most 16 new points (5 x 5 points of the children minus the 3 x 3 of the cell)
+		const GLuint level = cell.level + 1;
+		if ((level < maxLevel) && (samples.size() + 16 > maxEvaluations))
+			break;
+
+		queue.pop();
+		splitCells.insert(CellKey(cell.level, cell.i, cell.j));
+		if (level == maxLevel)
+			continue;
+
+		for (GLuint b = 0; b < 2; b++)
+			for (GLuint a = 0; a < 2; a++)
+			{
+				const GLuint i = 2 * cell.i + a;
+				const GLuint j = 2 * cell.j + b;
+				queue.push({level, i, j, CellError(level, i, j)});
+			}
+	}
+}
+
+/**
+ * Split the cells until two neighbour leaves differ by one level at most.
+ * That is the 4 neighbours of a split cell exist (their parent is split).
+ */
+void TAdaptiveSurface::Balance(void)
+{
+	std::vector<TAdaptiveCell> pending;
+	pending.reserve(splitCells.size());
+	for (const uint64_t key : splitCells)
+		pending.push_back({(GLuint) (key >> 40), (GLuint) ((key >> 20) & 0xFFFFF), (GLuint) (key & 0xFFFFF), 0.0f});
+
+	const int neighbour[4][2] = {{-1, 0}, {1, 0}, {0, -1}, {0, 1}};
+	while (!pending.empty())
+	{
+		const TAdaptiveCell cell = pending.back();
+		pending.pop_back();
+		if (cell.level == 0)
+			continue;
+
+		const int n = 1 << cell.level;
+		for (int k = 0; k < 4; k++)
+		{
+			const int ni = (int) cell.i + neighbour[k][0];
+			const int nj = (int) cell.j + neighbour[k][1];
+			if ((ni < 0) || (ni >= n) || (nj < 0) || (nj >= n))
+				continue;
+
+			// The deepest existing ancestor of the neighbour
+			GLuint l = cell.level;
+			while ((l > 0) && (splitCells.count(CellKey(l - 1, ni >> (cell.level - l + 1), nj >> (cell.level - l + 1))) == 0))
+				l--;
+
+			// Split it down to the parent of the neighbour
+			for (; l < cell.level; l++)
+			{
+				const TAdaptiveCell split = {l, (GLuint) ni >> (cell.level - l), (GLuint) nj >> (cell.level - l), 0.0f};
+				splitCells.insert(CellKey(split.level, split.i, split.j));
+				pending.push_back(split);
+			}
+		}
+	}
+}
+
+/**
+ * Two triangles for a leaf, or a fan from its center if a neighbour is finer
+ * (the middle of the common edge is a vertex of the neighbour).
+ * The normals are the mean of the normals of the triangles weighted by their area.
+ */
+void TAdaptiveSurface::Triangulate(void)
+{
+	std::unordered_map<uint64_t, GLuint> index;
+	std::vector<TVertex> vertex;
+	std::vector<GLuint> triangle;
+
+	auto vertexIndex = [&](GLuint x, GLuint y) -> GLuint
+	{
+		const uint64_t key = ((uint64_t) x << 32) | y;
+		std::unordered_map<uint64_t, GLuint>::const_iterator it = index.find(key);
+		if (it != index.end())
+			return it->second;
+
+		TVertex v;
+		v.SetVertice(_xMin + x * stepX, _yMin + y * stepY, Sample(x, y));
+		vertex.push_back(v);
+		index[key] = (GLuint) (vertex.size() - 1);
+		return (GLuint) (vertex.size() - 1);
+	};
+
+	std::vector<TAdaptiveCell> stack = {{0, 0, 0, 0.0f}};
+	while (!stack.empty())
+	{
+		const TAdaptiveCell cell = stack.back();
+		stack.pop_back();
+
+		if (splitCells.count(CellKey(cell.level, cell.i, cell.j)) != 0)
+		{
+			for (GLuint b = 0; b < 2; b++)
+				for (GLuint a = 0; a < 2; a++)
+					stack.push_back({cell.level + 1, 2 * cell.i + a, 2 * cell.j + b, 0.0f});
+			continue;
+		}
+
+		const GLuint n = 1 << cell.level;
+		const GLuint s = 1 << (maxLevel - cell.level);
+		const GLuint h = s >> 1;
+		const GLuint x0 = cell.i * s, x1 = x0 + s;
+		const GLuint y0 = cell.j * s, y1 = y0 + s;
+
+		// Finer neighbours (bottom, right, top, left)
+		const bool bottom = (cell.j > 0) && (splitCells.count(CellKey(cell.level, cell.i, cell.j - 1)) != 0);
+		const bool right = (cell.i < n - 1) && (splitCells.count(CellKey(cell.level, cell.i + 1, cell.j)) != 0);
+		const bool top = (cell.j < n - 1) && (splitCells.count(CellKey(cell.level, cell.i, cell.j + 1)) != 0);
+		const bool left = (cell.i > 0) && (splitCells.count(CellKey(cell.level, cell.i - 1, cell.j)) != 0);
+
+		if (!(bottom || right || top || left))
+		{
+			// Same triangles as TSurface : (V0, V1, VsizeX), (V1, VsizeX+1, VsizeX)
+			const GLuint v00 = vertexIndex(x0, y0);
+			const GLuint v10 = vertexIndex(x1, y0);
+			const GLuint v01 = vertexIndex(x0, y1);
+			const GLuint v11 = vertexIndex(x1, y1);
+			triangle.insert(triangle.end(), {v00, v10, v01, v10, v11, v01});
+			continue;
+		}
+
+		// Border of the cell counterclockwise
+		GLuint border[8];
+		int count = 0;
+		border[count++] = vertexIndex(x0, y0);
+		if (bottom)
+			border[count++] = vertexIndex(x0 + h, y0);
+		border[count++] = vertexIndex(x1, y0);
+		if (right)
+			border[count++] = vertexIndex(x1, y0 + h);
+		border[count++] = vertexIndex(x1, y1);
+		if (top)
+			border[count++] = vertexIndex(x0 + h, y1);
+		border[count++] = vertexIndex(x0, y1);
+		if (left)
+			border[count++] = vertexIndex(x0, y0 + h);
+
+		const GLuint center = vertexIndex(x0 + h, y0 + h);
+		for (int k = 0; k < count; k++)
+			triangle.insert(triangle.end(), {center, border[k], border[(k + 1) % count]});
+	}
+
+	// Area weighted normals
+	for (size_t t = 0; t < triangle.size(); t += 3)
+	{
+		const TGLfloat3D &a = vertex[triangle[t]].vertice;
+		const TGLfloat3D &b = vertex[triangle[t + 1]].vertice;
+		const TGLfloat3D &c = vertex[triangle[t + 2]].vertice;
+		const TVector3D normal = TVector3D(b.X - a.X, b.Y - a.Y, b.Z - a.Z) ^ TVector3D(c.X - a.X, c.Y - a.Y, c.Z - a.Z);
+		for (int k = 0; k < 3; k++)
+		{
+			TGLfloat3D &norm = vertex[triangle[t + k]].normal;
+			norm.X += normal.X;
+			norm.Y += normal.Y;
+			norm.Z += normal.Z;
+		}
+	}
+
+	vertexCount = (GLuint) vertex.size();
+	indiceLength = (GLuint) triangle.size();
+	vertices = new TVertex[vertexCount];
+	for (GLuint k = 0; k < vertexCount; k++)
+	{
+		TVector3D norm(vertex[k].normal.X, vertex[k].normal.Y, vertex[k].normal.Z);
+		norm.Normalize();
+		vertices[k].SetVertice(vertex[k].vertice);
+		vertices[k].SetNormal(norm.X, norm.Y, norm.Z);
+	}
+	indices = new GLuint[indiceLength];
+	memcpy(indices, triangle.data(), SIZE_UINT(indiceLength));
+
+#ifdef USE_VBO
+	initOGL();
+	vboId = createVertexVBO(vertices, vertexCount, vertexFormat);
+	iboId = createVBO(indices, SIZE_UINT(indiceLength), GL_ELEMENT_ARRAY_BUFFER);
+	if ((vboId == 0) || (iboId == 0))
+		std::cout << "[WARNING] VBO array not created for AdaptiveSurface." << std::endl;
+	else
+	{
+		DeleteAndNull(vertices);
+		DeleteAndNull(indices);
+	}
+#endif
+}
+
+void TAdaptiveSurface::FreeMesh(void)
+{
+	DeleteAndNull(vertices);
+	DeleteAndNull(indices);
+#ifdef USE_VBO
+	DeleteAndNullVBO(1, vboId);
+	DeleteAndNullVBO(1, iboId);
+#endif
+	vertexCount = 0;
+	indiceLength = 0;
+}
+
+void TAdaptiveSurface::DoDisplay(TDisplayMode mode __attribute__((unused)))
+{
+	if (!SurfaceComputed)
+		return;
+
+	glDisable(GL_CULL_FACE);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	if (useNormal)
+		glEnableClientState(GL_NORMAL_ARRAY);
+	// The height of the vertex is the texture coordinate of the color map
+	if (colorMap != NULL)
+	{
+		BindColorMap(colorMap, Minimum, Maximum);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	}
+
+#ifdef USE_VBO
+
+	if ((vboId != 0) && (iboId != 0))
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, vboId);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboId);
+
+		setVertexPointers(vertexFormat, useNormal, colorMap != NULL);
+		glDrawElements(GL_TRIANGLES, indiceLength, GL_UNSIGNED_INT, (GLvoid*) 0);
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+	else
+
+#endif
+	if (vertices != NULL)
+	{
+		glVertexPointer(3, GL_FLOAT, SIZE_VERTEX(1), &vertices[0].vertice);
+		if (useNormal)
+			glNormalPointer(GL_FLOAT, SIZE_VERTEX(1), &vertices[0].normal);
+		if (colorMap != NULL)
+			glTexCoordPointer(1, GL_FLOAT, SIZE_VERTEX(1), &vertices[0].vertice.Z);
+		glDrawElements(GL_TRIANGLES, indiceLength, GL_UNSIGNED_INT, &indices[0]);
+	}
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	if (useNormal)
+		glDisableClientState(GL_NORMAL_ARRAY);
+	if (colorMap != NULL)
+	{
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		colorMap->Unbind();
+	}
+
+	glEnable(GL_CULL_FACE);
+}
+
+/**
+ * The domain of the surface and the range of the samples
+ */
+bool TAdaptiveSurface::GetBounds(TVector3D &boxMin, TVector3D &boxMax)
+{
+	if (!SurfaceComputed)
+		return false;
+
+	const GLuint n = 1 << maxLevel;
+	boxMin = TVector3D(_xMin, _yMin, Minimum);
+	boxMax = TVector3D(_xMin + n * stepX, _yMin + n * stepY, Maximum);
+	return true;
+}
+
+// ********************************************************************************
+// End of file
+// ********************************************************************************
@@ -0,0 +1,147 @@
+#ifndef _ADAPTIVE_SURFACE_H
+#define _ADAPTIVE_SURFACE_H
+
+#include "Object3D.h"
+#include "Surface.h"
+#include "ColorMap.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <cstdint>
+
+namespace GLScene
+{
+
+// The quadtree starts with 2^ADAPTIVE_BASE_LEVEL x 2^ADAPTIVE_BASE_LEVEL cells
+#define ADAPTIVE_BASE_LEVEL	2
+#define ADAPTIVE_MAX_LEVEL	16
+
+/**
+ * A cell of the quadtree waiting to be refined
+ */
+typedef struct TAdaptiveCell
+{
+	public:
+		GLuint level;
+		GLuint i, j;   // Position of the cell in the cells of its level
+		GLfloat error; // Max second difference of the function over the cell
+
+		bool operator <(const TAdaptiveCell &cell) const
+		{
+			return (error < cell.error);
+		}
+} TAdaptiveCell;
+
+/**
+ * TAdaptiveSurface class
+ * A surface z = f(x, y) sampled where it is needed instead of on a regular grid.
+ * Params: maxEvaluations, max number of calls of the function (default 65536)
+ * Params: position (default (0,0,0))
+ * eg : setFunctionZ([](double x, double y) {return exp(-20 * (x * x + y * y));});
+ *      InitializeSurface(-5, 5, -5, 5);
+ * The domain is a quadtree. The cell with the biggest second differences is split first
+ * until the second differences are less than the tolerance (relative to the range of z)
+ * or the budget of evaluations is reached. The quadtree is then balanced (neighbour
+ * cells differ by one level at most) and a cell that has a finer neighbour is drawn with
+ * a fan from its center, so the triangulation is crack free.
+ * The function is only evaluated on the lattice of the finest level (SetMaxLevel),
+ * each point once. The balancing may need a few more evaluations than the budget.
+ */
+class TAdaptiveSurface: public TObject3D, public TColorMapped
+{
+	public:
+		TAdaptiveSurface(GLuint maxEvaluations = 65536, const TVector3D &pos = GLDefaultPosition);
+		virtual ~TAdaptiveSurface();
+
+		virtual bool GetBounds(TVector3D &boxMin, TVector3D &boxMax);
+
+		void setFunctionZ(TFunctionZ fonc)
+		{
+			FunctionZ = fonc;
+		}
+		void InitializeSurface(double xMin, double xMax, double yMin, double yMax);
+
+		/// Max number of calls of the function
+		void SetMaxEvaluations(GLuint count)
+		{
+			maxEvaluations = count;
+		}
+
+		/// Max second difference allowed, relative to the range of z (default 0.001)
+		void SetTolerance(double tolerance)
+		{
+			this->tolerance = tolerance;
+		}
+
+		void SetMaxLevel(GLuint level);
+
+		void SetColor(const TVector4D &begin, const TVector4D &end);
+		void SetNormal(bool use);
+
+		/// Number of calls of the function by the last InitializeSurface
+		GLuint GetEvaluations(void)
+		{
+			return evaluations;
+		}
+
+		GLuint GetTriangleCount(void)
+		{
+			return indiceLength / 3;
+		}
+
+		double getMinimum(void)
+		{
+			return Minimum;
+		}
+		double getMaximum(void)
+		{
+			return Maximum;
+		}
+
+	protected:
+		void DoDisplay(TDisplayMode mode = dmRender);
+		void ColorMapChanged(void);
+
+	private:
+		TFunctionZ FunctionZ = NULL;
+		double _xMin, _yMin;
+		double stepX, stepY;  // Step of the lattice of the finest level
+		double Minimum, Maximum;
+		bool SurfaceComputed;
+
+		GLuint maxEvaluations;
+		double tolerance;
+		GLuint maxLevel;
+		GLuint evaluations;
+
+		std::unordered_map<uint64_t, GLfloat> samples; // Function on the lattice
+		std::unordered_set<uint64_t> splitCells;       // Cells that have 4 children
+
+		TVertex *vertices = NULL;
+		GLuint *indices = NULL;
+		GLuint vertexCount;
+		GLuint indiceLength;
+#ifdef USE_VBO
+		GLuint vboId = 0;  // ID of VBO for vertex and normal interleaved arrays
+		GLuint iboId = 0;  // ID of VBO for index array
+#endif
+
+		bool useNormal;
+
+		inline uint64_t CellKey(GLuint level, GLuint i, GLuint j) const
+		{
+			return ((uint64_t) level << 40) | ((uint64_t) i << 20) | j;
+		}
+
+		GLfloat Sample(GLuint x, GLuint y);
+		GLfloat CellError(GLuint level, GLuint i, GLuint j);
+		void Refine(void);
+		void Balance(void);
+		void Triangulate(void);
+		void FreeMesh(void);
+};
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _ADAPTIVE_SURFACE_H
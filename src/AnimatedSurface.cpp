@@ -0,0 +1,446 @@
+#include "AnimatedSurface.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+#ifdef USE_VBO
+/**
+ * Persistent mapping (glBufferStorage) is core since OpenGL 4.4
+ */
+static bool PersistentMappingSupported(void)
+{
+	static int supported = -1;
+
+	if (supported < 0)
+	{
+		int major = 0, minor = 0;
+		const char *version = (const char*) glGetString(GL_VERSION);
+		if (version != NULL)
+			sscanf(version, "%d.%d", &major, &minor);
+		supported = ((major > 4) || ((major == 4) && (minor >= 4))) ? 1 : 0;
+#if defined(_WIN32) && !defined(USE_GLEW)
+		if ((glBufferStorage == NULL) || (glMapBufferRange == NULL) || (glFenceSync == NULL))
+			supported = 0;
+#endif
+	}
+	return (supported == 1);
+}
+#endif
+
+TAnimatedSurface::TAnimatedSurface(GLuint dimX, GLuint dimY, bool useMatColor, const TVector3D &pos) :
+		TSurface(dimX, dimY, useMatColor, pos)
+{
+	frameTime = requestedTime = backTime = 0.0;
+	timeRequested = false;
+	backMinimum = backMaximum = 0.0;
+	backFailed = false;
+	frameReady = false;
+	working = false;
+#ifdef USE_VBO
+	buffersCreated = false;
+	persistent = false;
+	front = 0;
+#endif
+}
+
+TAnimatedSurface::~TAnimatedSurface()
+{
+	WaitFrame();
+#ifdef USE_VBO
+	FreeBuffers();
+#endif
+	FreeFrames();
+}
+
+void TAnimatedSurface::SetDimension(GLuint dimX, GLuint dimY, bool recompute)
+{
+	WaitFrame();
+#ifdef USE_VBO
+	FreeBuffers();
+#endif
+	FreeFrames();
+	TSurface::SetDimension(dimX, dimY, false);
+
+	if (recompute && min_max)
+		InitializeAnimation(_xMin, _xMax, _yMin, _yMax, frameTime);
+}
+
+void TAnimatedSurface::setFunctionZT(TFunctionZT fonc)
+{
+	// The workers use the function
+	WaitFrame();
+	FunctionZT = fonc;
+}
+
+/**
+ * The workers read the bounds of the grid
+ */
+void TAnimatedSurface::InitializeSurface(double xMin, double xMax, double yMin, double yMax)
+{
+	WaitFrame();
+	TSurface::InitializeSurface(xMin, xMax, yMin, yMax);
+}
+
+/**
+ * Allocate the frames and compute the first one at the given time
+ */
+void TAnimatedSurface::InitializeAnimation(double xMin, double xMax, double yMin, double yMax, double time)
+{
+	WaitFrame();
+	SurfaceComputed = false;
+	if (FunctionZT == NULL)
+		return;
+
+	_xMin = xMin;
+	_xMax = xMax;
+	_yMin = yMin;
+	_yMax = yMax;
+	min_max = true;
+
+#ifdef USE_VBO
+	FreeBuffers();
+#endif
+	FreeArray();
+	FreeFrames();
+	surface = new TVector3D[sizeLength];
+	normals = new TVector3D[sizeLength];
+	backSurface = new TVector3D[sizeLength];
+	backNormals = new TVector3D[sizeLength];
+
+	frameTime = time;
+	timeRequested = false;
+	SurfaceComputed = ComputeFrame(time, surface, normals, Minimum, Maximum);
+}
+
+/**
+ * Request the frame at the given time. It is computed in background and displayed when ready.
+ * If a frame is already in progress, only the last requested time is computed after it.
+ */
+void TAnimatedSurface::SetTime(double time)
+{
+	requestedTime = time;
+	timeRequested = true;
+}
+
+/**
+ * Compute the vertex and the normals of the frame at the given time with all the threads
+ * (the small grids stay on one thread, see GRID_MIN_ROWS).
+ * Return false if the function failed.
+ */
+bool TAnimatedSurface::ComputeFrame(double time, TVector3D *vertex, TVector3D *norm, double &min, double &max)
+{
+	const TFunctionZT func = FunctionZT;
+	const GLuint dimX = sizeX, dimY = sizeY;
+	const double xMin = _xMin;
+	const double yMin = _yMin;
+	const double stepX = (_xMax - _xMin) / (sizeX - 1);
+	const double stepY = (_yMax - _yMin) / (sizeY - 1);
+	std::vector<double> rowMin(sizeY), rowMax(sizeY);
+	std::atomic<bool> failed(false);
+
+	ParallelFor(0, sizeY, [&](size_t begin, size_t end)
+	{
+		try
+		{
+			for (size_t j = begin; j < end; j++)
+			{
+				const double y = yMin + j * stepY;
+				size_t k = j * dimX;
+				double z = func(xMin, y, time);
+				double lo = z, hi = z;
+				for (GLuint i = 0; i < dimX; i++, k++)
+				{
+					const double x = xMin + i * stepX;
+					if (i > 0)
+						z = func(x, y, time);
+					if (z < lo)
+						lo = z;
+					else if (z > hi)
+						hi = z;
+					vertex[k] = TVector3D(x, y, z);
+				}
+				rowMin[j] = lo;
+				rowMax[j] = hi;
+			}
+		} catch (...)
+		{
+			failed = true;
+		}
+	}, GRID_MIN_ROWS(sizeX));
+
+	if (failed)
+		return false;
+
+	// The vertex shader computes the normals
+	if (!useDisplacement)
+	{
+		ParallelFor(0, sizeY, [vertex, norm, dimX, dimY](size_t begin, size_t end)
+		{
+			ComputeGridNormals(vertex, &norm[begin * dimX], dimX, dimY, begin, end);
+		}, GRID_MIN_ROWS(sizeX));
+	}
+
+	min = *std::min_element(rowMin.begin(), rowMin.end());
+	max = *std::max_element(rowMax.begin(), rowMax.end());
+	return true;
+}
+
+/**
+ * Launch the workers for the requested time in the back frame.
+ * With persistent mapping, the back buffers must not be used anymore by the GPU.
+ */
+void TAnimatedSurface::StartFrame(void)
+{
+	if (!timeRequested || working || !SurfaceComputed)
+		return;
+
+	void *vertexBuffer = NULL;
+	void *normalBuffer = NULL;
+#ifdef USE_VBO
+	if (persistent)
+	{
+		WaitBuffer(1 - front);
+		vertexBuffer = mappedSurface[1 - front];
+		normalBuffer = mappedNormals[1 - front];
+	}
+#endif
+
+	backTime = requestedTime;
+	timeRequested = false;
+	frameReady = false;
+	working = true;
+	worker = std::thread([this, vertexBuffer, normalBuffer]()
+	{
+		backFailed = !ComputeFrame(backTime, backSurface, backNormals, backMinimum, backMaximum);
+		if (!backFailed && (vertexBuffer != NULL))
+		{
+			memcpy(vertexBuffer, (void*) backSurface, SIZE_FLOAT3D(sizeLength));
+			memcpy(normalBuffer, (void*) backNormals, SIZE_FLOAT3D(sizeLength));
+		}
+		frameReady = true;
+	});
+}
+
+/**
+ * Wait for the workers and discard the frame
+ */
+void TAnimatedSurface::WaitFrame(void)
+{
+	if (working)
+	{
+		worker.join();
+		working = false;
+		frameReady = false;
+	}
+}
+
+/**
+ * The back frame become the displayed frame
+ */
+void TAnimatedSurface::SwapFrame(void)
+{
+	std::swap(surface, backSurface);
+	std::swap(normals, backNormals);
+	Minimum = backMinimum;
+	Maximum = backMaximum;
+	frameTime = backTime;
+	HeightsChanged();
+
+#ifdef USE_VBO
+	heightsUpdated = false;
+	if (buffersCreated && createVBO_OK)
+	{
+		if (persistent)
+		{
+			// Already written by the workers
+			front = 1 - front;
+			vboId = vbo[front];
+			nboId = nbo[front];
+		}
+		else
+		{
+			// Orphan the storage so the driver does not wait for the previous frame
+			const GLsizeiptr size = SIZE_FLOAT3D(sizeLength);
+			glBindBuffer(GL_ARRAY_BUFFER, vboId);
+			glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, size, surface);
+			glBindBuffer(GL_ARRAY_BUFFER, nboId);
+			glBufferData(GL_ARRAY_BUFFER, size, NULL, GL_STREAM_DRAW);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, size, normals);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+	}
+#endif
+}
+
+/**
+ * The buffers are created at the next display (see SetDisplacement)
+ */
+void TAnimatedSurface::InitializeArray(const TVector3D *norm __attribute__((unused)))
+{
+	WaitFrame();
+	HeightsChanged();
+#ifdef USE_VBO
+	FreeBuffers();
+	heightsUpdated = false;
+#endif
+}
+
+/**
+ * The workers read useDisplacement (no normals with the displacement)
+ */
+void TAnimatedSurface::SetDisplacement(bool use)
+{
+	WaitFrame();
+	TSurface::SetDisplacement(use);
+}
+
+/**
+ * The workers write float normals in the buffers, the format is kept but not used
+ */
+void TAnimatedSurface::SetVertexFormat(TVertexFormat format)
+{
+	TObject3D::SetVertexFormat(format);
+}
+
+void TAnimatedSurface::FreeFrames(void)
+{
+	DeleteAndNull(backSurface);
+	DeleteAndNull(backNormals);
+}
+
+#ifdef USE_VBO
+/**
+ * Two persistently mapped buffers (vertex and normals) if supported, else one streamed buffer
+ */
+void TAnimatedSurface::CreateBuffers(void)
+{
+	initOGL();
+	FreeBuffers();
+
+	const GLsizeiptr size = SIZE_FLOAT3D(sizeLength);
+	persistent = PersistentMappingSupported();
+	if (persistent)
+	{
+		const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		for (int i = 0; i < 2; i++)
+		{
+			glGenBuffers(1, &vbo[i]);
+			glBindBuffer(GL_ARRAY_BUFFER, vbo[i]);
+			glBufferStorage(GL_ARRAY_BUFFER, size, surface, flags);
+			mappedSurface[i] = glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+
+			glGenBuffers(1, &nbo[i]);
+			glBindBuffer(GL_ARRAY_BUFFER, nbo[i]);
+			glBufferStorage(GL_ARRAY_BUFFER, size, normals, flags);
+			mappedNormals[i] = glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+
+			if ((mappedSurface[i] == NULL) || (mappedNormals[i] == NULL))
+				persistent = false;
+		}
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+		if (!persistent)
+		{
+			std::cout << "[WARNING] Persistent mapping failed for AnimatedSurface." << std::endl;
+			FreeBuffers();
+		}
+	}
+
+	if (!persistent)
+	{
+		vbo[0] = createVBO(surface, size, GL_ARRAY_BUFFER, GL_STREAM_DRAW);
+		nbo[0] = createVBO(normals, size, GL_ARRAY_BUFFER, GL_STREAM_DRAW);
+	}
+
+	front = 0;
+	vboId = vbo[0];
+	nboId = nbo[0];
+	packedNormals = false;
+	createVBO_OK = ((vboId != 0) && (nboId != 0) && (gridIndices->iboId != 0));
+	if (!createVBO_OK)
+		std::cout << "[WARNING] VBO array not created for AnimatedSurface." << std::endl;
+	buffersCreated = true;
+}
+
+void TAnimatedSurface::FreeBuffers(void)
+{
+	for (int i = 0; i < 2; i++)
+	{
+		if (fence[i] != NULL)
+		{
+			glDeleteSync(fence[i]);
+			fence[i] = NULL;
+		}
+		// Delete a buffer unmap it
+		DeleteAndNullVBO(1, vbo[i]);
+		DeleteAndNullVBO(1, nbo[i]);
+		mappedSurface[i] = NULL;
+		mappedNormals[i] = NULL;
+	}
+	vboId = nboId = 0;
+	createVBO_OK = false;
+	persistent = false;
+	buffersCreated = false;
+}
+
+/**
+ * Wait until the GPU has finished to draw the buffers
+ */
+void TAnimatedSurface::WaitBuffer(int index)
+{
+	if (fence[index] == NULL)
+		return;
+
+	GLenum result;
+	do
+	{
+		result = glClientWaitSync(fence[index], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000);  // 1 ms
+	} while (result == GL_TIMEOUT_EXPIRED);
+	glDeleteSync(fence[index]);
+	fence[index] = NULL;
+}
+#endif
+
+/**
+ * The colors of the vertex are not recomputed for each frame
+ */
+bool TAnimatedSurface::UseGradientMap(void)
+{
+	return true;
+}
+
+void TAnimatedSurface::DoDisplay(TDisplayMode mode)
+{
+	if (working && frameReady)
+	{
+		worker.join();
+		working = false;
+		if (!backFailed)
+			SwapFrame();
+	}
+
+#ifdef USE_VBO
+	if (SurfaceComputed && !buffersCreated && !useDisplacement)
+		CreateBuffers();
+#endif
+
+	TSurface::DoDisplay(mode);
+
+#ifdef USE_VBO
+	if (persistent)
+	{
+		if (fence[front] != NULL)
+			glDeleteSync(fence[front]);
+		fence[front] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+#endif
+
+	// Compute the next frame while this one is displayed
+	StartFrame();
+}
+
+// ********************************************************************************
+// End of file
+// ********************************************************************************
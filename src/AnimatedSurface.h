@@ -0,0 +1,95 @@
+#ifndef _ANIMATED_SURFACE_H
+#define _ANIMATED_SURFACE_H
+
+#include "Surface.h"
+#include <thread>
+#include <atomic>
+
+namespace GLScene
+{
+
+// The prototype of the function z = f(x, y, t)
+typedef std::function<double(double x, double y, double t)> TFunctionZT;
+
+/**
+ * TAnimatedSurface class
+ * A surface z = f(x, y, t) updated with the time without reallocating anything.
+ * eg : setFunctionZT([](double x, double y, double t) {return sin(x + t) * cos(y);});
+ *      InitializeAnimation(-5, 5, -5, 5);
+ *      then in OnTimer : SetTime(time);
+ * The frame of the requested time is computed by worker threads while the current frame
+ * is displayed, it replaces the current frame as soon as it is ready.
+ * So the function is called by several threads at the same time and must be thread safe.
+ * With VBO and OpenGL 4.4, the frames are written in two persistently mapped buffers
+ * (double buffering with fences). Else the VBO is updated with glBufferSubData.
+ * The colors are given by the color map (SetColor is applied with a two colors color map).
+ * With GPU displacement (SetDisplacement), a new frame is only one texture upload.
+ */
+class TAnimatedSurface: public TSurface
+{
+	public:
+		TAnimatedSurface(GLuint dimX, GLuint dimY, bool useMatColor = true, const TVector3D &pos = GLDefaultPosition);
+		virtual ~TAnimatedSurface();
+
+		void SetDimension(GLuint dimX, GLuint dimY, bool recompute = false);
+
+		void setFunctionZT(TFunctionZT fonc);
+		void InitializeSurface(double xMin, double xMax, double yMin, double yMax);
+		void InitializeAnimation(double xMin, double xMax, double yMin, double yMax, double time = 0.0);
+		void SetTime(double time);
+		void SetDisplacement(bool use);
+		void SetVertexFormat(TVertexFormat format);
+
+		/// The time of the displayed frame
+		double GetTime(void)
+		{
+			return frameTime;
+		}
+
+	protected:
+		void DoDisplay(TDisplayMode mode = dmRender);
+		void InitializeArray(const TVector3D *norm = NULL);
+		bool UseGradientMap(void);
+
+	private:
+		TFunctionZT FunctionZT = NULL;
+		double frameTime;
+		double requestedTime;
+		bool timeRequested;
+
+		// The frame computed by the workers
+		TVector3D *backSurface = NULL;
+		TVector3D *backNormals = NULL;
+		double backTime;
+		double backMinimum, backMaximum;
+		bool backFailed;
+		std::thread worker;
+		std::atomic<bool> frameReady;
+		bool working;
+
+#ifdef USE_VBO
+		bool buffersCreated;
+		bool persistent;
+		int front;  // Index of the displayed buffers
+		GLuint vbo[2] = {0, 0};
+		GLuint nbo[2] = {0, 0};
+		void *mappedSurface[2] = {NULL, NULL};
+		void *mappedNormals[2] = {NULL, NULL};
+		GLsync fence[2] = {NULL, NULL};
+
+		void CreateBuffers(void);
+		void FreeBuffers(void);
+		void WaitBuffer(int index);
+#endif
+
+		bool ComputeFrame(double time, TVector3D *vertex, TVector3D *norm, double &min, double &max);
+		void StartFrame(void);
+		void WaitFrame(void);
+		void SwapFrame(void);
+		void FreeFrames(void);
+};
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _ANIMATED_SURFACE_H
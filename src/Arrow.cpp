@@ -9,9 +9,8 @@ TArrow::TArrow(GLfloat _len, GLfloat _radius, const TVector3D &pos) :
 	arrowPos.Z -= len2 / 2;
 	myCylinder = new TCylinder(len2, _radius, arrowPos);
 
-	arrowPos = GLDefaultPosition;
-	arrowPos.Z += len2 / 2;
-	myCone = new TCone(len2, _radius * 4, arrowPos);
+	// The base of the cone is the top of the cylinder
+	myCone = new TCone(len2, _radius * 4, GLDefaultPosition);
 
 	material.SetColor(mfFront, msAmbient, GLColor_fuchsia);
 	material.SetColor(mfFront, msDiffuse, GLColor_fuchsia);
@@ -29,13 +28,26 @@ TArrow::~TArrow()
 void TArrow::DoDisplay(TDisplayMode mode __attribute__((unused)))
 {
 	glPushMatrix();
-		glTranslated(position.X, position.Y, position.Z);
-		glRotated(angle, axe_angle.X, axe_angle.Y, axe_angle.Z);
+		glMultMatrixf(myCylinder->GetModelMatrix().Array());
 		myCylinder->DoDisplay(mode);
+	glPopMatrix();
+	glPushMatrix();
+		glMultMatrixf(myCone->GetModelMatrix().Array());
 		myCone->DoDisplay(mode);
 	glPopMatrix();
 }
 
+/**
+ * The cone of the arrow is 4 times larger than the cylinder
+ */
+bool TArrow::GetBounds(TVector3D &boxMin, TVector3D &boxMax)
+{
+	const GLfloat r = radius * 4.0;
+	boxMin = TVector3D(-r, -r, -len2);
+	boxMax = TVector3D(r, r, len2);
+	return true;
+}
+
 // ********************************************************************************
 // End of file
 // ********************************************************************************
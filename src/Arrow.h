@@ -21,6 +21,8 @@ class TArrow: public TBaseCylinder
 		TArrow(GLfloat _len, GLfloat _radius, const TVector3D &pos = GLDefaultPosition);
 		virtual ~TArrow();
 
+		virtual bool GetBounds(TVector3D &boxMin, TVector3D &boxMax);
+
 	protected:
 		void DoDisplay(TDisplayMode mode = dmRender);
 
@@ -1,4 +1,5 @@
 #include "Axis.h"
+#include "Tessellation.h"
 
 // unit axis //////////////////////////////////////////////////////////////////
 //    v3
@@ -63,8 +64,8 @@ void TAxis::CreateArrow(void)
 	double phi = atan2(R_Arrow, len);
 	double cos_phi = cos(phi);
 	double sin_phi = sin(phi);
-	double dtheta = (2.0 * PI / arrowDetail);
-	double theta = 0.0;
+	// The unit circle is computed once (at compile time for the usual levels)
+	const TCircleTable circle = UnitCircle(arrowDetail);
 
 	// Top
 	arrow[0].SetVertice(0.0f, 0.0f, len);
@@ -73,8 +74,8 @@ void TAxis::CreateArrow(void)
 	// Cone + base
 	for (GLuint i = 1; i < arrowSize; ++i)
 	{
-		const double cos_theta = cos(theta);
-		const double sin_theta = sin(theta);
+		const double cos_theta = circle.Cos[i - 1];
+		const double sin_theta = circle.Sin[i - 1];
 		const float x = (float) (R_Arrow * cos_theta);
 		const float y = (float) (R_Arrow * sin_theta);
 
@@ -88,8 +89,6 @@ void TAxis::CreateArrow(void)
 		// Base
 		arrow[vertexSize - i].SetVertice(x, y, 0.0f);
 		arrow[vertexSize - i].SetNormal(0.0f, 0.0f, -1.0f);
-
-		theta += dtheta;
 	}
 }
 
@@ -144,6 +143,17 @@ void TAxis::DoDisplay(TDisplayMode mode)
 	glDisableClientState(GL_NORMAL_ARRAY);
 }
 
+/**
+ * The three axes and their arrows (length 0.5, see CreateArrow)
+ */
+bool TAxis::GetBounds(TVector3D &boxMin, TVector3D &boxMax)
+{
+	const GLfloat arrow = thickness * 4.0;
+	boxMin = TVector3D(-arrow, -arrow, -arrow);
+	boxMax = TVector3D(size + 0.5, size + 0.5, size + 0.5);
+	return true;
+}
+
 // ********************************************************************************
 // End of file
 // ********************************************************************************
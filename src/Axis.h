@@ -17,6 +17,8 @@ class TAxis: public TObject3D
 		TAxis(GLfloat len = 10, GLuint detail = 20);
 		virtual ~TAxis();
 
+		virtual bool GetBounds(TVector3D &boxMin, TVector3D &boxMax);
+
 	protected:
 		void virtual DoDisplay(TDisplayMode mode = dmRender);
 
@@ -21,12 +21,28 @@ void TBaseCylinder::ComputeParameters(bool normalize)
 	reduced_pos = direction;
 	if (normalize)
 		reduced_pos.Normalize();
+	orientation = TQuaternion::FromTo(z_direction, reduced_pos);
 	reduced_pos *= len2;
-	axe_angle = {-reduced_pos.Y, reduced_pos.X, 0.0};
-	angle = RADtoDEG * acos(reduced_pos.Z / len2);
 	reduced_pos = position - reduced_pos;
 }
 
+/**
+ * The cylinder is centered on its position and turned to its direction
+ */
+void TBaseCylinder::ComputeModelMatrix(void)
+{
+	TObject3D::ComputeModelMatrix();
+	modelMatrix.Translate(position);
+	modelMatrix *= orientation.ToMatrix();
+}
+
+bool TBaseCylinder::GetBounds(TVector3D &boxMin, TVector3D &boxMax)
+{
+	boxMin = TVector3D(-radius, -radius, -len2);
+	boxMax = TVector3D(radius, radius, len2);
+	return true;
+}
+
 // ********************************************************************************
 // End of file
 // ********************************************************************************
@@ -16,16 +16,17 @@ class TBaseCylinder: public TObject3D
 		TBaseCylinder(GLfloat _len, GLfloat _radius, const TVector3D &pos = GLDefaultPosition);
 		virtual ~TBaseCylinder();
 
+		virtual bool GetBounds(TVector3D &boxMin, TVector3D &boxMax);
+
 	protected:
 		GLfloat len;
 		GLfloat len2;
 		GLfloat radius;
 
-		GLfloat angle;
-		TVector3D axe_angle;
 		TVector3D reduced_pos;
 
 		virtual void ComputeParameters(bool normalize = true);
+		virtual void ComputeModelMatrix(void);
 };
 
 } // namespace GLScene
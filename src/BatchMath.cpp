@@ -0,0 +1,185 @@
+#include "BatchMath.h"
+#include "VectorSIMD.h"
+#include <algorithm>
+#include <atomic>
+
+// The AVX functions are compiled for AVX whatever the options, they are only called
+// when the processor has AVX
+#if defined(VECTOR_SSE) && (defined(__GNUC__) || defined(__clang__))
+	#define BATCH_AVX
+	#include <immintrin.h>
+	#define AVX_TARGET	__attribute__((target("avx")))
+#endif
+
+/**
+ * The functions of a level
+ */
+typedef struct TBatchKernels
+{
+	public:
+		TBatchLevel Level;
+		void (*Range)(const GLfloat *values, size_t count, GLfloat &min, GLfloat &max);
+} TBatchKernels;
+
+// ********************************************************************************
+// Scalar functions, they also do the last values of the SIMD functions
+// ********************************************************************************
+
+static void RangeScalar(const GLfloat *values, size_t count, GLfloat &min, GLfloat &max)
+{
+	for (size_t k = 0; k < count; k++)
+	{
+		min = std::min(min, values[k]);
+		max = std::max(max, values[k]);
+	}
+}
+
+static const TBatchKernels KernelsScalar = {blScalar, RangeScalar};
+
+// ********************************************************************************
+// 4 floats functions (SSE, NEON or scalar TFloat4)
+// ********************************************************************************
+
+static void Range4(const GLfloat *values, size_t count, GLfloat &min, GLfloat &max)
+{
+	const size_t end = count & ~(size_t) 3;
+	if (end > 0)
+	{
+		TFloat4 vmin = Float4Splat(min), vmax = Float4Splat(max);
+		for (size_t k = 0; k < end; k += 4)
+		{
+			const TFloat4 v = Float4LoadU(&values[k]);
+			vmin = Float4Min(vmin, v);
+			vmax = Float4Max(vmax, v);
+		}
+		alignas(16) GLfloat lanes[2][4];
+		Float4Store(lanes[0], vmin);
+		Float4Store(lanes[1], vmax);
+		RangeScalar(lanes[0], 4, min, max);
+		RangeScalar(lanes[1], 4, min, max);
+	}
+	RangeScalar(&values[end], count - end, min, max);
+}
+
+static const TBatchKernels Kernels4 = {blSIMD4, Range4};
+
+// ********************************************************************************
+// 8 floats functions (AVX)
+// ********************************************************************************
+
+#ifdef BATCH_AVX
+
+AVX_TARGET static void Range8(const GLfloat *values, size_t count, GLfloat &min, GLfloat &max)
+{
+	const size_t end = count & ~(size_t) 7;
+	if (end > 0)
+	{
+		__m256 vmin = _mm256_set1_ps(min), vmax = _mm256_set1_ps(max);
+		for (size_t k = 0; k < end; k += 8)
+		{
+			const __m256 v = _mm256_loadu_ps(&values[k]);
+			vmin = _mm256_min_ps(vmin, v);
+			vmax = _mm256_max_ps(vmax, v);
+		}
+		alignas(32) GLfloat lanes[2][8];
+		_mm256_store_ps(lanes[0], vmin);
+		_mm256_store_ps(lanes[1], vmax);
+		RangeScalar(lanes[0], 8, min, max);
+		RangeScalar(lanes[1], 8, min, max);
+	}
+	RangeScalar(&values[end], count - end, min, max);
+}
+
+static const TBatchKernels Kernels8 = {blSIMD8, Range8};
+
+#endif
+
+// ********************************************************************************
+// Dispatch
+// ********************************************************************************
+
+static TBatchLevel BatchDetectLevel(void)
+{
+#ifdef BATCH_AVX
+	// The first batch call may come from a static constructor, before the one of the runtime
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx"))
+		return blSIMD8;
+#endif
+#if defined(VECTOR_SSE) || defined(VECTOR_NEON)
+	return blSIMD4;
+#else
+	return blScalar;
+#endif
+}
+
+/// The best level of the processor, detected once (the local static is thread safe)
+static TBatchLevel BatchBestLevel(void)
+{
+	static const TBatchLevel best = BatchDetectLevel();
+	return best;
+}
+
+static const TBatchKernels* BatchKernels(TBatchLevel level)
+{
+	switch (level)
+	{
+		case blSIMD8:
+#ifdef BATCH_AVX
+			return &Kernels8;
+#else
+			return &Kernels4;
+#endif
+		case blSIMD4:
+			return &Kernels4;
+		default:
+			return &KernelsScalar;
+	}
+}
+
+// NULL until the first batch call or BatchSetLevel
+static std::atomic<const TBatchKernels*> kernels(NULL);
+
+static inline const TBatchKernels* Kernels(void)
+{
+	const TBatchKernels *current = kernels.load(std::memory_order_relaxed);
+	if (current == NULL)
+	{
+		// Several threads may get here at the same time, they all store the same level
+		current = BatchKernels(BatchBestLevel());
+		kernels.store(current, std::memory_order_relaxed);
+	}
+	return current;
+}
+
+TBatchLevel GLScene::BatchGetLevel(void)
+{
+	return Kernels()->Level;
+}
+
+/**
+ * Use the level, or the best level of the processor if it is lower. Return the level used.
+ * Not thread safe, call it when no batch function runs.
+ */
+TBatchLevel GLScene::BatchSetLevel(TBatchLevel level)
+{
+	const TBatchKernels *current = BatchKernels(std::min(level, BatchBestLevel()));
+	kernels.store(current, std::memory_order_relaxed);
+	return current->Level;
+}
+
+// ********************************************************************************
+// Batch functions
+// ********************************************************************************
+
+void GLScene::BatchRange(const GLfloat *values, size_t count, GLfloat &min, GLfloat &max)
+{
+	if (count == 0)
+		return;
+	min = max = values[0];
+	Kernels()->Range(values, count, min, max);
+}
+
+// ********************************************************************************
+// End of file
+// ********************************************************************************
@@ -0,0 +1,28 @@
+#ifndef _BATCH_MATH_H
+#define _BATCH_MATH_H
+
+#include "Vector3D.h"
+#include <cstddef>
+
+namespace GLScene
+{
+
+/**
+ * The instructions used by the batch functions : plain C++, 4 floats (SSE or NEON, see
+ * VectorSIMD.h) or 8 floats (AVX). The best level of the processor is chosen at the first
+ * call, BatchSetLevel can force a lower level (eg to compare them).
+ */
+typedef enum {
+	blScalar, blSIMD4, blSIMD8
+} TBatchLevel;
+
+TBatchLevel BatchGetLevel(void);
+TBatchLevel BatchSetLevel(TBatchLevel level);
+
+/// Min and max of the values (count > 0)
+void BatchRange(const GLfloat *values, size_t count, GLfloat &min, GLfloat &max);
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _BATCH_MATH_H
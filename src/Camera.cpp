@@ -1,8 +1,57 @@
 #include "Camera.h"
+#include <algorithm>
+
+#define CAMERA_MOTION_EPSILON	1.0e-4
+// Min ratio near / far of the fitted depth (the precision of the depth buffer)
+#define CAMERA_DEPTH_RATIO	1.0e-3
+
+static const TVector3D x_direction = {1.0, 0.0, 0.0};
+static const TVector3D y_direction = {0.0, 1.0, 0.0};
+static const TVector3D z_direction = {0.0, 0.0, 1.0};
+
+/**
+ * The point (x, y, z) of the normalized device coordinates back in the world, false if the
+ * point is at infinity
+ */
+static bool Unproject(const TMatrix4 &inverse, GLfloat x, GLfloat y, GLfloat z, TVector3D &point)
+{
+	const GLfloat w = inverse[3] * x + inverse[7] * y + inverse[11] * z + inverse[15];
+	if (fabs(w) < Epsilon)
+		return false;
+	point = inverse.TransformPoint(TVector3D(x, y, z)) / w;
+	return true;
+}
 
 TCamera::TCamera()
 {
+	mode = cmOrbit;
+	damping = 0.0;
+	moving = false;
+
+	viewport[0] = viewport[1] = 0;
+	viewport[2] = viewport[3] = 1;
+
+	// Default view of the scene : (1, 1, 1) in front
+	target.distance = 50.0;
+	target.scale = 1.0;
+	target.center = TVector3D();
+	target.eye = TVector3D();
+	target.yaw = -135.0;
+	target.pitch = -45.0;
+	target.rotation = OrbitRotation(target.yaw, target.pitch);
+	current = target;
+
+	projectionType = cpFrustum;
+	const double defaultVolume[6] = {-1.0, 1.0, -1.0, 1.0, 10.0, 100.0};
+	memcpy(volume, defaultVolume, sizeof(volume));
+	autoDepth = false;
+	depthFitted = false;
+	depthNear = volume[4];
+	depthFar = volume[5];
 
+	viewChanged = true;
+	projectionChanged = true;
+	frustumChanged = true;
 }
 
 TCamera::~TCamera()
@@ -10,43 +59,487 @@ TCamera::~TCamera()
 
 }
 
-void TCamera::draw()
+/**
+ * Change the mode, the view does not change. From the arcball mode, the roll of the
+ * rotation is lost.
+ */
+void TCamera::SetMode(TCameraMode newmode)
+{
+	if (newmode == mode)
+		return;
+
+	EndMotion();
+	if (mode == cmArcball)
+	{
+		// The rotation is Rx(pitch) * Rz(yaw)
+		const TMatrix4 m = target.rotation.ToMatrix();
+		target.yaw = atan2(-m[4], m[0]) * RADtoDEG;
+		target.pitch = atan2(-m[9], m[10]) * RADtoDEG;
+		target.rotation = OrbitRotation(target.yaw, target.pitch);
+	}
+
+	const TVector3D back = target.rotation.Conjugate().Rotate(TVector3D(0.0, 0.0, target.distance)) / target.scale;
+	if (newmode == cmFly)
+		target.eye = back - target.center;
+	else
+		if (mode == cmFly)
+			target.center = back - target.eye;
+
+	mode = newmode;
+	current = target;
+	viewChanged = true;
+}
+
+/* ================================================================== */
+/*                          Projection                                */
+/* ================================================================== */
+
+void TCamera::SetViewport(GLint x, GLint y, GLint width, GLint height)
+{
+	viewport[0] = x;
+	viewport[1] = y;
+	viewport[2] = (width > 0) ? width : 1;
+	viewport[3] = (height > 0) ? height : 1;
+}
+
+void TCamera::SetFrustum(double left, double right, double bottom, double top, double zNear, double zFar)
+{
+	SetVolume(cpFrustum, left, right, bottom, top, zNear, zFar);
+}
+
+/**
+ * Like gluPerspective, fovy in degrees
+ */
+void TCamera::SetPerspective(double fovy, double aspect, double zNear, double zFar)
+{
+	const double top = zNear * tan(0.5 * fovy / RADtoDEG);
+	SetVolume(cpFrustum, -top * aspect, top * aspect, -top, top, zNear, zFar);
+}
+
+void TCamera::SetOrtho(double left, double right, double bottom, double top, double zNear, double zFar)
+{
+	SetVolume(cpOrtho, left, right, bottom, top, zNear, zFar);
+}
+
+/**
+ * Any projection matrix, its near and far planes are not fitted to the scene
+ */
+void TCamera::SetProjection(const TMatrix4 &matrix)
+{
+	if ((projectionType == cpMatrix) && (memcmp(matrixProjection.array, matrix.array, sizeof(matrix.array)) == 0))
+		return;
+	projectionType = cpMatrix;
+	matrixProjection = matrix;
+	projectionChanged = true;
+	frustumChanged = true;
+}
+
+void TCamera::SetVolume(TCameraProjection type, double left, double right, double bottom, double top,
+		double zNear, double zFar)
+{
+	const double newVolume[6] = {left, right, bottom, top, zNear, zFar};
+	if ((projectionType == type) && (memcmp(volume, newVolume, sizeof(volume)) == 0))
+		return;
+	projectionType = type;
+	memcpy(volume, newVolume, sizeof(volume));
+	projectionChanged = true;
+	frustumChanged = true;
+}
+
+/* ================================================================== */
+/*                          Fitting to the scene                      */
+/* ================================================================== */
+
+/**
+ * With the automatic depth, the near and far planes given to SetFrustum, SetPerspective
+ * or SetOrtho are replaced by the planes of the last FitDepth. The field of view does not
+ * change. Without, the projection is the one given.
+ */
+void TCamera::SetAutoDepth(bool automatic)
+{
+	if (automatic == autoDepth)
+		return;
+	autoDepth = automatic;
+	depthFitted = false;
+	projectionChanged = true;
+	frustumChanged = true;
+}
+
+/**
+ * Move the near and far planes as close as possible to the box (the bounding box of the
+ * scene in the current view), so the depth buffer keeps all its precision for the scene.
+ * The near plane of a frustum is kept beyond far * CAMERA_DEPTH_RATIO.
+ * Return true if the projection changed.
+ */
+bool TCamera::FitDepth(const TVector3D &boxMin, const TVector3D &boxMax)
+{
+	if (!autoDepth || (projectionType == cpMatrix))
+		return false;
+
+	// Range of the depth (-Z in the eye coordinates) of the corners of the box
+	const TMatrix4 &matrix = GetView();
+	double zNear = 0.0, zFar = 0.0;
+	for (int k = 0; k < 8; k++)
+	{
+		const TVector3D corner((k & 1) ? boxMax.X : boxMin.X, (k & 2) ? boxMax.Y : boxMin.Y,
+				(k & 4) ? boxMax.Z : boxMin.Z);
+		const double depth = -matrix.TransformPoint(corner).Z;
+		if ((k == 0) || (depth < zNear)) zNear = depth;
+		if ((k == 0) || (depth > zFar)) zFar = depth;
+	}
+
+	// A small margin so the faces on the box are not clipped
+	const double margin = 0.01 * (zFar - zNear) + 1.0e-3 * std::max(fabs(zNear), fabs(zFar)) + 1.0e-4;
+	zNear -= margin;
+	zFar += margin;
+	if (projectionType == cpFrustum)
+	{
+		if (zFar <= 0.0)
+		{
+			// The scene is behind the eye, keep the planes given
+			zNear = volume[4];
+			zFar = volume[5];
+		}
+		else
+			zNear = std::max(zNear, zFar * CAMERA_DEPTH_RATIO);
+	}
+
+	if (depthFitted && (fabs(zNear - depthNear) <= 1.0e-6 * zFar) && (fabs(zFar - depthFar) <= 1.0e-6 * zFar))
+		return false;
+	depthNear = zNear;
+	depthFar = zFar;
+	depthFitted = true;
+	projectionChanged = true;
+	frustumChanged = true;
+	return true;
+}
+
+/**
+ * Center the box in the view and zoom so the box fills the view (frame all, frame the
+ * selection). Orbit and arcball : the center and the scale change, fly : the eye goes
+ * back from the center of the box along the view direction.
+ */
+void TCamera::Frame(const TVector3D &boxMin, const TVector3D &boxMax)
+{
+	TVector3D middle = (boxMin + boxMax) * 0.5;
+	GLfloat radius = (boxMax - boxMin).Length() * 0.5;
+	if (radius < Epsilon)
+		radius = 1.0;
+
+	// Half size of the view at a distance 1 (frustum) or half size of the view (ortho)
+	const TMatrix4 &proj = GetProjection();
+	const double half = std::min(1.0 / fabs(proj[0]), 1.0 / fabs(proj[5]));
+	const bool perspective = (proj[15] == 0.0);
+	// Sine of the half angle of the view
+	const double sine = half / sqrt(1.0 + half * half);
+
+	if (mode == cmFly)
+	{
+		const GLfloat distance = perspective ? radius / sine : 2.0 * radius;
+		if (!perspective)
+			target.scale = half / radius;
+		SetEye(middle + target.rotation.Conjugate().Rotate(TVector3D(0.0, 0.0, distance)));
+	}
+	else
+	{
+		target.center = -middle;
+		SetScale(perspective ? target.distance * sine / radius : half / radius);
+	}
+}
+
+/* ================================================================== */
+/*                          View                                      */
+/* ================================================================== */
+
+/**
+ * Angles in degrees of the orbit and fly modes : yaw around Z then pitch around X.
+ * The arcball rotation is set too.
+ */
+void TCamera::SetOrbit(GLfloat yaw, GLfloat pitch)
+{
+	target.yaw = yaw;
+	target.pitch = pitch;
+	target.rotation = OrbitRotation(yaw, pitch);
+	TargetChanged();
+}
+
+/**
+ * The rotation of the arcball mode
+ */
+void TCamera::SetRotation(const TQuaternion &rotation)
+{
+	target.rotation = rotation;
+	target.rotation.Normalize();
+	TargetChanged();
+}
+
+/**
+ * Distance between the eye and the center of the scene (orbit and arcball)
+ */
+void TCamera::SetDistance(GLfloat distance)
+{
+	target.distance = distance;
+	TargetChanged();
+}
+
+void TCamera::SetScale(GLfloat scale)
 {
-//  gluLookAt(x, y, z, tX, tY, tZ, 0, 1, 0);
+	if (scale <= 0.0)
+		return;
+	target.scale = scale;
+	TargetChanged();
 }
 
-void TCamera::move(GLfloat angle)
+/**
+ * Translation of the scene, the point -center is in front of the eye (orbit and arcball)
+ */
+void TCamera::SetCenter(const TVector3D &center)
 {
-  GLfloat deltaX = (tX - x);
-  GLfloat deltaZ = (tZ - z);
-  GLfloat radianAngle = (PI * angle) / 180.0f;
-  GLfloat new_vecX = deltaX * cos(radianAngle) + deltaZ * sin(radianAngle);
-  GLfloat new_vecZ = -deltaX * sin(radianAngle) + deltaZ * cos(radianAngle);
-  
-  GLfloat magnitude = sqrtf(pow(deltaX, 2.0f) + pow(deltaZ, 2.0f));
-  GLfloat auxX = vel * new_vecX/magnitude;
-  GLfloat auxZ = vel * new_vecZ/magnitude;
-  x += auxX;
-  z += auxZ;
-  
-  tX += auxX;
-  tZ += auxZ;
+	target.center = center;
+	TargetChanged();
 }
 
-void TCamera::rotate(GLfloat angle, bool horizontal)
+/**
+ * Position of the eye (fly)
+ */
+void TCamera::SetEye(const TVector3D &eye)
 {
-  GLfloat radianAngle = (PI * angle) / 180.0f;
-  GLfloat deltaX = (tX - x);
-  GLfloat deltaZ = (tZ - z);
-  if (horizontal)
-  {
-    tX = x + (deltaX * cos(radianAngle) + deltaZ * sin(radianAngle));
-    tZ = z + (-deltaX * sin(radianAngle) + deltaZ * cos(radianAngle));
-  }
-  else
-  {
-    tY += angle;
-  }
+	target.eye = eye;
+	TargetChanged();
+}
+
+/**
+ * Position of the eye in the scene
+ */
+TVector3D TCamera::GetEye(void)
+{
+	if (mode == cmFly)
+		return target.eye;
+	return target.rotation.Conjugate().Rotate(TVector3D(0.0, 0.0, target.distance)) / target.scale - target.center;
+}
+
+void TCamera::Zoom(GLfloat factor)
+{
+	SetScale(target.scale * factor);
+}
+
+/**
+ * Turn the scene by yaw degrees around Z and pitch degrees around X.
+ * In the arcball mode, the axes are the vertical and the horizontal of the screen.
+ */
+void TCamera::Turn(GLfloat yaw, GLfloat pitch)
+{
+	if (mode == cmArcball)
+		SetRotation(TQuaternion::FromAxisAngle(x_direction, pitch) * TQuaternion::FromAxisAngle(y_direction, yaw) *
+				target.rotation);
+	else
+		SetOrbit(target.yaw + yaw, target.pitch + pitch);
+}
+
+/**
+ * The mouse moved from (x0, y0) to (x1, y1), in pixels from the top left of the viewport.
+ * Orbit and fly : one degree by pixel, arcball : the point under the mouse follows the mouse.
+ */
+void TCamera::Drag(int x0, int y0, int x1, int y1)
+{
+	if (mode == cmArcball)
+		SetRotation(TQuaternion::FromTo(ArcballPoint(x0, y0), ArcballPoint(x1, y1)) * target.rotation);
+	else
+		Turn(x1 - x0, y1 - y0);
+}
+
+/**
+ * Move the eye along the axes of the screen. In the orbit and arcball modes, right and up
+ * move the center of the scene, forward reduce the distance.
+ */
+void TCamera::Move(GLfloat forward, GLfloat right, GLfloat up)
+{
+	if (mode == cmFly)
+	{
+		target.eye += target.rotation.Conjugate().Rotate(TVector3D(right, up, -forward));
+	}
+	else
+	{
+		target.center -= target.rotation.Conjugate().Rotate(TVector3D(right, up, 0.0));
+		target.distance -= forward;
+	}
+	TargetChanged();
+}
+
+/* ================================================================== */
+/*                          Motion                                    */
+/* ================================================================== */
+
+/**
+ * Move the camera to the target after dt seconds.
+ * Return true if the view changed, so the scene must be drawn again.
+ */
+bool TCamera::Update(double dt)
+{
+	if (!moving)
+		return false;
+
+	const GLfloat k = (damping > 0.0) ? 1.0 - exp(-dt / damping) : 1.0;
+	current.yaw += (target.yaw - current.yaw) * k;
+	current.pitch += (target.pitch - current.pitch) * k;
+	current.distance += (target.distance - current.distance) * k;
+	current.scale *= pow(target.scale / current.scale, k);
+	current.center += (target.center - current.center) * k;
+	current.eye += (target.eye - current.eye) * k;
+	current.rotation = TQuaternion::Slerp(current.rotation, target.rotation, k);
+
+	const GLfloat tolerance = CAMERA_MOTION_EPSILON * ((target.distance > 1.0) ? target.distance : 1.0);
+	if ((fabs(target.yaw - current.yaw) < CAMERA_MOTION_EPSILON) &&
+			(fabs(target.pitch - current.pitch) < CAMERA_MOTION_EPSILON) &&
+			(fabs(target.distance - current.distance) < tolerance) &&
+			(fabs(target.scale / current.scale - 1.0) < CAMERA_MOTION_EPSILON) &&
+			((target.center - current.center).Length() < tolerance) &&
+			((target.eye - current.eye).Length() < tolerance) &&
+			(fabs(target.rotation.Dot(current.rotation)) > 1.0 - 1.0e-6))
+		EndMotion();
+
+	viewChanged = true;
+	return true;
+}
+
+/**
+ * The camera goes at once to the target
+ */
+void TCamera::EndMotion(void)
+{
+	current = target;
+	moving = false;
+	viewChanged = true;
+}
+
+void TCamera::TargetChanged(void)
+{
+	if (damping > 0.0)
+		moving = true;
+	else
+		EndMotion();
+}
+
+TQuaternion TCamera::OrbitRotation(GLfloat yaw, GLfloat pitch)
+{
+	return TQuaternion::FromAxisAngle(x_direction, pitch) * TQuaternion::FromAxisAngle(z_direction, yaw);
+}
+
+TQuaternion TCamera::CurrentRotation(void)
+{
+	if (mode == cmArcball)
+		return current.rotation;
+	return OrbitRotation(current.yaw, current.pitch);
+}
+
+/**
+ * The point of the virtual sphere under the mouse, in eye coordinates
+ */
+TVector3D TCamera::ArcballPoint(int x, int y)
+{
+	const GLfloat radius = 0.5 * ((viewport[2] < viewport[3]) ? viewport[2] : viewport[3]);
+	TVector3D point((x - 0.5 * viewport[2]) / radius, (0.5 * viewport[3] - y) / radius, 0.0);
+	const GLfloat d2 = point.X * point.X + point.Y * point.Y;
+	if (d2 < 1.0)
+		point.Z = sqrtf(1.0 - d2);
+	else
+		point.Normalize();
+	return point;
+}
+
+/* ================================================================== */
+/*                          Cached data                               */
+/* ================================================================== */
+
+const TMatrix4& TCamera::GetView(void)
+{
+	if (viewChanged)
+	{
+		TMatrix4 scale;
+		scale.Scale(current.scale, current.scale, current.scale);
+		if (mode == cmFly)
+			view = CurrentRotation().ToMatrix() * scale.Translate(-current.eye.X, -current.eye.Y, -current.eye.Z);
+		else
+			view = TMatrix4().Translate(0.0, 0.0, -current.distance) * CurrentRotation().ToMatrix() *
+					scale.Translate(current.center);
+		inverseView = view.Inverse();
+		viewChanged = false;
+		frustumChanged = true;
+	}
+	return view;
+}
+
+const TMatrix4& TCamera::GetInverseView(void)
+{
+	GetView();
+	return inverseView;
+}
+
+const TMatrix4& TCamera::GetProjection(void)
+{
+	if (projectionChanged)
+	{
+		double zNear = volume[4], zFar = volume[5], k = 1.0;
+		if (autoDepth && depthFitted)
+		{
+			// The frustum is scaled to keep the same field of view
+			if (projectionType == cpFrustum)
+				k = depthNear / zNear;
+			zNear = depthNear;
+			zFar = depthFar;
+		}
+		switch (projectionType)
+		{
+			case cpFrustum:
+				projection = TMatrix4::Frustum(volume[0] * k, volume[1] * k, volume[2] * k, volume[3] * k, zNear, zFar);
+				break;
+			case cpOrtho:
+				projection = TMatrix4::Ortho(volume[0], volume[1], volume[2], volume[3], zNear, zFar);
+				break;
+			default:
+				projection = matrixProjection;
+		}
+		inverseProjection = projection.Inverse();
+		projectionChanged = false;
+	}
+	return projection;
+}
+
+const TMatrix4& TCamera::GetInverseProjection(void)
+{
+	GetProjection();
+	return inverseProjection;
+}
+
+/**
+ * The planes of the view volume in the coordinates of the scene
+ */
+const TFrustum& TCamera::GetFrustum(void)
+{
+	GetView();
+	if (frustumChanged)
+	{
+		frustum.Extract(view.Array(), GetProjection().Array());
+		frustumChanged = false;
+	}
+	return frustum;
+}
+
+/**
+ * The ray under the mouse (x, y), in pixels from the top left of the viewport.
+ * The ray goes from the near plane (origin) to the far plane (origin + direction).
+ */
+bool TCamera::GetRay(GLfloat x, GLfloat y, TVector3D &origin, TVector3D &direction)
+{
+	const TMatrix4 inverse = GetInverseView() * GetInverseProjection();
+	const GLfloat nx = 2.0 * x / viewport[2] - 1.0;
+	const GLfloat ny = 1.0 - 2.0 * y / viewport[3];
+
+	TVector3D farPoint;
+	if (!Unproject(inverse, nx, ny, -1.0, origin) || !Unproject(inverse, nx, ny, 1.0, farPoint))
+		return false;
+	direction = farPoint - origin;
+	return true;
 }
 
 // ********************************************************************************
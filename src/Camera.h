@@ -3,22 +3,172 @@
 
 #include <stdio.h>
 #include "Vector3D.h"
+#include "Matrix4.h"
+#include "Quaternion.h"
+#include "Frustum.h"
 
 namespace GLScene
 {
 
+/**
+ * cmOrbit : the scene turns around its center, Z stays up (yaw around Z, pitch around X)
+ * cmArcball : the scene turns freely like a ball under the mouse
+ * cmFly : the eye moves in the scene and looks around
+ */
+typedef enum {
+	cmOrbit, cmArcball, cmFly
+} TCameraMode;
+
+/**
+ * The projection : a view volume given by glFrustum (or gluPerspective), by glOrtho
+ * or any matrix. The near and far planes of a view volume can be fitted to the scene.
+ */
+typedef enum {
+	cpFrustum, cpOrtho, cpMatrix
+} TCameraProjection;
+
+/**
+ * The parameters of the view. The orbit and arcball view is
+ * translate(0, 0, -distance) * rotation * scale * translate(center),
+ * the fly view is rotation * scale * translate(-eye).
+ */
+typedef struct TCameraState
+{
+	public:
+		GLfloat yaw;       // Degrees around Z (orbit and fly)
+		GLfloat pitch;     // Degrees around X (orbit and fly)
+		TQuaternion rotation;
+		GLfloat distance;
+		GLfloat scale;
+		TVector3D center;  // Translation of the scene (orbit and arcball)
+		TVector3D eye;     // Position of the eye (fly)
+} TCameraState;
+
+/**
+ * TCamera class
+ * The view and the projection of the scene, the matrices, their inverses and the planes
+ * of the frustum are cached and only computed again when the camera changed.
+ * eg : camera.SetPerspective(45.0, aspect, 1.0, 300.0);
+ *      camera.Drag(x0, y0, x1, y1);  // Mouse move
+ *      if (camera.Update(dt))        // Each frame, true while the camera moves
+ *        Refresh();
+ *      glLoadMatrixf(camera.GetView().Array());
+ * The setters give the target of the camera, with SetDamping the camera goes smoothly
+ * to the target in Update, else the target is reached at once.
+ */
 class TCamera
 {
-  public:
-    TCamera();
-    ~TCamera();
-    GLfloat x = 5, y = 1.8, z = 4;
-    GLfloat vel = 0.4;
-    GLfloat tX = 0.0, tY = 1.8, tZ = 0.0;
-    int mode = 0;
-    void move(GLfloat angle);
-    void rotate(GLfloat angle, bool horizontal);
-    void draw();
+	public:
+		TCamera();
+		virtual ~TCamera();
+
+		void SetMode(TCameraMode mode);
+		TCameraMode GetMode(void)
+		{
+			return mode;
+		}
+
+		// Projection
+		void SetViewport(GLint x, GLint y, GLint width, GLint height);
+		void SetFrustum(double left, double right, double bottom, double top, double zNear, double zFar);
+		void SetPerspective(double fovy, double aspect, double zNear, double zFar);
+		void SetOrtho(double left, double right, double bottom, double top, double zNear, double zFar);
+		void SetProjection(const TMatrix4 &matrix);
+		TCameraProjection GetProjectionType(void)
+		{
+			return projectionType;
+		}
+
+		// Fitting to the scene
+		void SetAutoDepth(bool automatic);
+		bool GetAutoDepth(void)
+		{
+			return autoDepth;
+		}
+		bool FitDepth(const TVector3D &boxMin, const TVector3D &boxMax);
+		void Frame(const TVector3D &boxMin, const TVector3D &boxMax);
+
+		// View
+		void SetOrbit(GLfloat yaw, GLfloat pitch);
+		void SetRotation(const TQuaternion &rotation);
+		void SetDistance(GLfloat distance);
+		void SetScale(GLfloat scale);
+		void SetCenter(const TVector3D &center);
+		void SetEye(const TVector3D &eye);
+		void Zoom(GLfloat factor);
+		void Turn(GLfloat yaw, GLfloat pitch);
+		void Drag(int x0, int y0, int x1, int y1);
+		void Move(GLfloat forward, GLfloat right, GLfloat up);
+
+		GLfloat GetYaw(void)
+		{
+			return target.yaw;
+		}
+		GLfloat GetPitch(void)
+		{
+			return target.pitch;
+		}
+		GLfloat GetScale(void)
+		{
+			return target.scale;
+		}
+		TVector3D GetCenter(void)
+		{
+			return target.center;
+		}
+		TVector3D GetEye(void);
+
+		// Motion
+		/// Time in seconds to reach about 2/3 of the way to the target, 0 for no damping (default)
+		void SetDamping(GLfloat time)
+		{
+			damping = time;
+		}
+		bool Update(double dt);
+		void EndMotion(void);
+		bool IsMoving(void)
+		{
+			return moving;
+		}
+
+		// Cached data
+		const TMatrix4& GetView(void);
+		const TMatrix4& GetInverseView(void);
+		const TMatrix4& GetProjection(void);
+		const TMatrix4& GetInverseProjection(void);
+		const TFrustum& GetFrustum(void);
+		const GLint* GetViewport(void)
+		{
+			return viewport;
+		}
+		bool GetRay(GLfloat x, GLfloat y, TVector3D &origin, TVector3D &direction);
+
+	private:
+		TCameraMode mode;
+		TCameraState target;
+		TCameraState current;
+		GLfloat damping;
+		bool moving;
+
+		GLint viewport[4];
+		TCameraProjection projectionType;
+		double volume[6];  // left, right, bottom, top, near, far
+		TMatrix4 matrixProjection;
+		bool autoDepth;
+		bool depthFitted;
+		double depthNear, depthFar;
+
+		TMatrix4 view, inverseView;
+		TMatrix4 projection, inverseProjection;
+		TFrustum frustum;
+		bool viewChanged, projectionChanged, frustumChanged;
+
+		void SetVolume(TCameraProjection type, double left, double right, double bottom, double top,
+				double zNear, double zFar);
+		TQuaternion OrbitRotation(GLfloat yaw, GLfloat pitch);
+		TQuaternion CurrentRotation(void);
+		void TargetChanged(void);
+		TVector3D ArcballPoint(int x, int y);
 };
 
 } // namespace GLScene
@@ -0,0 +1,306 @@
+#include "ColorMap.h"
+#include <algorithm>
+
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE	0x812F
+#endif
+
+// Color from hexadecimal RGB
+#define HEXCOLOR(c)	TVector4D((((c) >> 16) & 0xFF) / 255.0f, (((c) >> 8) & 0xFF) / 255.0f, ((c) & 0xFF) / 255.0f, 1.0f)
+
+// Matplotlib color maps, sampled every 0.1
+static const unsigned int viridis[] = {
+		0x440154, 0x482475, 0x414487, 0x355F8D, 0x2A788E, 0x21918C,
+		0x22A884, 0x44BF70, 0x7AD151, 0xBDDF26, 0xFDE725
+};
+static const unsigned int plasma[] = {
+		0x0D0887, 0x41049D, 0x6A00A8, 0x8F0DA4, 0xB12A90, 0xCC4778,
+		0xE16462, 0xF2844B, 0xFCA636, 0xFCCE25, 0xF0F921
+};
+static const unsigned int inferno[] = {
+		0x000004, 0x160B39, 0x420A68, 0x6A176E, 0x932667, 0xBC3754,
+		0xDD513A, 0xF37819, 0xFCA50A, 0xF6D746, 0xFCFFA4
+};
+static const unsigned int magma[] = {
+		0x000004, 0x140E36, 0x3B0F70, 0x641A80, 0x8C2981, 0xB73779,
+		0xDE4968, 0xF7705C, 0xFE9F6D, 0xFECF92, 0xFCFDBF
+};
+
+TColorMap::TColorMap(TColorMapPreset preset)
+{
+	changed = true;
+	textureId = 0;
+	SetPreset(preset);
+}
+
+TColorMap::TColorMap(const TVector4D &begin, const TVector4D &end)
+{
+	changed = true;
+	textureId = 0;
+	SetColors({begin, end});
+}
+
+/**
+ * Only the colors are copied, each color map has its own texture
+ */
+TColorMap::TColorMap(const TColorMap &map)
+{
+	changed = true;
+	textureId = 0;
+	stops = map.stops;
+}
+
+TColorMap::~TColorMap()
+{
+	if (textureId != 0)
+		glDeleteTextures(1, &textureId);
+}
+
+TColorMap& TColorMap::operator =(const TColorMap &map)
+{
+	if (this != &map)
+	{
+		stops = map.stops;
+		changed = true;
+	}
+	return *this;
+}
+
+void TColorMap::SetPreset(TColorMapPreset preset)
+{
+	const unsigned int *table = NULL;
+
+	switch (preset)
+	{
+		case cmViridis:
+			table = viridis;
+			break;
+		case cmPlasma:
+			table = plasma;
+			break;
+		case cmInferno:
+			table = inferno;
+			break;
+		case cmMagma:
+			table = magma;
+			break;
+		case cmJet:
+			ClearStops();
+			AddStop(0.0f, {0.0, 0.0, 0.5, 1.0});
+			AddStop(0.125f, {0.0, 0.0, 1.0, 1.0});
+			AddStop(0.375f, {0.0, 1.0, 1.0, 1.0});
+			AddStop(0.625f, {1.0, 1.0, 0.0, 1.0});
+			AddStop(0.875f, {1.0, 0.0, 0.0, 1.0});
+			AddStop(1.0f, {0.5, 0.0, 0.0, 1.0});
+			break;
+		case cmHot:
+			ClearStops();
+			AddStop(0.0f, GLColor_black);
+			AddStop(0.375f, GLColor_red);
+			AddStop(0.75f, GLColor_yellow);
+			AddStop(1.0f, GLColor_white);
+			break;
+		case cmCool:
+			SetColors({GLColor_cyan, GLColor_magenta});
+			break;
+		case cmGrey:
+			SetColors({GLColor_black, GLColor_white});
+			break;
+		default:
+			;
+	}
+
+	if (table != NULL)
+	{
+		ClearStops();
+		for (int i = 0; i <= 10; i++)
+			AddStop(i / 10.0f, HEXCOLOR(table[i]));
+	}
+}
+
+/**
+ * Set colors equally spaced over [0, 1]
+ */
+void TColorMap::SetColors(std::initializer_list<TVector4D> colors)
+{
+	ClearStops();
+	if (colors.size() == 0)
+		return;
+
+	GLfloat step = (colors.size() > 1) ? 1.0f / (colors.size() - 1) : 0.0f;
+	int count = 0;
+	for (auto element : colors)
+		AddStop(count++ * step, element);
+}
+
+void TColorMap::AddStop(GLfloat position, const TVector4D &color)
+{
+	TColorStop stop;
+	stop.position = position;
+	stop.color = color;
+
+	// Keep the stops sorted
+	std::vector<TColorStop>::iterator it = stops.begin();
+	while ((it != stops.end()) && (it->position <= position))
+		++it;
+	stops.insert(it, stop);
+	changed = true;
+}
+
+void TColorMap::ClearStops(void)
+{
+	stops.clear();
+	changed = true;
+}
+
+/**
+ * Color at position t in [0, 1]
+ */
+TVector4D TColorMap::GetColor(GLfloat t) const
+{
+	if (stops.empty())
+		return TVector4D(1.0, 1.0, 1.0, 1.0);
+	if (t <= stops.front().position)
+		return stops.front().color;
+	if (t >= stops.back().position)
+		return stops.back().color;
+
+	size_t i = 1;
+	while (stops[i].position < t)
+		i++;
+
+	const TColorStop &a = stops[i - 1];
+	const TColorStop &b = stops[i];
+	GLfloat delta = b.position - a.position;
+	GLfloat factor = (delta > Epsilon) ? (t - a.position) / delta : 0.0f;
+	return a.color + (b.color - a.color) * factor;
+}
+
+void TColorMap::Upload(void)
+{
+	GLfloat texture[4 * COLORMAP_SIZE];
+
+	for (int i = 0; i < COLORMAP_SIZE; i++)
+	{
+		TVector4D color = GetColor(i / (GLfloat) (COLORMAP_SIZE - 1));
+		for (int c = 0; c < 4; c++)
+			texture[4 * i + c] = color[c];
+	}
+
+	if (textureId == 0)
+	{
+		glGenTextures(1, &textureId);
+		glBindTexture(GL_TEXTURE_1D, textureId);
+		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA8, COLORMAP_SIZE, 0, GL_RGBA, GL_FLOAT, texture);
+	}
+	else
+	{
+		glBindTexture(GL_TEXTURE_1D, textureId);
+		glTexSubImage1D(GL_TEXTURE_1D, 0, 0, COLORMAP_SIZE, GL_RGBA, GL_FLOAT, texture);
+	}
+	changed = false;
+}
+
+/**
+ * Enable the color map for the scalars in [min, max] given as first texture coordinate.
+ * The texture is uploaded only if the colors changed.
+ * Texture is modulated with the lighting, the material color is set to white.
+ */
+void TColorMap::Bind(GLfloat min, GLfloat max)
+{
+	if (changed || (textureId == 0))
+		Upload();
+	else
+		glBindTexture(GL_TEXTURE_1D, textureId);
+
+	glEnable(GL_TEXTURE_1D);
+	glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE, GL_MODULATE);
+
+	// Map [min, max] to the center of the first and last texel
+	GLfloat delta = max - min;
+	if (fabs(delta) < Epsilon)
+		delta = 1.0f;
+	const GLfloat texel = 1.0f / COLORMAP_SIZE;
+	glMatrixMode(GL_TEXTURE);
+	glLoadIdentity();
+	glTranslatef(0.5f * texel, 0.0f, 0.0f);
+	glScalef((1.0f - texel) / delta, 1.0f, 1.0f);
+	glTranslatef(-min, 0.0f, 0.0f);
+	glMatrixMode(GL_MODELVIEW);
+
+	glEnable(GL_COLOR_MATERIAL);
+	glColor4f(1.0f, 1.0f, 1.0f, 1.0f);
+}
+
+void TColorMap::Unbind(void)
+{
+	glMatrixMode(GL_TEXTURE);
+	glLoadIdentity();
+	glMatrixMode(GL_MODELVIEW);
+
+	glDisable(GL_COLOR_MATERIAL);
+	glDisable(GL_TEXTURE_1D);
+	glBindTexture(GL_TEXTURE_1D, 0);
+}
+
+TColorMapped::~TColorMapped()
+{
+	delete colorMap;
+}
+
+/**
+ * Use a color map, only the small texture of the color map is uploaded when the colors change
+ */
+void TColorMapped::SetColorMap(const TColorMap &map)
+{
+	if (colorMap == NULL)
+		colorMap = new TColorMap(map);
+	else
+		*colorMap = map;
+	ColorMapChanged();
+}
+
+void TColorMapped::SetColorMap(TColorMapPreset preset)
+{
+	SetColorMap(TColorMap(preset));
+}
+
+/**
+ * The range of values [min, max] mapped to the color map. Default is the range of the object.
+ */
+void TColorMapped::SetColorRange(double min, double max)
+{
+	colorMin = min;
+	colorMax = max;
+	colorRangeAuto = false;
+}
+
+void TColorMapped::SetColorRangeAuto(void)
+{
+	colorRangeAuto = true;
+}
+
+void TColorMapped::ClearColorMap(void)
+{
+	delete colorMap;
+	colorMap = NULL;
+}
+
+/**
+ * Bind map (the color map or an other one of the object) for the range of the values
+ * of the object [min, max], or the range of SetColorRange
+ */
+void TColorMapped::BindColorMap(TColorMap *map, double min, double max)
+{
+	if (colorRangeAuto)
+		map->Bind(min, max);
+	else
+		map->Bind(colorMin, colorMax);
+}
+
+// ********************************************************************************
+// End of file
+// ********************************************************************************
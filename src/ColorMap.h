@@ -0,0 +1,99 @@
+#ifndef _COLOR_MAP_H
+#define _COLOR_MAP_H
+
+#include "Object3D.h"
+#include <vector>
+
+namespace GLScene
+{
+
+typedef enum {
+	cmViridis, cmPlasma, cmInferno, cmMagma, cmJet, cmHot, cmCool, cmGrey
+} TColorMapPreset;
+
+// Number of colors of the texture
+#define COLORMAP_SIZE	256
+
+/**
+ * A color of the color map at position [0, 1]
+ */
+typedef struct TColorStop
+{
+	public:
+		GLfloat position;
+		TVector4D color;
+} TColorStop;
+
+/**
+ * TColorMap class
+ * A color map with several colors (stops) linearly interpolated.
+ * On the GPU, the color map is a 1D texture (LUT) of COLORMAP_SIZE colors. A scalar
+ * given as texture coordinate is mapped to the color map with the texture matrix,
+ * so changing the range [min, max] costs nothing and changing the colors costs
+ * only the upload of the small texture.
+ */
+class TColorMap
+{
+	public:
+		TColorMap(TColorMapPreset preset = cmViridis);
+		TColorMap(const TVector4D &begin, const TVector4D &end);
+		TColorMap(const TColorMap &map);
+		virtual ~TColorMap();
+
+		TColorMap& operator =(const TColorMap &map);
+
+		void SetPreset(TColorMapPreset preset);
+		void SetColors(std::initializer_list<TVector4D> colors);
+		void AddStop(GLfloat position, const TVector4D &color);
+		void ClearStops(void);
+
+		TVector4D GetColor(GLfloat t) const;
+
+		// OpenGL
+		void Bind(GLfloat min, GLfloat max);
+		void Unbind(void);
+
+	private:
+		std::vector<TColorStop> stops;
+		bool changed;
+		GLuint textureId;
+
+		void Upload(void);
+};
+
+/**
+ * TColorMapped class
+ * The color map of an object and the range of the values mapped to it (heights, scalars),
+ * the range of the values of the object by default. The objects drawn with a color map
+ * inherit it, ColorMapChanged lets them leave their other color modes.
+ */
+class TColorMapped
+{
+	public:
+		virtual ~TColorMapped();
+
+		void SetColorMap(const TColorMap &map);
+		void SetColorMap(TColorMapPreset preset);
+		void SetColorRange(double min, double max);
+		void SetColorRangeAuto(void);
+		TColorMap* GetColorMap(void)
+		{
+			return colorMap;
+		}
+
+	protected:
+		TColorMap *colorMap = NULL;  // Color map mode if not NULL
+		double colorMin = 0.0, colorMax = 0.0;
+		bool colorRangeAuto = true;
+
+		virtual void ColorMapChanged(void)
+		{
+		}
+		void ClearColorMap(void);
+		void BindColorMap(TColorMap *map, double min, double max);
+};
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _COLOR_MAP_H
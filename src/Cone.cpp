@@ -1,4 +1,5 @@
 #include "Cone.h"
+#include "Tessellation.h"
 
 // Code for sphere construction inspired from :
 // AUTHOR: Song Ho Ahn (song.ahn@gmail.com)
@@ -59,8 +60,8 @@ void TCone::CreateCone(void)
 	double phi = atan2((double) radius, (double) len2);
 	double cos_phi = cos(phi);
 	double sin_phi = sin(phi);
-	double dtheta = (2.0 * PI / ConeDetail);
-	double theta = 0.0;
+	// The unit circle is computed once (at compile time for the usual levels)
+	const TCircleTable circle = UnitCircle(ConeDetail);
 
 	// Cone
 	cone[0].SetVertice(0.0f, 0.0f, len);
@@ -68,8 +69,8 @@ void TCone::CreateCone(void)
 
 	for (GLuint i = 1; i < ConeSize; ++i)
 	{
-		const double cos_theta = cos(theta);
-		const double sin_theta = sin(theta);
+		const double cos_theta = circle.Cos[i - 1];
+		const double sin_theta = circle.Sin[i - 1];
 		const float x = (float) (radius * cos_theta);
 		const float y = (float) (radius * sin_theta);
 
@@ -81,16 +82,11 @@ void TCone::CreateCone(void)
 
 		cone[coneLength - i].SetVertice(x, y, 0.0f);
 		cone[coneLength - i].SetNormal(0.0f, 0.0f, -1.0f);
-
-		theta += dtheta;
 	}
 }
 
 void TCone::DoDisplay(TDisplayMode mode __attribute__((unused)))
 {
-	glTranslated(position.X, position.Y, position.Z);
-	glRotated(angle, axe_angle.X, axe_angle.Y, axe_angle.Z);
-
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_NORMAL_ARRAY);
 
@@ -120,6 +116,16 @@ void TCone::DoDisplay(TDisplayMode mode __attribute__((unused)))
 	glDisableClientState(GL_NORMAL_ARRAY);
 }
 
+/**
+ * The base of the cone is at 0, the top at len
+ */
+bool TCone::GetBounds(TVector3D &boxMin, TVector3D &boxMax)
+{
+	boxMin = TVector3D(-radius, -radius, 0.0);
+	boxMax = TVector3D(radius, radius, len);
+	return true;
+}
+
 // ********************************************************************************
 // End of file
 // ********************************************************************************
@@ -20,6 +20,8 @@ class TCone: public TBaseCylinder
 		TCone(GLfloat _len = 1.0f, GLfloat _radius = 0.5f, const TVector3D &pos = GLDefaultPosition);
 		virtual ~TCone();
 
+		virtual bool GetBounds(TVector3D &boxMin, TVector3D &boxMax);
+
 		void DoDisplay(TDisplayMode mode = dmRender);
 
 	private:
@@ -0,0 +1,293 @@
+#include "Contour.h"
+#include "Parallel.h"
+#include <algorithm>
+
+// The lines are drawn with this depth range so they are in front of the surface
+#define CONTOUR_DEPTH_RANGE	0.9995
+
+// Marching squares : the edges cut by the isoline for each case (bit k is the corner k
+// over the level). Corners : 0 (i, j), 1 (i+1, j), 2 (i+1, j+1), 3 (i, j+1).
+// Edges : 0 (corner 0-1), 1 (1-2), 2 (3-2), 3 (0-3). The saddles 5 and 10 are
+// resolved with the center of the cell.
+static const signed char contourEdges[16][4] = {
+		{-1, -1, -1, -1}, {3, 0, -1, -1}, {0, 1, -1, -1}, {3, 1, -1, -1},
+		{1, 2, -1, -1}, {3, 0, 1, 2}, {0, 2, -1, -1}, {3, 2, -1, -1},
+		{2, 3, -1, -1}, {0, 2, -1, -1}, {0, 1, 2, 3}, {1, 2, -1, -1},
+		{1, 3, -1, -1}, {0, 1, -1, -1}, {3, 0, -1, -1}, {-1, -1, -1, -1}
+};
+
+// The corners of each edge, always in the same order so a shared edge gives the same point
+static const int edgeCorners[4][2] = {{0, 1}, {1, 2}, {3, 2}, {0, 3}};
+
+TContour::TContour(GLuint levelCount)
+{
+	this->levelCount = levelCount;
+	color = GLColor_black;
+	lineWidth = 1.0f;
+	sizeX = sizeY = 0;
+	rangeMin = rangeMax = 0.0;
+	dirtyBegin = dirtyEnd = 0;
+	vertexCount = 0;
+}
+
+TContour::~TContour()
+{
+#ifdef USE_VBO
+	DeleteAndNullVBO(1, vboId);
+#endif
+}
+
+/**
+ * count levels equally spaced in the range of the surface (the min and max excluded)
+ */
+void TContour::SetLevels(GLuint count)
+{
+	levelCount = count;
+	levels.clear();
+	sizeX = sizeY = 0;  // Force the extraction
+}
+
+void TContour::SetLevels(const std::vector<GLfloat> &values)
+{
+	levelCount = 0;
+	levels = values;
+	std::sort(levels.begin(), levels.end());
+	sizeX = sizeY = 0;  // Force the extraction
+}
+
+/**
+ * All the surface changed
+ */
+void TContour::Invalidate(void)
+{
+	dirtyBegin = 0;
+	dirtyEnd = (sizeY > 1) ? sizeY - 1 : 0;
+}
+
+/**
+ * count rows of the surface changed from the row first
+ */
+void TContour::InvalidateRows(GLuint first, GLuint count)
+{
+	if ((count == 0) || (sizeY < 2))
+		return;
+
+	// The cells of the rows above and below use these rows
+	const GLuint begin = (first > 0) ? first - 1 : 0;
+	const GLuint end = std::min(first + count, sizeY - 1);
+	if (begin >= end)
+		return;
+
+	if (dirtyBegin >= dirtyEnd)
+	{
+		dirtyBegin = begin;
+		dirtyEnd = end;
+	}
+	else
+	{
+		dirtyBegin = std::min(dirtyBegin, begin);
+		dirtyEnd = std::max(dirtyEnd, end);
+	}
+}
+
+/**
+ * The segments of the row of cells j at all the levels
+ */
+void TContour::ExtractRow(const TVector3D *grid, GLuint j, std::vector<TGLfloat3D> &segments) const
+{
+	segments.clear();
+	if (levels.empty())
+		return;
+
+	const TVector3D *corner[4];
+	GLfloat z[4];
+	TGLfloat3D point;
+
+	for (GLuint i = 0; i < sizeX - 1; i++)
+	{
+		const GLuint k = j * sizeX + i;
+		corner[0] = &grid[k];
+		corner[1] = &grid[k + 1];
+		corner[2] = &grid[k + sizeX + 1];
+		corner[3] = &grid[k + sizeX];
+		GLfloat zMin = corner[0]->Z, zMax = zMin;
+		for (int c = 0; c < 4; c++)
+		{
+			z[c] = corner[c]->Z;
+			zMin = std::min(zMin, z[c]);
+			zMax = std::max(zMax, z[c]);
+		}
+
+		// Only the levels in ]zMin, zMax] cut the cell
+		std::vector<GLfloat>::const_iterator level = std::upper_bound(levels.begin(), levels.end(), zMin);
+		for (; (level != levels.end()) && (*level <= zMax); ++level)
+		{
+			const GLfloat value = *level;
+			int index = 0;
+			for (int c = 0; c < 4; c++)
+				if (z[c] >= value)
+					index |= 1 << c;
+
+			const signed char *edges = contourEdges[index];
+			// The saddles separate the corners over the level, unless the center
+			// is over the level too
+			if (((index == 5) || (index == 10)) && (0.25f * (z[0] + z[1] + z[2] + z[3]) >= value))
+				edges = contourEdges[15 - index];
+
+			for (int e = 0; (e < 4) && (edges[e] >= 0); e++)
+			{
+				const TVector3D *a = corner[edgeCorners[edges[e]][0]];
+				const TVector3D *b = corner[edgeCorners[edges[e]][1]];
+				const GLfloat t = (value - a->Z) / (b->Z - a->Z);
+				point.X = a->X + t * (b->X - a->X);
+				point.Y = a->Y + t * (b->Y - a->Y);
+				point.Z = value;
+				segments.push_back(point);
+			}
+		}
+	}
+}
+
+/**
+ * Extract the rows that changed and update the batch of lines
+ */
+void TContour::Update(const TVector3D *grid, GLuint dimX, GLuint dimY, double min, double max)
+{
+	// New surface or new range : all the rows
+	bool all = (dimX != sizeX) || (dimY != sizeY) ||
+			((levelCount > 0) && ((min != rangeMin) || (max != rangeMax)));
+	if (all)
+	{
+		sizeX = dimX;
+		sizeY = dimY;
+		rangeMin = min;
+		rangeMax = max;
+		rows.assign(sizeY - 1, std::vector<TGLfloat3D>());
+		Invalidate();
+
+		if (levelCount > 0)
+		{
+			levels.resize(levelCount);
+			for (GLuint l = 0; l < levelCount; l++)
+				levels[l] = min + (max - min) * (l + 1) / (levelCount + 1);
+		}
+	}
+
+	if (dirtyBegin >= dirtyEnd)
+		return;
+
+	size_t offset = 0;
+	for (GLuint j = 0; j < dirtyBegin; j++)
+		offset += rows[j].size();
+	size_t oldLength = 0;
+	for (GLuint j = dirtyBegin; j < dirtyEnd; j++)
+		oldLength += rows[j].size();
+
+	// Each row of cells write its own segments
+	ParallelFor(dirtyBegin, dirtyEnd, [this, grid](size_t begin, size_t end)
+	{
+		for (size_t j = begin; j < end; j++)
+			ExtractRow(grid, j, rows[j]);
+	}, (1 << 16) / sizeX + 1);
+
+	size_t newLength = 0;
+	for (GLuint j = dirtyBegin; j < dirtyEnd; j++)
+		newLength += rows[j].size();
+
+#ifdef USE_VBO
+	// Same number of segments : update only the rows in the buffer
+	if (!all && (vboId != 0) && (newLength == oldLength))
+	{
+		batch.clear();
+		for (GLuint j = dirtyBegin; j < dirtyEnd; j++)
+			batch.insert(batch.end(), rows[j].begin(), rows[j].end());
+		if (!batch.empty())
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, vboId);
+			glBufferSubData(GL_ARRAY_BUFFER, SIZE_FLOAT3D(offset), SIZE_FLOAT3D(batch.size()), batch.data());
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+		batch.clear();
+		dirtyBegin = dirtyEnd = 0;
+		return;
+	}
+#endif
+
+	batch.clear();
+	for (GLuint j = 0; j < sizeY - 1; j++)
+		batch.insert(batch.end(), rows[j].begin(), rows[j].end());
+	vertexCount = (GLuint) batch.size();
+	dirtyBegin = dirtyEnd = 0;
+
+#ifdef USE_VBO
+	initOGL();
+	if (vertexCount == 0)
+	{
+		DeleteAndNullVBO(1, vboId);
+	}
+	else
+		if (vboId == 0)
+		{
+			vboId = createVBO(batch.data(), SIZE_FLOAT3D(vertexCount), GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW);
+			if (vboId == 0)
+				std::cout << "[WARNING] VBO array not created for Contour." << std::endl;
+		}
+		else
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, vboId);
+			glBufferData(GL_ARRAY_BUFFER, SIZE_FLOAT3D(vertexCount), batch.data(), GL_DYNAMIC_DRAW);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+	// The rows keep the segments for the next update
+	if (vboId != 0)
+		batch.clear();
+#endif
+}
+
+/**
+ * Draw the isolines of the grid dimX x dimY of the surface in the range [min, max].
+ * Called by the surface after its own drawing.
+ */
+void TContour::Display(const TVector3D *grid, GLuint dimX, GLuint dimY, double min, double max)
+{
+	if ((grid == NULL) || (dimX < 2) || (dimY < 2))
+		return;
+
+	Update(grid, dimX, dimY, min, max);
+	if (vertexCount == 0)
+		return;
+
+	glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_LINE_BIT | GL_VIEWPORT_BIT);
+	glDisable(GL_LIGHTING);
+	glDisable(GL_TEXTURE_1D);
+	glColor4f(color.R, color.G, color.B, color.Alpha);
+	glLineWidth(lineWidth);
+	glDepthRange(0.0, CONTOUR_DEPTH_RANGE);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+
+#ifdef USE_VBO
+
+	if (vboId != 0)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, vboId);
+		glVertexPointer(3, GL_FLOAT, 0, (GLvoid*) 0);
+		glDrawArrays(GL_LINES, 0, vertexCount);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+	}
+	else
+
+#endif
+	if (!batch.empty())
+	{
+		glVertexPointer(3, GL_FLOAT, 0, batch.data());
+		glDrawArrays(GL_LINES, 0, vertexCount);
+	}
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glPopAttrib();
+}
+
+// ********************************************************************************
+// End of file
+// ********************************************************************************
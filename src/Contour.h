@@ -0,0 +1,75 @@
+#ifndef _CONTOUR_H
+#define _CONTOUR_H
+
+#include "Object3D.h"
+#include <vector>
+
+namespace GLScene
+{
+
+/**
+ * TContour class
+ * The isolines of a surface at several levels (marching squares), drawn over the surface.
+ * eg : TContour contour(20);
+ *      surface->SetContour(&contour);
+ * The surface keeps a pointer on the contour and draws it with its own transformation,
+ * the contour must live as long as the surface uses it.
+ * The lines of each row of cells are extracted in parallel and drawn in one batch of lines.
+ * When rows of the surface change (TSurface::SetRows), only these rows are extracted
+ * again and the buffer is updated in place if the number of segments doesn't change.
+ */
+class TContour
+{
+	public:
+		TContour(GLuint levelCount = 10);
+		virtual ~TContour();
+
+		void SetLevels(GLuint count);
+		void SetLevels(const std::vector<GLfloat> &values);
+
+		void SetColor(const TVector4D &color)
+		{
+			this->color = color;
+		}
+
+		void SetLineWidth(GLfloat width)
+		{
+			lineWidth = width;
+		}
+
+		void Invalidate(void);
+		void InvalidateRows(GLuint first, GLuint count);
+
+		/// Number of segments of the last extraction
+		GLuint GetSegmentCount(void)
+		{
+			return vertexCount / 2;
+		}
+
+		void Display(const TVector3D *grid, GLuint dimX, GLuint dimY, double min, double max);
+
+	private:
+		GLuint levelCount;  // Levels equally spaced in the range of the surface, 0 for user levels
+		std::vector<GLfloat> levels;
+		TVector4D color;
+		GLfloat lineWidth;
+
+		// Segments of each row of cells (2 points by segment)
+		std::vector<std::vector<TGLfloat3D>> rows;
+		std::vector<TGLfloat3D> batch;
+		GLuint sizeX, sizeY;
+		double rangeMin, rangeMax;
+		GLuint dirtyBegin, dirtyEnd;  // Rows of cells to extract [dirtyBegin, dirtyEnd[
+		GLuint vertexCount;
+#ifdef USE_VBO
+		GLuint vboId = 0;  // ID of VBO for the lines
+#endif
+
+		void Update(const TVector3D *grid, GLuint dimX, GLuint dimY, double min, double max);
+		void ExtractRow(const TVector3D *grid, GLuint row, std::vector<TGLfloat3D> &segments) const;
+};
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _CONTOUR_H
@@ -127,19 +127,22 @@ void TCube::ComputeParameters(bool normalize)
 	reduced_pos = direction;
 	if (normalize)
 		reduced_pos.Normalize();
-	axe_angle = {-reduced_pos.Y, reduced_pos.X, 0.0};
-	angle = RADtoDEG * acos(reduced_pos.Z / size);
+	orientation = TQuaternion::FromTo(z_direction, reduced_pos);
 }
 
-void TCube::DoDisplay(TDisplayMode mode __attribute__((unused)))
+void TCube::ComputeModelMatrix(void)
 {
-	glTranslated(position.X, position.Y, position.Z);
-	if (!axe_angle.IsNull())
-		glRotated(angle, axe_angle.X, axe_angle.Y, axe_angle.Z);
+	TObject3D::ComputeModelMatrix();
+	modelMatrix.Translate(position);
+	if (!orientation.IsIdentity())
+		modelMatrix *= orientation.ToMatrix();
 	// Parallelepiped case, we scale the cube
 	if (!IsCube)
-		glScalef(size3D.X, size3D.Y, size3D.Z);
+		modelMatrix.Scale(size3D);
+}
 
+void TCube::DoDisplay(TDisplayMode mode __attribute__((unused)))
+{
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_NORMAL_ARRAY);
 
@@ -168,6 +171,17 @@ void TCube::DoDisplay(TDisplayMode mode __attribute__((unused)))
 	glDisableClientState(GL_NORMAL_ARRAY);
 }
 
+/**
+ * The cuboid is a unit cube scaled by the model matrix
+ */
+bool TCube::GetBounds(TVector3D &boxMin, TVector3D &boxMax)
+{
+	const GLfloat half = size / 2.0;
+	boxMin = TVector3D(-half, -half, -half);
+	boxMax = TVector3D(half, half, half);
+	return true;
+}
+
 // ********************************************************************************
 // End of file
 // ********************************************************************************
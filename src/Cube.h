@@ -19,17 +19,18 @@ class TCube: public TObject3D
 		TCube(TVector3D _size, const TVector3D &pos = GLDefaultPosition);
 		virtual ~TCube();
 
+		virtual bool GetBounds(TVector3D &boxMin, TVector3D &boxMax);
+
 	protected:
 		void DoDisplay(TDisplayMode mode = dmRender);
 		virtual void ComputeParameters(bool normalize = true);
+		virtual void ComputeModelMatrix(void);
 
 	private:
 		GLfloat *cube;
 		GLfloat size;
 		TVector3D size3D;
 		bool IsCube;
-		GLfloat angle;
-		TVector3D axe_angle;
 		TVector3D reduced_pos;
 };
 
@@ -1,4 +1,5 @@
 #include "Cylinder.h"
+#include "Tessellation.h"
 
 // Code for sphere construction inspired from :
 // AUTHOR: Song Ho Ahn (song.ahn@gmail.com)
@@ -77,14 +78,13 @@ void TCylinder::FreeArray(void)
 
 void TCylinder::CreateCylinder(void)
 {
-	// Body + base
-	double dtheta = (2.0 * PI / CylinderDetail);
-	double theta = 0.0;
+	// Body + base, the unit circle is computed once (at compile time for the usual levels)
+	const TCircleTable circle = UnitCircle(CylinderDetail);
 
 	for (GLuint i = 0; i < baseLength; ++i)
 	{
-		const double cos_theta = cos(theta);
-		const double sin_theta = sin(theta);
+		const double cos_theta = circle.Cos[i];
+		const double sin_theta = circle.Sin[i];
 		const float x = (float) (radius * cos_theta);
 		const float y = (float) (radius * sin_theta);
 
@@ -103,16 +103,11 @@ void TCylinder::CreateCylinder(void)
 
 		base_down[baseLength - 1 - i].SetVertice(x, y, -len2);
 		base_down[baseLength - 1 - i].SetNormal(0.0f, 0.0f, -1.0f);
-
-		theta += dtheta;
 	}
 }
 
 void TCylinder::DoDisplay(TDisplayMode mode __attribute__((unused)))
 {
-	glTranslated(position.X, position.Y, position.Z);
-	glRotated(angle, axe_angle.X, axe_angle.Y, axe_angle.Z);
-
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_NORMAL_ARRAY);
 
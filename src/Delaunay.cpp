@@ -0,0 +1,806 @@
+#include "Delaunay.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <thread>
+
+// The bounding box of the points is [-DELAUNAY_GRID_BOX, DELAUNAY_GRID_BOX] on the integer grid,
+// the points inserted later may go up to DELAUNAY_GRID_MAX. In this range the orientation
+// fits in 64 bits and the in circle test in 128 bits.
+#define DELAUNAY_GRID_BOX	(1 << 22)
+#define DELAUNAY_GRID_MAX	(1 << 28)
+// A pool has 2^26 edges at most (the index of the edge has 26 bits)
+#define DELAUNAY_MAX_EDGES	(1 << 26)
+#define DELAUNAY_MAX_POINTS	(1 << 23)
+// The x of the key of a point with a NaN or infinite coordinate
+#define DELAUNAY_REJECTED	INT32_MIN
+
+/**
+ * Signed integer of 128 bits (two's complement) for the exact in circle test
+ */
+typedef struct TInt128
+{
+	public:
+		uint64_t hi, lo;
+} TInt128;
+
+static TInt128 Multiply(int64_t a, int64_t b)
+{
+	const bool negative = (a < 0) != (b < 0);
+	const uint64_t ua = (a < 0) ? (uint64_t) 0 - (uint64_t) a : (uint64_t) a;
+	const uint64_t ub = (b < 0) ? (uint64_t) 0 - (uint64_t) b : (uint64_t) b;
+	const uint64_t a0 = ua & 0xFFFFFFFF, a1 = ua >> 32;
+	const uint64_t b0 = ub & 0xFFFFFFFF, b1 = ub >> 32;
+	const uint64_t p00 = a0 * b0, p01 = a0 * b1, p10 = a1 * b0, p11 = a1 * b1;
+	const uint64_t middle = (p00 >> 32) + (p01 & 0xFFFFFFFF) + (p10 & 0xFFFFFFFF);
+
+	TInt128 r;
+	r.lo = (p00 & 0xFFFFFFFF) | (middle << 32);
+	r.hi = p11 + (p01 >> 32) + (p10 >> 32) + (middle >> 32);
+	if (negative)
+	{
+		r.lo = ~r.lo + 1;
+		r.hi = ~r.hi + ((r.lo == 0) ? 1 : 0);
+	}
+	return r;
+}
+
+static TInt128 Add(const TInt128 &a, const TInt128 &b)
+{
+	TInt128 r;
+	r.lo = a.lo + b.lo;
+	r.hi = a.hi + b.hi + ((r.lo < a.lo) ? 1 : 0);
+	return r;
+}
+
+static int Sign(const TInt128 &a)
+{
+	if ((int64_t) a.hi < 0)
+		return -1;
+	return ((a.hi == 0) && (a.lo == 0)) ? 0 : 1;
+}
+
+/**
+ * A point of the sort of the vertices
+ */
+typedef struct TDelaunayKey
+{
+	public:
+		int32_t x, y;
+		GLuint index;
+
+		bool operator <(const TDelaunayKey &key) const
+		{
+			return (x < key.x) || ((x == key.x) && (y < key.y));
+		}
+} TDelaunayKey;
+
+TDelaunay::TDelaunay()
+{
+	parallelDepth = 0;
+	while (((1u << parallelDepth) < ParallelThreadCount()) && (parallelDepth < DELAUNAY_MAX_DEPTH))
+		parallelDepth++;
+	Clear();
+}
+
+void TDelaunay::Clear(void)
+{
+	std::vector<TDelaunayPoint>().swap(vertices);
+	std::vector<GLuint>().swap(indices);
+	for (int p = 0; p < DELAUNAY_POOLS; p++)
+	{
+		std::vector<TQuadEdge>().swap(pools[p]);
+		freeEdges[p] = DELAUNAY_NONE;
+	}
+	centerX = centerY = 0.0;
+	scale = 1.0;
+	pointCount = 0;
+	duplicates = 0;
+	rejected = 0;
+	lastEdge = DELAUNAY_NONE;
+	std::vector<GLuint>().swap(hints);
+	hintLevel = 0;
+	degenerate = true;
+}
+
+/**
+ * The point on the integer grid, false if it is too far from the bounding box or if a
+ * coordinate is NaN or infinite
+ */
+bool TDelaunay::Quantize(const TVector3D &point, TDelaunayPoint &q) const
+{
+	const double x = (point.X - centerX) * scale;
+	const double y = (point.Y - centerY) * scale;
+	if (!(fabs(x) <= DELAUNAY_GRID_MAX) || !(fabs(y) <= DELAUNAY_GRID_MAX))
+		return false;
+	q.x = (int32_t) floor(x + 0.5);
+	q.y = (int32_t) floor(y + 0.5);
+	return true;
+}
+
+/**
+ * Sign of the area of the triangle (a, b, c) : 1 counterclockwise, -1 clockwise, 0 aligned
+ */
+int TDelaunay::Orient(GLuint a, GLuint b, GLuint c) const
+{
+	const TDelaunayPoint &pa = vertices[a], &pb = vertices[b], &pc = vertices[c];
+	const int64_t det = (int64_t) (pb.x - pa.x) * (pc.y - pa.y) - (int64_t) (pb.y - pa.y) * (pc.x - pa.x);
+	return (det > 0) ? 1 : ((det < 0) ? -1 : 0);
+}
+
+/**
+ * Sign of the area of the triangle (a, b, c) on the real coordinates. The differences of
+ * the floats and their products are exact in double, so is the sign.
+ */
+static int RealOrient(const TVector3D &a, const TVector3D &b, const TVector3D &c)
+{
+	const double det = ((double) b.X - a.X) * ((double) c.Y - a.Y) - ((double) b.Y - a.Y) * ((double) c.X - a.X);
+	return (det > 0.0) ? 1 : ((det < 0.0) ? -1 : 0);
+}
+
+/**
+ * 1 if d is inside the circle of the counterclockwise triangle (a, b, c), -1 outside,
+ * 0 on the circle. Computed with doubles, in 128 bits when the result is not sure.
+ */
+int TDelaunay::InCircle(GLuint a, GLuint b, GLuint c, GLuint d) const
+{
+	const TDelaunayPoint &pd = vertices[d];
+	const int64_t adx = vertices[a].x - pd.x, ady = vertices[a].y - pd.y;
+	const int64_t bdx = vertices[b].x - pd.x, bdy = vertices[b].y - pd.y;
+	const int64_t cdx = vertices[c].x - pd.x, cdy = vertices[c].y - pd.y;
+
+	const int64_t aLift = adx * adx + ady * ady;
+	const int64_t bLift = bdx * bdx + bdy * bdy;
+	const int64_t cLift = cdx * cdx + cdy * cdy;
+	const int64_t bc = bdx * cdy - cdx * bdy;
+	const int64_t ca = cdx * ady - adx * cdy;
+	const int64_t ab = adx * bdy - bdx * ady;
+
+	const double det = (double) aLift * bc + (double) bLift * ca + (double) cLift * ab;
+	const double bound = 1e-14 * ((double) aLift * fabs((double) bc) + (double) bLift * fabs((double) ca) +
+			(double) cLift * fabs((double) ab));
+	if (det > bound)
+		return 1;
+	if (det < -bound)
+		return -1;
+	if (bound == 0.0)
+		return 0;
+
+	return Sign(Add(Add(Multiply(aLift, bc), Multiply(bLift, ca)), Multiply(cLift, ab)));
+}
+
+/**
+ * v strictly between a and b (v on the line (a, b))
+ */
+bool TDelaunay::Between(GLuint v, GLuint a, GLuint b) const
+{
+	const TDelaunayPoint &p = vertices[v], &pa = vertices[a], &pb = vertices[b];
+	return ((int64_t) (p.x - pa.x) * (p.x - pb.x) <= 0) && ((int64_t) (p.y - pa.y) * (p.y - pb.y) <= 0) &&
+			!Same(v, a) && !Same(v, b);
+}
+
+bool TDelaunay::Same(GLuint a, GLuint b) const
+{
+	return (vertices[a].x == vertices[b].x) && (vertices[a].y == vertices[b].y);
+}
+
+/**
+ * New edge, a deleted edge of the pool is used again if any
+ */
+GLuint TDelaunay::MakeEdge(GLuint pool, GLuint org, GLuint dest)
+{
+	GLuint e = freeEdges[pool];
+	if (e != DELAUNAY_NONE)
+	{
+		TQuadEdge &quad = Quad(e);
+		freeEdges[pool] = quad.next[0];
+		quad = {{e, e + 3, e + 2, e + 1}, {org, dest}};
+		return e;
+	}
+
+	std::vector<TQuadEdge> &quads = pools[pool];
+	e = (pool << 28) | ((GLuint) quads.size() << 2);
+	quads.push_back({{e, e + 3, e + 2, e + 1}, {org, dest}});
+	return e;
+}
+
+/**
+ * Exchange the rings of a and b (and of their duals)
+ */
+void TDelaunay::Splice(GLuint a, GLuint b)
+{
+	const GLuint alpha = Rot(Onext(a));
+	const GLuint beta = Rot(Onext(b));
+	std::swap(Quad(a).next[a & 3], Quad(b).next[b & 3]);
+	std::swap(Quad(alpha).next[alpha & 3], Quad(beta).next[beta & 3]);
+}
+
+/**
+ * New edge from the destination of a to the origin of b, in the left face of a and b
+ */
+GLuint TDelaunay::Connect(GLuint pool, GLuint a, GLuint b)
+{
+	const GLuint e = MakeEdge(pool, Dest(a), Org(b));
+	Splice(e, Lnext(a));
+	Splice(Sym(e), b);
+	return e;
+}
+
+void TDelaunay::DeleteEdge(GLuint pool, GLuint e)
+{
+	Splice(e, Oprev(e));
+	Splice(Sym(e), Oprev(Sym(e)));
+
+	e &= ~3u;
+	TQuadEdge &quad = Quad(e);
+	quad.org[0] = quad.org[1] = DELAUNAY_NONE;
+	quad.next[0] = freeEdges[pool];
+	freeEdges[pool] = e;
+}
+
+/**
+ * Replace e by the other diagonal of the quadrilateral of its two triangles
+ */
+void TDelaunay::Flip(GLuint e)
+{
+	const GLuint a = Oprev(e);
+	const GLuint b = Oprev(Sym(e));
+	Splice(e, a);
+	Splice(Sym(e), b);
+	Splice(e, Lnext(a));
+	Splice(Sym(e), Lnext(b));
+	const GLuint org = Dest(a), dest = Dest(b);
+	Quad(e).org[(e >> 1) & 1] = org;
+	Quad(e).org[((e >> 1) & 1) ^ 1] = dest;
+}
+
+/**
+ * The points on the integer grid sorted by x then y in parallel, without the duplicates
+ * and the points rejected by Quantize
+ */
+void TDelaunay::SortVertices(const TVector3D *points, GLuint count)
+{
+	std::vector<TDelaunayKey> keys(count);
+	ParallelFor(0, count, [this, points, &keys](size_t begin, size_t end)
+	{
+		TDelaunayPoint q;
+		for (size_t k = begin; k < end; k++)
+		{
+			if (Quantize(points[k], q))
+				keys[k] = {q.x, q.y, (GLuint) k};
+			else
+				keys[k] = {DELAUNAY_REJECTED, 0, (GLuint) k};
+		}
+	}, 1 << 16);
+
+	const size_t chunks = std::min((size_t) ParallelThreadCount(), (size_t) count / (1 << 14) + 1);
+	auto bound = [count, chunks](size_t chunk) -> size_t
+	{
+		return (count * chunk) / chunks;
+	};
+	ParallelFor(0, chunks, [&keys, &bound](size_t begin, size_t end)
+	{
+		for (size_t c = begin; c < end; c++)
+			std::sort(keys.begin() + bound(c), keys.begin() + bound(c + 1));
+	});
+	for (size_t width = 1; width < chunks; width *= 2)
+	{
+		ParallelFor(0, (chunks + 2 * width - 1) / (2 * width), [&keys, &bound, width, chunks](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; i++)
+			{
+				const size_t first = 2 * width * i;
+				const size_t middle = std::min(first + width, chunks);
+				const size_t last = std::min(first + 2 * width, chunks);
+				if (middle < last)
+					std::inplace_merge(keys.begin() + bound(first), keys.begin() + bound(middle), keys.begin() + bound(last));
+			}
+		});
+	}
+
+	vertices.reserve(count);
+	indices.reserve(count);
+	for (size_t k = 0; k < count; k++)
+	{
+		if (keys[k].x == DELAUNAY_REJECTED)
+			rejected++;
+		else
+			if ((k > 0) && (keys[k].x == keys[k - 1].x) && (keys[k].y == keys[k - 1].y))
+				duplicates++;
+			else
+			{
+				vertices.push_back({keys[k].x, keys[k].y});
+				indices.push_back(keys[k].index);
+			}
+	}
+}
+
+/**
+ * Triangulate the sorted vertices [lo, hi[ (at least 2). left is the counterclockwise
+ * convex hull edge out of the leftmost vertex, right the clockwise convex hull edge out
+ * of the rightmost vertex. The first levels run the left half on another thread, each
+ * thread creates its edges in its own pool.
+ */
+void TDelaunay::Divide(GLuint lo, GLuint hi, GLuint pool, GLuint depth, GLuint &left, GLuint &right)
+{
+	const GLuint n = hi - lo;
+	const GLuint s[3] = {lo, lo + 1, lo + 2};
+
+	if (n == 2)
+	{
+		left = MakeEdge(pool, s[0], s[1]);
+		right = Sym(left);
+		return;
+	}
+
+	if (n == 3)
+	{
+		const GLuint a = MakeEdge(pool, s[0], s[1]);
+		const GLuint b = MakeEdge(pool, s[1], s[2]);
+		Splice(Sym(a), b);
+		if (CCW(s[0], s[1], s[2]))
+		{
+			Connect(pool, b, a);
+			left = a;
+			right = Sym(b);
+		}
+		else
+			if (CCW(s[0], s[2], s[1]))
+			{
+				const GLuint c = Connect(pool, b, a);
+				left = Sym(c);
+				right = c;
+			}
+			else
+			{
+				// Aligned
+				left = a;
+				right = Sym(b);
+			}
+		return;
+	}
+
+	const GLuint middle = lo + n / 2;
+	GLuint ldo, ldi, rdi, rdo;
+	if ((depth < parallelDepth) && (n >= DELAUNAY_PARALLEL_MIN))
+	{
+		std::thread worker([this, lo, middle, pool, depth, &ldo, &ldi]()
+		{
+			Divide(lo, middle, 2 * pool + 1, depth + 1, ldo, ldi);
+		});
+		Divide(middle, hi, 2 * pool + 2, depth + 1, rdi, rdo);
+		worker.join();
+	}
+	else
+	{
+		Divide(lo, middle, pool, parallelDepth, ldo, ldi);
+		Divide(middle, hi, pool, parallelDepth, rdi, rdo);
+	}
+
+	// Lower common tangent of the two halves
+	for (;;)
+	{
+		if (CCW(Org(rdi), Org(ldi), Dest(ldi)))
+			ldi = Lnext(ldi);
+		else
+			if (RightOf(Org(ldi), rdi))
+				rdi = Rprev(rdi);
+			else
+				break;
+	}
+
+	// Merge from the bottom to the top
+	GLuint basel = Connect(pool, Sym(rdi), ldi);
+	if (Org(ldi) == Org(ldo))
+		ldo = Sym(basel);
+	if (Org(rdi) == Org(rdo))
+		rdo = basel;
+
+	for (;;)
+	{
+		GLuint lcand = Onext(Sym(basel));
+		if (RightOf(Dest(lcand), basel))
+			while (InCircle(Dest(basel), Org(basel), Dest(lcand), Dest(Onext(lcand))) > 0)
+			{
+				const GLuint t = Onext(lcand);
+				DeleteEdge(pool, lcand);
+				lcand = t;
+			}
+
+		GLuint rcand = Oprev(basel);
+		if (RightOf(Dest(rcand), basel))
+			while (InCircle(Dest(basel), Org(basel), Dest(rcand), Dest(Oprev(rcand))) > 0)
+			{
+				const GLuint t = Oprev(rcand);
+				DeleteEdge(pool, rcand);
+				rcand = t;
+			}
+
+		const bool leftValid = RightOf(Dest(lcand), basel);
+		const bool rightValid = RightOf(Dest(rcand), basel);
+		if (!leftValid && !rightValid)
+			break;
+
+		if (!leftValid || (rightValid && (InCircle(Dest(lcand), Org(lcand), Org(rcand), Dest(rcand)) > 0)))
+			basel = Connect(pool, rcand, Sym(basel));
+		else
+			basel = Connect(pool, Sym(basel), Sym(lcand));
+	}
+
+	left = ldo;
+	right = rdo;
+}
+
+/**
+ * Triangulation of the points (x, y), z is not used
+ */
+void TDelaunay::Triangulate(const TVector3D *points, GLuint count)
+{
+	Clear();
+	if ((points == NULL) || (count == 0))
+		return;
+	if (count > DELAUNAY_MAX_POINTS)
+	{
+		std::cout << "[WARNING] Too many points for the Delaunay triangulation." << std::endl;
+		count = DELAUNAY_MAX_POINTS;
+	}
+
+	// The bounding box of the finite points
+	double xMin = HUGE_VAL, xMax = -HUGE_VAL, yMin = HUGE_VAL, yMax = -HUGE_VAL;
+	for (GLuint k = 0; k < count; k++)
+	{
+		if (!std::isfinite(points[k].X) || !std::isfinite(points[k].Y))
+			continue;
+		xMin = std::min(xMin, (double) points[k].X);
+		xMax = std::max(xMax, (double) points[k].X);
+		yMin = std::min(yMin, (double) points[k].Y);
+		yMax = std::max(yMax, (double) points[k].Y);
+	}
+	if (xMin > xMax)
+		xMin = xMax = yMin = yMax = 0.0;
+	centerX = 0.5 * (xMin + xMax);
+	centerY = 0.5 * (yMin + yMax);
+	const double half = 0.5 * std::max(xMax - xMin, yMax - yMin);
+	scale = (half > 0.0) ? DELAUNAY_GRID_BOX / half : 1.0;
+
+	pointCount = count;
+	SortVertices(points, count);
+
+	// Aligned on the grid, or on the real coordinates : the snapping moves the points of
+	// a sloped line off the line, the triangles would be flat or clockwise
+	const GLuint n = (GLuint) vertices.size();
+	bool gridAligned = true, realAligned = true;
+	for (GLuint k = 2; (k < n) && (gridAligned || realAligned); k++)
+	{
+		if (Orient(0, 1, k) != 0)
+			gridAligned = false;
+		if (RealOrient(points[indices[0]], points[indices[1]], points[indices[k]]) != 0)
+			realAligned = false;
+	}
+	degenerate = gridAligned || realAligned;
+	if (degenerate)
+		return;
+
+	GLuint left, right;
+	Divide(0, n, 0, 0, left, right);
+	lastEdge = left;
+
+	// The deleted edges of the threads are used by Insert
+	for (GLuint p = 1; p < DELAUNAY_POOLS; p++)
+		while (freeEdges[p] != DELAUNAY_NONE)
+		{
+			const GLuint e = freeEdges[p];
+			freeEdges[p] = Quad(e).next[0];
+			Quad(e).next[0] = freeEdges[0];
+			freeEdges[0] = e;
+		}
+
+	BuildHints();
+}
+
+/**
+ * The cell of the vertex v in the grid of the start edges, the vertices outside the
+ * bounding box are in the cells of the border
+ */
+GLuint TDelaunay::HintCell(GLuint v) const
+{
+	const int64_t last = ((int64_t) 1 << hintLevel) - 1;
+	const int shift = 23 - hintLevel;
+	const int64_t i = std::min(std::max(((int64_t) vertices[v].x + DELAUNAY_GRID_BOX) >> shift, (int64_t) 0), last);
+	const int64_t j = std::min(std::max(((int64_t) vertices[v].y + DELAUNAY_GRID_BOX) >> shift, (int64_t) 0), last);
+	return (GLuint) ((j << hintLevel) + i);
+}
+
+/**
+ * An edge out of a vertex of each cell, about 2 vertices by cell. The empty cells take
+ * the edge of the previous cell of their row, the empty rows the edges of the previous row.
+ */
+void TDelaunay::BuildHints(void)
+{
+	hintLevel = 0;
+	while ((hintLevel < DELAUNAY_HINT_LEVEL) && (((size_t) 1 << (2 * hintLevel + 3)) <= vertices.size()))
+		hintLevel++;
+	const GLuint size = 1 << hintLevel;
+	hints.assign((size_t) size * size, DELAUNAY_NONE);
+
+	for (GLuint p = 0; p < DELAUNAY_POOLS; p++)
+		for (size_t k = 0; k < pools[p].size(); k++)
+			if (pools[p][k].org[0] != DELAUNAY_NONE)
+			{
+				const GLuint e = (p << 28) | ((GLuint) k << 2);
+				hints[HintCell(Org(e))] = e;
+				hints[HintCell(Dest(e))] = Sym(e);
+			}
+
+	for (GLuint j = 0; j < size; j++)
+	{
+		GLuint *row = &hints[(size_t) j * size];
+		for (GLuint i = 1; i < size; i++)
+			if (row[i] == DELAUNAY_NONE)
+				row[i] = row[i - 1];
+		for (GLuint i = size - 1; i > 0; i--)
+			if (row[i - 1] == DELAUNAY_NONE)
+				row[i - 1] = row[i];
+	}
+	for (GLuint j = 1; j < size; j++)
+		if (hints[(size_t) j * size] == DELAUNAY_NONE)
+			std::copy_n(&hints[(size_t) (j - 1) * size], size, &hints[(size_t) j * size]);
+	for (GLuint j = size - 1; j > 0; j--)
+		if (hints[(size_t) (j - 1) * size] == DELAUNAY_NONE)
+			std::copy_n(&hints[(size_t) j * size], size, &hints[(size_t) (j - 1) * size]);
+}
+
+/**
+ * Start of the walk to v : the edge of the cell of v, the walk is then a few triangles
+ * long. The edge may have been flipped since (it is still near) or deleted (then the
+ * last edge).
+ */
+GLuint TDelaunay::StartEdge(GLuint v)
+{
+	const GLuint e = hints[HintCell(v)];
+	if ((e == DELAUNAY_NONE) || (Quad(e).org[0] == DELAUNAY_NONE))
+		return lastEdge;
+	return e;
+}
+
+/**
+ * Connect v to the convex hull. e has the outside of the convex hull on its left and
+ * v is on its left or on its line. Return an edge out of v, DELAUNAY_NONE if v is a vertex.
+ */
+GLuint TDelaunay::ConnectOutside(GLuint v, GLuint e)
+{
+	// First edge of the hull that sees v or that contains v
+	GLuint visible = e;
+	for (;;)
+	{
+		if (Same(v, Org(visible)))
+			return DELAUNAY_NONE;
+		const int orient = Orient(v, Org(visible), Dest(visible));
+		if (orient > 0)
+			break;
+
+		if ((orient == 0) && Between(v, Org(visible), Dest(visible)))
+		{
+			// Split the edge, v is connected to the vertex of its triangle
+			const GLuint e1 = Lnext(Sym(visible));
+			const GLuint e2 = Lnext(e1);
+			DeleteEdge(0, visible);
+			GLuint base = MakeEdge(0, Org(e1), v);
+			Splice(base, e1);
+			base = Connect(0, e1, Sym(base));
+			base = Connect(0, e2, Sym(base));
+			return Sym(base);
+		}
+		visible = Lnext(visible);
+	}
+
+	// All the edges of the hull that see v
+	GLuint first = visible, last = visible;
+	while ((Lprev(first) != last) && CCW(v, Org(Lprev(first)), Dest(Lprev(first))))
+		first = Lprev(first);
+	while ((Lnext(last) != first) && CCW(v, Org(Lnext(last)), Dest(Lnext(last))))
+		last = Lnext(last);
+
+	std::vector<GLuint> chain;
+	for (GLuint c = first; ; c = Lnext(c))
+	{
+		chain.push_back(c);
+		if (c == last)
+			break;
+	}
+
+	GLuint base = MakeEdge(0, Org(first), v);
+	Splice(base, first);
+	for (size_t k = 0; k < chain.size(); k++)
+		base = Connect(0, chain[k], Sym(base));
+	return Sym(base);
+}
+
+/**
+ * Flip the edges opposite to v that are not Delaunay (spoke is an edge out of v)
+ */
+void TDelaunay::Legalize(GLuint v, GLuint spoke)
+{
+	stack.clear();
+	GLuint s = spoke;
+	do
+	{
+		if (!Exterior(s))
+			stack.push_back(Lnext(s));
+		s = Onext(s);
+	} while (s != spoke);
+
+	// v is on the left of the edges of the stack
+	while (!stack.empty())
+	{
+		const GLuint e = stack.back();
+		stack.pop_back();
+		const GLuint f = Sym(e);
+		if (Exterior(f))
+			continue;
+
+		const GLuint r1 = Lnext(f);
+		const GLuint r2 = Lnext(r1);
+		if (InCircle(Org(e), Dest(e), v, Dest(r1)) > 0)
+		{
+			Flip(e);
+			stack.push_back(r1);
+			stack.push_back(r2);
+		}
+	}
+}
+
+/**
+ * Add a point to the triangulation. Return false if it can't be inserted (less than
+ * 3 points not aligned, the point is too far from the first points or the edges are
+ * too many), the points must then be triangulated again.
+ */
+bool TDelaunay::Insert(const TVector3D &point)
+{
+	if (!std::isfinite(point.X) || !std::isfinite(point.Y))
+	{
+		pointCount++;
+		rejected++;
+		return true;
+	}
+
+	// An insertion creates at most one edge by vertex of the convex hull plus 3
+	TDelaunayPoint q;
+	if (degenerate || (pools[0].size() + vertices.size() + 3 > DELAUNAY_MAX_EDGES) || !Quantize(point, q))
+		return false;
+	const GLuint v = (GLuint) vertices.size();
+	vertices.push_back(q);
+	indices.push_back(pointCount++);
+
+	// Walk to the triangle that contains v, v is never on the right of e
+	GLuint e = StartEdge(v);
+	if (RightOf(v, e))
+		e = Sym(e);
+
+	GLuint spoke;
+	for (;;)
+	{
+		if (Exterior(e))
+		{
+			spoke = ConnectOutside(v, e);
+			break;
+		}
+
+		const GLuint e1 = Lnext(e);
+		const GLuint e2 = Lnext(e1);
+		if (RightOf(v, e1))
+		{
+			e = Sym(e1);
+			continue;
+		}
+		if (RightOf(v, e2))
+		{
+			e = Sym(e2);
+			continue;
+		}
+
+		if (Same(v, Org(e)) || Same(v, Org(e1)) || Same(v, Org(e2)))
+		{
+			spoke = DELAUNAY_NONE;
+			break;
+		}
+
+		// On an edge : remove it, or split it if it is on the convex hull
+		GLuint on = DELAUNAY_NONE;
+		if (Orient(v, Org(e), Dest(e)) == 0)
+			on = e;
+		else
+			if (Orient(v, Org(e1), Dest(e1)) == 0)
+				on = e1;
+			else
+				if (Orient(v, Org(e2), Dest(e2)) == 0)
+					on = e2;
+		if (on != DELAUNAY_NONE)
+		{
+			if (Exterior(Sym(on)))
+			{
+				spoke = ConnectOutside(v, Sym(on));
+				break;
+			}
+			e = Oprev(on);
+			DeleteEdge(0, on);
+		}
+
+		// Connect v to the vertices of the face
+		GLuint base = MakeEdge(0, Org(e), v);
+		Splice(base, e);
+		const GLuint start = base;
+		do
+		{
+			base = Connect(0, e, Sym(base));
+			e = Oprev(base);
+		} while (Lnext(e) != start);
+		spoke = Sym(start);
+		break;
+	}
+
+	if (spoke == DELAUNAY_NONE)
+	{
+		vertices.pop_back();
+		indices.pop_back();
+		duplicates++;
+		return true;
+	}
+
+	Legalize(v, spoke);
+	lastEdge = spoke;
+	hints[HintCell(v)] = spoke;
+	return true;
+}
+
+/**
+ * The counterclockwise triangles, 3 indices of vertices by triangle. With the points given
+ * to Triangulate and Insert (in the same order), the triangles that the snapping on the
+ * grid made flat or clockwise on the real coordinates are left out.
+ */
+void TDelaunay::GetTriangles(std::vector<GLuint> &triangles, const TVector3D *points)
+{
+	triangles.clear();
+	for (GLuint p = 0; p < DELAUNAY_POOLS; p++)
+	{
+		const size_t count = pools[p].size();
+		if (count == 0)
+			continue;
+
+		// Each chunk of edges writes its own triangles
+		const size_t chunkSize = 1 << 16;
+		std::vector<std::vector<GLuint>> chunks((count + chunkSize - 1) / chunkSize);
+		ParallelFor(0, chunks.size(), [this, p, count, chunkSize, points, &chunks](size_t begin, size_t end)
+		{
+			for (size_t c = begin; c < end; c++)
+			{
+				std::vector<GLuint> &out = chunks[c];
+				const size_t last = std::min((c + 1) * chunkSize, count);
+				for (size_t k = c * chunkSize; k < last; k++)
+				{
+					if (pools[p][k].org[0] == DELAUNAY_NONE)
+						continue;
+					for (GLuint r = 0; r < 4; r += 2)
+					{
+						const GLuint e = (p << 28) | ((GLuint) k << 2) | r;
+						const GLuint e1 = Lnext(e);
+						const GLuint e2 = Lnext(e1);
+						// Each triangle once, from its smallest edge
+						if ((e < e1) && (e < e2) && !Exterior(e))
+						{
+							const GLuint a = indices[Org(e)], b = indices[Org(e1)], c = indices[Org(e2)];
+							if ((points == NULL) || (RealOrient(points[a], points[b], points[c]) > 0))
+								out.insert(out.end(), {a, b, c});
+						}
+					}
+				}
+			}
+		});
+
+		for (size_t c = 0; c < chunks.size(); c++)
+			triangles.insert(triangles.end(), chunks[c].begin(), chunks[c].end());
+	}
+}
+
+// ********************************************************************************
+// End of file
+// ********************************************************************************
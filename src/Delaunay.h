@@ -0,0 +1,186 @@
+#ifndef _DELAUNAY_H
+#define _DELAUNAY_H
+
+#include "Object3D.h"
+#include <vector>
+#include <cstdint>
+
+namespace GLScene
+{
+
+// The recursion of the triangulation uses up to 2^DELAUNAY_MAX_DEPTH threads
+#define DELAUNAY_MAX_DEPTH	3
+#define DELAUNAY_POOLS	16
+// Min number of points of a half to triangulate it on its own thread
+#define DELAUNAY_PARALLEL_MIN	(1 << 14)
+#define DELAUNAY_NONE	0xFFFFFFFF
+// The grid of the start edges of Insert has at most 2^DELAUNAY_HINT_LEVEL cells along x and y
+#define DELAUNAY_HINT_LEVEL	11
+
+/**
+ * An edge of the triangulation with its dual (quad-edge of Guibas and Stolfi).
+ * next[r] is the next edge counterclockwise around the origin of the rotation r,
+ * org[0] and org[1] are the ends of the edge.
+ */
+typedef struct TQuadEdge
+{
+	public:
+		GLuint next[4];
+		GLuint org[2];
+} TQuadEdge;
+
+/**
+ * The coordinates (x, y) on the integer grid of the triangulation
+ */
+typedef struct TDelaunayPoint
+{
+	public:
+		int32_t x, y;
+} TDelaunayPoint;
+
+/**
+ * TDelaunay class
+ * Delaunay triangulation of the points (x, y) of a set of 3D points.
+ * Triangulate uses the divide and conquer algorithm of Guibas and Stolfi, the halves of the
+ * first levels of the recursion are triangulated on their own threads.
+ * Insert adds a point to the triangulation (walk to the triangle that contains the point
+ * from an edge of its cell in a grid over the bounding box, about 2 points by cell, then
+ * flip the edges that are not Delaunay), the points outside the convex hull included.
+ * The points are snapped on an integer grid of 2^23 steps over the bounding box so the
+ * orientation and in circle tests are exact, the points snapped on the same place are
+ * only triangulated once (the other ones are counted by GetDuplicateCount). The points
+ * with a NaN or infinite coordinate are left out (counted by GetRejectedCount).
+ * The snapping moves the points of a sloped line off the line : the points aligned on
+ * their real coordinates are not triangulated, and GetTriangles given the points leaves
+ * out the triangles that the snapping made flat or clockwise.
+ * The vertices are stored sorted so the recursion reads contiguous memory, the triangles
+ * give the index of the point in the array given to Triangulate (the points inserted next
+ * have the following indices).
+ */
+class TDelaunay
+{
+	public:
+		TDelaunay();
+
+		void Clear(void);
+		void Triangulate(const TVector3D *points, GLuint count);
+		bool Insert(const TVector3D &point);
+
+		/// Number of points given to Triangulate and Insert
+		GLuint GetPointCount(void)
+		{
+			return pointCount;
+		}
+
+		/// Number of points at the same place as a previous point
+		GLuint GetDuplicateCount(void)
+		{
+			return duplicates;
+		}
+
+		/// Number of points with a NaN or infinite coordinate
+		GLuint GetRejectedCount(void)
+		{
+			return rejected;
+		}
+
+		void GetTriangles(std::vector<GLuint> &triangles, const TVector3D *points = NULL);
+
+	private:
+		std::vector<TDelaunayPoint> vertices;  // Sorted by x then y, then the inserted points
+		std::vector<GLuint> indices;  // The index of the point of each vertex
+		std::vector<TQuadEdge> pools[DELAUNAY_POOLS];  // One pool for each thread of Triangulate
+		GLuint freeEdges[DELAUNAY_POOLS];  // Deleted edges of each pool, linked by next[0]
+		double centerX, centerY, scale;  // Transformation to the integer grid
+		GLuint pointCount;
+		GLuint duplicates;
+		GLuint rejected;
+		GLuint parallelDepth;
+		GLuint lastEdge;  // Start of the walk of Insert if its cell has no edge
+		std::vector<GLuint> hints;  // An edge out of a vertex of each cell, start of the walk of Insert
+		GLuint hintLevel;  // 2^hintLevel x 2^hintLevel cells over the bounding box
+		std::vector<GLuint> stack;  // Edges to check by Legalize
+		bool degenerate;  // Less than 3 points or all the points aligned
+
+		inline TQuadEdge &Quad(GLuint e)
+		{
+			return pools[e >> 28][(e >> 2) & 0x3FFFFFF];
+		}
+		static inline GLuint Rot(GLuint e)
+		{
+			return (e & ~3u) | ((e + 1) & 3u);
+		}
+		static inline GLuint Sym(GLuint e)
+		{
+			return (e & ~3u) | ((e + 2) & 3u);
+		}
+		static inline GLuint InvRot(GLuint e)
+		{
+			return (e & ~3u) | ((e + 3) & 3u);
+		}
+		inline GLuint Onext(GLuint e)
+		{
+			return Quad(e).next[e & 3];
+		}
+		inline GLuint Oprev(GLuint e)
+		{
+			return Rot(Onext(Rot(e)));
+		}
+		inline GLuint Lnext(GLuint e)
+		{
+			return Rot(Onext(InvRot(e)));
+		}
+		inline GLuint Lprev(GLuint e)
+		{
+			return Sym(Onext(e));
+		}
+		inline GLuint Rprev(GLuint e)
+		{
+			return Onext(Sym(e));
+		}
+		inline GLuint Org(GLuint e)
+		{
+			return Quad(e).org[(e >> 1) & 1];
+		}
+		inline GLuint Dest(GLuint e)
+		{
+			return Org(Sym(e));
+		}
+
+		bool Quantize(const TVector3D &point, TDelaunayPoint &q) const;
+		int Orient(GLuint a, GLuint b, GLuint c) const;
+		int InCircle(GLuint a, GLuint b, GLuint c, GLuint d) const;
+		inline bool CCW(GLuint a, GLuint b, GLuint c) const
+		{
+			return (Orient(a, b, c) > 0);
+		}
+		inline bool RightOf(GLuint v, GLuint e)
+		{
+			return CCW(v, Dest(e), Org(e));
+		}
+		inline bool Exterior(GLuint e)
+		{
+			return (Orient(Org(e), Dest(e), Dest(Lnext(e))) <= 0);
+		}
+		bool Between(GLuint v, GLuint a, GLuint b) const;
+		bool Same(GLuint a, GLuint b) const;
+
+		GLuint MakeEdge(GLuint pool, GLuint org, GLuint dest);
+		void Splice(GLuint a, GLuint b);
+		GLuint Connect(GLuint pool, GLuint a, GLuint b);
+		void DeleteEdge(GLuint pool, GLuint e);
+		void Flip(GLuint e);
+
+		void SortVertices(const TVector3D *points, GLuint count);
+		void Divide(GLuint lo, GLuint hi, GLuint pool, GLuint depth, GLuint &left, GLuint &right);
+		GLuint HintCell(GLuint v) const;
+		void BuildHints(void);
+		GLuint StartEdge(GLuint v);
+		GLuint ConnectOutside(GLuint v, GLuint e);
+		void Legalize(GLuint v, GLuint spoke);
+};
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _DELAUNAY_H
@@ -0,0 +1,116 @@
+#include "FileMapping.h"
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+using namespace GLScene;
+
+TMappedFile::TMappedFile()
+{
+	data = NULL;
+	size = 0;
+	opened = false;
+#ifdef _WIN32
+	hFile = INVALID_HANDLE_VALUE;
+	hMapping = NULL;
+#else
+	fd = -1;
+#endif
+}
+
+TMappedFile::~TMappedFile()
+{
+	Close();
+}
+
+/**
+ * Map the whole file in memory. Return false if the file can not be opened or mapped.
+ */
+bool TMappedFile::Open(const char *filename)
+{
+	Close();
+
+#ifdef _WIN32
+	hFile = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(hFile, &fileSize))
+	{
+		Close();
+		return false;
+	}
+	size = (size_t) fileSize.QuadPart;
+	opened = true;
+	if (size == 0)
+		return true;
+
+	hMapping = CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (hMapping != NULL)
+		data = (const char*) MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+#else
+	fd = open(filename, O_RDONLY);
+	if (fd < 0)
+		return false;
+
+	struct stat st;
+	if (fstat(fd, &st) != 0)
+	{
+		Close();
+		return false;
+	}
+	size = (size_t) st.st_size;
+	opened = true;
+	if (size == 0)
+		return true;
+
+	void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (map != MAP_FAILED)
+	{
+		data = (const char*) map;
+		// We read the file from the beginning to the end
+		madvise(map, size, MADV_SEQUENTIAL);
+	}
+#endif
+
+	if (data == NULL)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void TMappedFile::Close(void)
+{
+#ifdef _WIN32
+	if (data != NULL)
+		UnmapViewOfFile(data);
+	if (hMapping != NULL)
+		CloseHandle(hMapping);
+	if (hFile != INVALID_HANDLE_VALUE)
+		CloseHandle(hFile);
+	hMapping = NULL;
+	hFile = INVALID_HANDLE_VALUE;
+#else
+	if (data != NULL)
+		munmap((void*) data, size);
+	if (fd >= 0)
+		close(fd);
+	fd = -1;
+#endif
+	data = NULL;
+	size = 0;
+	opened = false;
+}
+
+// ********************************************************************************
+// End of file
+// ********************************************************************************
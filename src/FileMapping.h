@@ -0,0 +1,57 @@
+#ifndef _FILE_MAPPING_H
+#define _FILE_MAPPING_H
+
+#include <cstddef>
+
+namespace GLScene
+{
+
+/**
+ * TMappedFile class
+ * A read only file mapped in memory (mmap for Linux/Mac, file mapping for Windows).
+ * The data are valid until Close or the destruction of the object.
+ */
+class TMappedFile
+{
+	public:
+		TMappedFile();
+		virtual ~TMappedFile();
+
+		bool Open(const char *filename);
+		void Close(void);
+
+		inline const char* Data(void) const
+		{
+			return data;
+		}
+
+		inline size_t Size(void) const
+		{
+			return size;
+		}
+
+		inline bool IsOpen(void) const
+		{
+			return (data != NULL) || opened;
+		}
+
+	private:
+		const char *data;
+		size_t size;
+		bool opened;  // An empty file is open but has no data
+#ifdef _WIN32
+		void *hFile;
+		void *hMapping;
+#else
+		int fd;
+#endif
+
+		// No copy
+		TMappedFile(const TMappedFile&);
+		TMappedFile& operator=(const TMappedFile&);
+};
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _FILE_MAPPING_H
@@ -0,0 +1,140 @@
+#include "Frustum.h"
+#include <algorithm>
+
+TFrustum::TFrustum()
+{
+
+}
+
+TFrustum::~TFrustum()
+{
+
+}
+
+/**
+ * Extract the planes from the current OpenGL modelview and projection matrix
+ */
+void TFrustum::Extract(void)
+{
+	GLfloat modelview[16];
+	GLfloat projection[16];
+
+	glGetFloatv(GL_MODELVIEW_MATRIX, modelview);
+	glGetFloatv(GL_PROJECTION_MATRIX, projection);
+	Extract(modelview, projection);
+}
+
+/**
+ * Extract the planes from the matrix (column major like OpenGL)
+ * Method of Gribb & Hartmann
+ */
+void TFrustum::Extract(const GLfloat *modelview, const GLfloat *projection)
+{
+	GLfloat clip[16];
+
+	// clip = projection * modelview
+	for (int c = 0; c < 4; c++)
+	{
+		for (int r = 0; r < 4; r++)
+		{
+			clip[c * 4 + r] = projection[r] * modelview[c * 4] + projection[4 + r] * modelview[c * 4 + 1]
+					+ projection[8 + r] * modelview[c * 4 + 2] + projection[12 + r] * modelview[c * 4 + 3];
+		}
+	}
+
+	// Row i of the clip matrix is (clip[i], clip[4 + i], clip[8 + i], clip[12 + i])
+	for (int i = 0; i < 3; i++)
+	{
+		for (int k = 0; k < 4; k++)
+		{
+			planes[2 * i].Set(k, clip[k * 4 + 3] + clip[k * 4 + i]);
+			planes[2 * i + 1].Set(k, clip[k * 4 + 3] - clip[k * 4 + i]);
+		}
+	}
+
+	// Normalize the planes so we can use distance with sphere
+	for (int i = 0; i < 6; i++)
+	{
+		GLfloat len = sqrtf(planes[i].X * planes[i].X + planes[i].Y * planes[i].Y + planes[i].Z * planes[i].Z);
+		if (len > Epsilon)
+			planes[i] /= len;
+	}
+}
+
+bool TFrustum::PointVisible(const TVector3D &point) const
+{
+	for (int i = 0; i < 6; i++)
+	{
+		if (planes[i].X * point.X + planes[i].Y * point.Y + planes[i].Z * point.Z + planes[i].alpha < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+bool TFrustum::SphereVisible(const TVector3D &center, GLfloat radius) const
+{
+	for (int i = 0; i < 6; i++)
+	{
+		if (planes[i].X * center.X + planes[i].Y * center.Y + planes[i].Z * center.Z + planes[i].alpha < -radius)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Test an axis aligned box. For each plane we only test the corner of the box
+ * that is the most in the direction of the plane normal.
+ */
+bool TFrustum::BoxVisible(const TVector3D &boxMin, const TVector3D &boxMax) const
+{
+	for (int i = 0; i < 6; i++)
+	{
+		const GLfloat x = (planes[i].X >= 0.0f) ? boxMax.X : boxMin.X;
+		const GLfloat y = (planes[i].Y >= 0.0f) ? boxMax.Y : boxMin.Y;
+		const GLfloat z = (planes[i].Z >= 0.0f) ? boxMax.Z : boxMin.Z;
+		if (planes[i].X * x + planes[i].Y * y + planes[i].Z * z + planes[i].alpha < 0.0f)
+			return false;
+	}
+	return true;
+}
+
+/**
+ * Number of pixels on the screen for a length of 1 (in the coordinates of the modelview)
+ * at the point of the box nearest to the eye, the same everywhere with an orthographic
+ * projection. Return a negative value if the eye is in the box.
+ */
+GLfloat TFrustum::PixelScale(const GLfloat *modelview, const GLfloat *projection, const GLint *viewport,
+		const TVector3D &boxMin, const TVector3D &boxMax)
+{
+	const GLfloat *mv = modelview;
+
+	// Position of the eye in local coordinates : -inverse(A) * t
+	const double a = mv[0], b = mv[4], c = mv[8];
+	const double d = mv[1], e = mv[5], f = mv[9];
+	const double g = mv[2], h = mv[6], i = mv[10];
+	const double det = a * (e * i - f * h) - b * (d * i - f * g) + c * (d * h - e * g);
+	TVector3D eye;
+	if (fabs(det) > Epsilon)
+	{
+		const double tx = mv[12], ty = mv[13], tz = mv[14];
+		eye.X = -((e * i - f * h) * tx - (b * i - c * h) * ty + (b * f - c * e) * tz) / det;
+		eye.Y = -(-(d * i - f * g) * tx + (a * i - c * g) * ty - (a * f - c * d) * tz) / det;
+		eye.Z = -((d * h - e * g) * tx - (a * h - b * g) * ty + (a * e - b * d) * tz) / det;
+	}
+
+	// Pixels by eye unit at distance 1 (perspective) or everywhere (orthographic)
+	const GLfloat K = 0.5f * viewport[3] * projection[5];
+	if (fabs(projection[15]) > Epsilon)
+		return K * cbrt(fabs(det));
+
+	// Distance from the eye to the box
+	const GLfloat dx = std::max(std::max(boxMin.X - eye.X, eye.X - boxMax.X), 0.0f);
+	const GLfloat dy = std::max(std::max(boxMin.Y - eye.Y, eye.Y - boxMax.Y), 0.0f);
+	const GLfloat dz = std::max(std::max(boxMin.Z - eye.Z, eye.Z - boxMax.Z), 0.0f);
+	const GLfloat dist = sqrtf(dx * dx + dy * dy + dz * dz);
+	return (dist > Epsilon) ? K / dist : -1.0f;
+}
+
+// ********************************************************************************
+// End of file
+// ********************************************************************************
@@ -0,0 +1,46 @@
+#ifndef _FRUSTUM_H
+#define _FRUSTUM_H
+
+#include "Vector3D.h"
+#include "Vector4D.h"
+
+namespace GLScene
+{
+
+/**
+ * TFrustum class
+ * The 6 planes (left, right, bottom, top, near, far) of the view volume.
+ * The planes are extracted from the matrix projection * modelview, so when the
+ * modelview contains the transformation of an object, the planes are expressed
+ * in the local coordinates of this object.
+ * A plane (a, b, c, d) keep the points where a.x + b.y + c.z + d >= 0
+ */
+class TFrustum
+{
+	public:
+		TFrustum();
+		virtual ~TFrustum();
+
+		void Extract(void);
+		void Extract(const GLfloat *modelview, const GLfloat *projection);
+
+		bool PointVisible(const TVector3D &point) const;
+		bool SphereVisible(const TVector3D &center, GLfloat radius) const;
+		bool BoxVisible(const TVector3D &boxMin, const TVector3D &boxMax) const;
+
+		static GLfloat PixelScale(const GLfloat *modelview, const GLfloat *projection, const GLint *viewport,
+				const TVector3D &boxMin, const TVector3D &boxMax);
+
+		inline const TVector4D& GetPlane(int index) const
+		{
+			return planes[index];
+		}
+
+	private:
+		TVector4D planes[6];
+};
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _FRUSTUM_H
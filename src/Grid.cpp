@@ -111,6 +111,18 @@ void TGrid::DoDisplay(TDisplayMode mode)
 	}
 }
 
+bool TGrid::GetBounds(TVector3D &boxMin, TVector3D &boxMax)
+{
+	boxMin = TVector3D();
+	boxMax = size;
+	if (Centered)
+	{
+		boxMin -= TVector3D(CenterX, CenterY, CenterZ);
+		boxMax -= TVector3D(CenterX, CenterY, CenterZ);
+	}
+	return true;
+}
+
 // ********************************************************************************
 // End of file
 // ********************************************************************************
@@ -16,6 +16,8 @@ class TGrid: public TObject3D
 		TGrid(TVector3D _size, bool centered = false);
 		virtual ~TGrid();
 
+		virtual bool GetBounds(TVector3D &boxMin, TVector3D &boxMax);
+
 		void ShowGridX(bool show)
 		{
 			gridX = show;
@@ -0,0 +1,324 @@
+#include "HeightPyramid.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <limits>
+
+THeightPyramid::THeightPyramid()
+{
+	sizeX = sizeY = 0;
+	cellsX = cellsY = 0;
+	rebuild = true;
+	dirtyBegin = dirtyEnd = 0;
+	grid = NULL;
+}
+
+/**
+ * All the grid changed
+ */
+void THeightPyramid::Invalidate(void)
+{
+	rebuild = true;
+}
+
+/**
+ * count rows of points changed from the row first
+ */
+void THeightPyramid::InvalidateRows(GLuint first, GLuint count)
+{
+	if (rebuild || (count == 0) || (cellsY == 0))
+		return;
+
+	// The cells of the previous row use the first row
+	const GLuint begin = (first > 0) ? first - 1 : 0;
+	const GLuint end = std::min(first + count, cellsY);
+	if (begin >= end)
+		return;
+
+	if (dirtyBegin >= dirtyEnd)
+	{
+		dirtyBegin = begin;
+		dirtyEnd = end;
+	}
+	else
+	{
+		dirtyBegin = std::min(dirtyBegin, begin);
+		dirtyEnd = std::max(dirtyEnd, end);
+	}
+}
+
+/**
+ * Allocate the levels if needed and update the rows that changed
+ */
+void THeightPyramid::Build(const TVector3D *vertex, GLuint dimX, GLuint dimY)
+{
+	grid = vertex;
+	if (rebuild)
+	{
+		if ((dimX != sizeX) || (dimY != sizeY))
+		{
+			sizeX = dimX;
+			sizeY = dimY;
+			cellsX = sizeX - 1;
+			cellsY = sizeY - 1;
+
+			levelX.assign(1, cellsX);
+			levelY.assign(1, cellsY);
+			levels.clear();
+			while ((levelX.back() > 1) || (levelY.back() > 1))
+			{
+				levelX.push_back((levelX.back() + 1) / 2);
+				levelY.push_back((levelY.back() + 1) / 2);
+				levels.push_back(std::vector<GLfloat>(2 * (size_t) levelX.back() * levelY.back()));
+			}
+		}
+
+		columnX.resize(sizeX);
+		rowY.resize(sizeY);
+		for (GLuint i = 0; i < sizeX; i++)
+			columnX[i] = grid[i].X;
+		for (GLuint j = 0; j < sizeY; j++)
+			rowY[j] = grid[(size_t) j * sizeX].Y;
+
+		dirtyBegin = 0;
+		dirtyEnd = cellsY;
+		rebuild = false;
+	}
+
+	if (dirtyBegin >= dirtyEnd)
+		return;
+
+	for (GLuint level = 1; level < levelX.size(); level++)
+		BuildRows(level, dirtyBegin >> level, ((dirtyEnd - 1) >> level) + 1);
+	dirtyBegin = dirtyEnd = 0;
+}
+
+/**
+ * Min and max of the blocks of the rows [rowBegin, rowEnd[ of a level.
+ * The level 1 reads the grid, the other levels the previous level.
+ */
+void THeightPyramid::BuildRows(GLuint level, GLuint rowBegin, GLuint rowEnd)
+{
+	const GLuint blocksX = levelX[level];
+	GLfloat *range = levels[level - 1].data();
+
+	ParallelFor(rowBegin, rowEnd, [this, level, blocksX, range](size_t begin, size_t end)
+	{
+		GLfloat zMin, zMax, childMin, childMax;
+		for (GLuint bj = begin; bj < end; bj++)
+		{
+			for (GLuint bi = 0; bi < blocksX; bi++)
+			{
+				if (level == 1)
+				{
+					// The points of the 2 x 2 cells
+					const GLuint i1 = std::min(2 * bi + 2, cellsX);
+					const GLuint j1 = std::min(2 * bj + 2, cellsY);
+					zMin = zMax = grid[(size_t) 2 * bj * sizeX + 2 * bi].Z;
+					for (GLuint j = 2 * bj; j <= j1; j++)
+						for (GLuint i = 2 * bi; i <= i1; i++)
+						{
+							const GLfloat z = grid[(size_t) j * sizeX + i].Z;
+							zMin = std::min(zMin, z);
+							zMax = std::max(zMax, z);
+						}
+				}
+				else
+				{
+					BlockRange(level - 1, 2 * bi, 2 * bj, zMin, zMax);
+					for (GLuint b = 0; b < 2; b++)
+						for (GLuint a = 0; a < 2; a++)
+							if ((2 * bi + a < levelX[level - 1]) && (2 * bj + b < levelY[level - 1]))
+							{
+								BlockRange(level - 1, 2 * bi + a, 2 * bj + b, childMin, childMax);
+								zMin = std::min(zMin, childMin);
+								zMax = std::max(zMax, childMax);
+							}
+				}
+				const size_t k = 2 * ((size_t) bj * blocksX + bi);
+				range[k] = zMin;
+				range[k + 1] = zMax;
+			}
+		}
+	}, (1 << 14) / blocksX + 1);
+}
+
+/**
+ * Range of the heights of a block, the level 0 is a cell of the grid
+ */
+void THeightPyramid::BlockRange(GLuint level, GLuint i, GLuint j, GLfloat &zMin, GLfloat &zMax) const
+{
+	if (level == 0)
+	{
+		const size_t k = (size_t) j * sizeX + i;
+		zMin = std::min(std::min(grid[k].Z, grid[k + 1].Z), std::min(grid[k + sizeX].Z, grid[k + sizeX + 1].Z));
+		zMax = std::max(std::max(grid[k].Z, grid[k + 1].Z), std::max(grid[k + sizeX].Z, grid[k + sizeX + 1].Z));
+		return;
+	}
+
+	const size_t k = 2 * ((size_t) j * levelX[level] + i);
+	zMin = levels[level - 1][k];
+	zMax = levels[level - 1][k + 1];
+}
+
+/**
+ * Distance where the ray enters the bounding box of a block (slabs method)
+ */
+bool THeightPyramid::BoxEnter(GLuint level, GLuint i, GLuint j, const double *origin, const double *direction,
+		double &tEnter) const
+{
+	const GLuint i0 = i << level, i1 = std::min((i + 1) << level, cellsX);
+	const GLuint j0 = j << level, j1 = std::min((j + 1) << level, cellsY);
+	GLfloat zMin, zMax;
+	BlockRange(level, i, j, zMin, zMax);
+
+	const double low[3] = {std::min(columnX[i0], columnX[i1]), std::min(rowY[j0], rowY[j1]), zMin};
+	const double high[3] = {std::max(columnX[i0], columnX[i1]), std::max(rowY[j0], rowY[j1]), zMax};
+
+	double t0 = 0.0, t1 = std::numeric_limits<double>::max();
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (fabs(direction[axis]) < Epsilon)
+		{
+			if ((origin[axis] < low[axis]) || (origin[axis] > high[axis]))
+				return false;
+			continue;
+		}
+
+		double ta = (low[axis] - origin[axis]) / direction[axis];
+		double tb = (high[axis] - origin[axis]) / direction[axis];
+		if (ta > tb)
+			std::swap(ta, tb);
+		t0 = std::max(t0, ta);
+		t1 = std::min(t1, tb);
+		if (t0 > t1)
+			return false;
+	}
+	tEnter = t0;
+	return true;
+}
+
+/**
+ * Intersection with the two triangles of the cell (same triangles as the strips of
+ * TSurface : (V01, V00, V11) and (V00, V10, V11)), Moller-Trumbore
+ */
+bool THeightPyramid::CellIntersect(GLuint i, GLuint j, const double *origin, const double *direction, double &t) const
+{
+	const size_t k = (size_t) j * sizeX + i;
+	const TVector3D *corner[4] = {&grid[k], &grid[k + 1], &grid[k + sizeX], &grid[k + sizeX + 1]};
+	const int triangle[2][3] = {{2, 0, 3}, {0, 1, 3}};
+	bool found = false;
+
+	for (int n = 0; n < 2; n++)
+	{
+		const TVector3D &a = *corner[triangle[n][0]];
+		const TVector3D &b = *corner[triangle[n][1]];
+		const TVector3D &c = *corner[triangle[n][2]];
+		const double e1[3] = {b.X - a.X, b.Y - a.Y, b.Z - a.Z};
+		const double e2[3] = {c.X - a.X, c.Y - a.Y, c.Z - a.Z};
+		const double p[3] = {direction[1] * e2[2] - direction[2] * e2[1],
+				direction[2] * e2[0] - direction[0] * e2[2], direction[0] * e2[1] - direction[1] * e2[0]};
+		const double det = e1[0] * p[0] + e1[1] * p[1] + e1[2] * p[2];
+		if (fabs(det) < 1e-15)
+			continue;
+
+		const double s[3] = {origin[0] - a.X, origin[1] - a.Y, origin[2] - a.Z};
+		const double u = (s[0] * p[0] + s[1] * p[1] + s[2] * p[2]) / det;
+		if ((u < 0.0) || (u > 1.0))
+			continue;
+		const double q[3] = {s[1] * e1[2] - s[2] * e1[1], s[2] * e1[0] - s[0] * e1[2], s[0] * e1[1] - s[1] * e1[0]};
+		const double v = (direction[0] * q[0] + direction[1] * q[1] + direction[2] * q[2]) / det;
+		if ((v < 0.0) || (u + v > 1.0))
+			continue;
+		const double tt = (e2[0] * q[0] + e2[1] * q[1] + e2[2] * q[2]) / det;
+		if ((tt >= 0.0) && (!found || (tt < t)))
+		{
+			t = tt;
+			found = true;
+		}
+	}
+	return found;
+}
+
+/**
+ * First intersection of the ray (origin, direction) with the grid dimX x dimY.
+ * The ray and the result are in the coordinates of the grid.
+ */
+bool THeightPyramid::Intersect(const TVector3D *vertex, GLuint dimX, GLuint dimY,
+		const TVector3D &origin, const TVector3D &direction, TSurfaceHit &hit)
+{
+	if ((vertex == NULL) || (dimX < 2) || (dimY < 2))
+		return false;
+	const double length = direction.Length();
+	if (length < Epsilon)
+		return false;
+
+	Build(vertex, dimX, dimY);
+
+	const double o[3] = {origin.X, origin.Y, origin.Z};
+	const double d[3] = {direction.X / length, direction.Y / length, direction.Z / length};
+
+	// The blocks to visit, the nearest on the top
+	typedef struct
+	{
+		GLuint level, i, j;
+		double t;
+	} TBlock;
+	std::vector<TBlock> stack;
+	stack.reserve(4 * levelX.size());
+
+	double t;
+	const GLuint top = levelX.size() - 1;
+	if (BoxEnter(top, 0, 0, o, d, t))
+		stack.push_back({top, 0, 0, t});
+
+	TBlock children[4];
+	while (!stack.empty())
+	{
+		const TBlock block = stack.back();
+		stack.pop_back();
+
+		if (block.level == 0)
+		{
+			if (!CellIntersect(block.i, block.j, o, d, t))
+				continue;
+
+			hit.cellX = block.i;
+			hit.cellY = block.j;
+			hit.distance = t;
+			hit.point = TVector3D(o[0] + t * d[0], o[1] + t * d[1], o[2] + t * d[2]);
+
+			// Nearest corner of the cell in the plane
+			hit.nearestX = (fabs(hit.point.X - columnX[block.i]) <= fabs(hit.point.X - columnX[block.i + 1])) ? block.i : block.i + 1;
+			hit.nearestY = (fabs(hit.point.Y - rowY[block.j]) <= fabs(hit.point.Y - rowY[block.j + 1])) ? block.j : block.j + 1;
+			return true;
+		}
+
+		int count = 0;
+		const GLuint level = block.level - 1;
+		for (GLuint b = 0; b < 2; b++)
+			for (GLuint a = 0; a < 2; a++)
+			{
+				const GLuint i = 2 * block.i + a;
+				const GLuint j = 2 * block.j + b;
+				if ((i < levelX[level]) && (j < levelY[level]) && BoxEnter(level, i, j, o, d, t))
+					children[count++] = {level, i, j, t};
+			}
+
+		// The farthest first in the stack (insertion sort of at most 4 children)
+		for (int c = 1; c < count; c++)
+		{
+			const TBlock child = children[c];
+			int k = c;
+			for (; (k > 0) && (children[k - 1].t < child.t); k--)
+				children[k] = children[k - 1];
+			children[k] = child;
+		}
+		for (int c = 0; c < count; c++)
+			stack.push_back(children[c]);
+	}
+	return false;
+}
+
+// ********************************************************************************
+// End of file
+// ********************************************************************************
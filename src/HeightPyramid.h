@@ -0,0 +1,65 @@
+#ifndef _HEIGHT_PYRAMID_H
+#define _HEIGHT_PYRAMID_H
+
+#include "Object3D.h"
+#include <vector>
+
+namespace GLScene
+{
+
+/**
+ * Result of the intersection of a ray with a surface
+ */
+typedef struct TSurfaceHit
+{
+	public:
+		GLuint cellX, cellY;        // Cell of the grid that contains the point
+		GLuint nearestX, nearestY;  // Nearest point of the grid
+		TVector3D point;            // Intersection in the coordinates of the grid
+		GLfloat distance;           // Distance from the origin of the ray
+} TSurfaceHit;
+
+/**
+ * THeightPyramid class
+ * Min/max pyramid of the heights of a grid dimX x dimY for the intersection of a ray
+ * with the grid. The level k (k >= 1) keeps the range of the heights of the blocks of
+ * 2^k x 2^k cells, the cells are read from the grid. A ray only visits the blocks whose
+ * bounding box it crosses, nearest first, so a query is logarithmic in the size of the grid.
+ * The points (x, y) of the grid must be rectilinear (the X of a column and the Y of a row
+ * are constant) as the grids of TSurface.
+ * The pyramid is built at the first query after Invalidate, InvalidateRows only rebuilds
+ * the blocks of these rows.
+ */
+class THeightPyramid
+{
+	public:
+		THeightPyramid();
+
+		void Invalidate(void);
+		void InvalidateRows(GLuint first, GLuint count);
+
+		bool Intersect(const TVector3D *vertex, GLuint dimX, GLuint dimY,
+				const TVector3D &origin, const TVector3D &direction, TSurfaceHit &hit);
+
+	private:
+		GLuint sizeX, sizeY;    // Points of the grid
+		GLuint cellsX, cellsY;  // Cells of the grid
+		std::vector<GLfloat> columnX, rowY;
+		std::vector<GLuint> levelX, levelY;  // Blocks of each level
+		std::vector<std::vector<GLfloat>> levels;  // Min and max of each block, levels[k - 1] is the level k
+		bool rebuild;
+		GLuint dirtyBegin, dirtyEnd;  // Rows of cells to update [dirtyBegin, dirtyEnd[
+		const TVector3D *grid;
+
+		void Build(const TVector3D *vertex, GLuint dimX, GLuint dimY);
+		void BuildRows(GLuint level, GLuint rowBegin, GLuint rowEnd);
+		void BlockRange(GLuint level, GLuint i, GLuint j, GLfloat &zMin, GLfloat &zMax) const;
+		bool BoxEnter(GLuint level, GLuint i, GLuint j, const double *origin, const double *direction,
+				double &tEnter) const;
+		bool CellIntersect(GLuint i, GLuint j, const double *origin, const double *direction, double &t) const;
+};
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _HEIGHT_PYRAMID_H
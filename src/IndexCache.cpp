@@ -0,0 +1,227 @@
+#include "IndexCache.h"
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <utility>
+
+// Shared grid indices by dimensions (dimX, dimY)
+typedef std::map<std::pair<GLuint, GLuint>, TGridIndices*> TGridIndicesMap;
+static TGridIndicesMap gridCache;
+
+#ifdef USE_VBO
+/**
+ * Primitive restart is core since OpenGL 3.1
+ */
+static bool PrimitiveRestartSupported(void)
+{
+	static int supported = -1;
+
+	if (supported < 0)
+	{
+		int major = 0, minor = 0;
+		const char *version = (const char*) glGetString(GL_VERSION);
+		if (version != NULL)
+			sscanf(version, "%d.%d", &major, &minor);
+		supported = ((major > 3) || ((major == 3) && (minor >= 1))) ? 1 : 0;
+#if defined(_WIN32) && !defined(USE_GLEW)
+		if (glPrimitiveRestartIndex == NULL)
+			supported = 0;
+#endif
+	}
+	return (supported == 1);
+}
+#endif
+
+/**
+ * Compute the strips for a grid dimX x dimY, T is GLushort or GLuint
+ *
+ * V(j+1)*dimX  V(j+1)*dimX+1  ....
+ *    |       /     |
+ *  VjdimX     VjdimX+1        ....
+ *  Strip of the row j is : V(j+1)*dimX, VjdimX, V(j+1)*dimX+1, VjdimX+1, ...
+ *  Then the restart index (or the two degenerated indices) before the next row.
+ */
+template<typename T>
+static void ComputeStrips(TGridIndices *grid)
+{
+	const GLuint dimX = grid->dimX;
+	T *ind = new T[grid->count];
+
+	GLuint k = 0;
+	for (GLuint j = 0; j < grid->dimY - 1; j++)
+	{
+		if (j > 0)
+		{
+			if (grid->restart != 0)
+				ind[k++] = (T) grid->restart;
+			else
+			{
+				// Repeat the last index and the first of the next row
+				ind[k] = ind[k - 1];
+				k++;
+				ind[k++] = (T) ((j + 1) * dimX);
+			}
+		}
+		for (GLuint i = 0; i < dimX; i++)
+		{
+			ind[k++] = (T) ((j + 1) * dimX + i);
+			ind[k++] = (T) (j * dimX + i);
+		}
+	}
+	grid->data = ind;
+}
+
+static void FreeGridData(TGridIndices *grid)
+{
+	if (grid->data == NULL)
+		return;
+	if (grid->type == GL_UNSIGNED_SHORT)
+		delete[] (GLushort*) grid->data;
+	else
+		delete[] (GLuint*) grid->data;
+	grid->data = NULL;
+}
+
+/**
+ * Return the indices of a grid dimX x dimY. The indices are created the first time,
+ * then shared. Each call must be balanced with ReleaseGridIndices.
+ * With VBO, an OpenGL context must be current.
+ */
+TGridIndices* GLScene::AcquireGridIndices(GLuint dimX, GLuint dimY)
+{
+	TGridIndicesMap::iterator it = gridCache.find(std::make_pair(dimX, dimY));
+	if (it != gridCache.end())
+	{
+		it->second->refCount++;
+		return it->second;
+	}
+
+	TGridIndices *grid = new TGridIndices;
+	grid->dimX = dimX;
+	grid->dimY = dimY;
+	grid->refCount = 1;
+	grid->data = NULL;
+	grid->count = 0;
+	grid->restart = 0;
+
+	const GLuint size = dimX * dimY;
+	grid->type = (size < 0xFFFF) ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+
+#ifdef USE_VBO
+	grid->iboId = 0;
+	grid->meshId = 0;
+	initOGL();
+	if (PrimitiveRestartSupported())
+		grid->restart = (grid->type == GL_UNSIGNED_SHORT) ? 0xFFFF : 0xFFFFFFFF;
+#endif
+
+	if ((dimX > 1) && (dimY > 1))
+	{
+		// 2 indices by vertex, dimY - 2 joins of 1 (restart) or 2 (degenerated) indices
+		grid->count = 2 * dimX * (dimY - 1) + (dimY - 2) * ((grid->restart != 0) ? 1 : 2);
+		if (grid->type == GL_UNSIGNED_SHORT)
+			ComputeStrips<GLushort>(grid);
+		else
+			ComputeStrips<GLuint>(grid);
+
+#ifdef USE_VBO
+		grid->iboId = createVBO(grid->data, grid->DataSize(), GL_ELEMENT_ARRAY_BUFFER);
+		if (grid->iboId == 0)
+			std::cout << "[WARNING] VBO array not created for grid indices." << std::endl;
+
+		// Now we can delete indices array
+		FreeGridData(grid);
+#endif
+	}
+
+	gridCache[std::make_pair(dimX, dimY)] = grid;
+	return grid;
+}
+
+/**
+ * Release the indices. They are freed when no more object use them.
+ */
+void GLScene::ReleaseGridIndices(TGridIndices *grid)
+{
+	if (grid == NULL)
+		return;
+
+	if (--grid->refCount > 0)
+		return;
+
+	gridCache.erase(std::make_pair(grid->dimX, grid->dimY));
+	FreeGridData(grid);
+#ifdef USE_VBO
+	DeleteAndNullVBO(1, grid->iboId);
+	DeleteAndNullVBO(1, grid->meshId);
+#endif
+	delete grid;
+}
+
+/**
+ * Draw the strips of the grid. The vertex arrays (or VBO) must be set before.
+ */
+void GLScene::DrawGridIndices(const TGridIndices *grid)
+{
+	if ((grid == NULL) || (grid->count == 0))
+		return;
+
+#ifdef USE_VBO
+
+	if (grid->iboId == 0)
+		return;
+
+	if (grid->restart != 0)
+	{
+		glEnable(GL_PRIMITIVE_RESTART);
+		glPrimitiveRestartIndex(grid->restart);
+	}
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, grid->iboId);
+	glDrawElements(GL_TRIANGLE_STRIP, grid->count, grid->type, (GLvoid*) 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+	if (grid->restart != 0)
+		glDisable(GL_PRIMITIVE_RESTART);
+
+#else
+
+	glDrawElements(GL_TRIANGLE_STRIP, grid->count, grid->type, grid->data);
+
+#endif
+}
+
+#ifdef USE_VBO
+/**
+ * The VBO of the flat mesh of the grid: 2 floats (i, j) by vertex in the grid order.
+ * It is created on first use and shared like the indices, the vertex shader
+ * computes the positions (eg displacement of a height texture).
+ */
+GLuint GLScene::GridMeshBuffer(TGridIndices *grid)
+{
+	if (grid == NULL)
+		return 0;
+
+	if (grid->meshId == 0)
+	{
+		const GLuint size = grid->dimX * grid->dimY;
+		GLfloat *mesh = new GLfloat[2 * size];
+		GLuint k = 0;
+		for (GLuint j = 0; j < grid->dimY; j++)
+			for (GLuint i = 0; i < grid->dimX; i++)
+			{
+				mesh[k++] = i;
+				mesh[k++] = j;
+			}
+		grid->meshId = createVBO(mesh, 2 * size * sizeof(GLfloat));
+		if (grid->meshId == 0)
+			std::cout << "[WARNING] VBO array not created for grid mesh." << std::endl;
+		delete [] mesh;
+	}
+	return grid->meshId;
+}
+#endif
+
+// ********************************************************************************
+// End of file
+// ********************************************************************************
@@ -0,0 +1,52 @@
+#ifndef _INDEX_CACHE_H
+#define _INDEX_CACHE_H
+
+#include "Object3D.h"
+
+namespace GLScene
+{
+
+/**
+ * TGridIndices structure
+ * The index array of a regular grid of dimX x dimY vertices drawn as triangle strips.
+ * There is one strip by row of quads. With VBO the strips are joined with the
+ * primitive restart index, else with two degenerated indices.
+ * Indices are 16 bits (GL_UNSIGNED_SHORT) when the grid has less than 65535 vertices
+ * else 32 bits (GL_UNSIGNED_INT).
+ * An instance is shared between all the objects that use a grid with the same dimensions,
+ * so use AcquireGridIndices and ReleaseGridIndices, never create or delete it yourself.
+ * With VBO, the grid can also give a flat mesh (see GridMeshBuffer) shared by the same objects.
+ */
+typedef struct TGridIndices
+{
+	public:
+		GLuint dimX;
+		GLuint dimY;
+		GLenum type;       // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+		GLuint restart;    // Primitive restart index, 0 if not used
+		GLuint count;      // Number of indices
+		void *data;        // Indices array (NULL once uploaded in VBO)
+#ifdef USE_VBO
+		GLuint iboId;      // ID of VBO for index array
+		GLuint meshId;     // ID of VBO for the flat mesh (i, j), 0 if not used
+#endif
+		int refCount;
+
+		/// Size in byte of the index array
+		inline GLuint DataSize(void) const
+		{
+			return count * ((type == GL_UNSIGNED_SHORT) ? sizeof(GLushort) : sizeof(GLuint));
+		}
+} TGridIndices;
+
+TGridIndices* AcquireGridIndices(GLuint dimX, GLuint dimY);
+void ReleaseGridIndices(TGridIndices *grid);
+void DrawGridIndices(const TGridIndices *grid);
+#ifdef USE_VBO
+GLuint GridMeshBuffer(TGridIndices *grid);
+#endif
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _INDEX_CACHE_H
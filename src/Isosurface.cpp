@@ -0,0 +1,694 @@
+#include "Isosurface.h"
+#include "Parallel.h"
+#include "FileMapping.h"
+#include <algorithm>
+#include <cstring>
+
+// Max number of triangles of a cube
+#define ISO_MAX_TRIANGLES	5
+// The corner of a triangle : the neighbour brick that owns the vertex and the index in this brick
+#define ISO_OWNER_SHIFT	29
+#define ISO_INDEX_MASK	((1u << ISO_OWNER_SHIFT) - 1)
+// Place of the vertex of an edge in its brick (the last bricks own ISO_BRICK + 1 points)
+#define ISO_KEY(x, y, z, axis)	((((z) * (ISO_BRICK + 1) + (y)) * (ISO_BRICK + 1) + (x)) * 3 + (axis))
+
+/**
+ * The corner c of a cube is at (c & 1, (c >> 1) & 1, (c >> 2) & 1), the edge 4 * axis + k
+ * joins the corners cubeEdges[e] and starts from the first one.
+ * The corners of the faces are counterclockwise seen from outside the cube.
+ */
+static const int cubeEdges[12][2] = {{0, 1}, {2, 3}, {4, 5}, {6, 7}, {0, 2}, {1, 3}, {4, 6}, {5, 7},
+		{0, 4}, {1, 5}, {2, 6}, {3, 7}};
+static const int cubeFaces[6][4] = {{0, 4, 6, 2}, {1, 3, 7, 5}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 2, 3, 1}, {4, 5, 7, 6}};
+
+typedef struct TCubeCase
+{
+	public:
+		int count;  // Number of triangles
+		signed char edges[3 * ISO_MAX_TRIANGLES];
+} TCubeCase;
+
+static int CubeEdge(int a, int b)
+{
+	for (int e = 0; e < 12; e++)
+		if (((cubeEdges[e][0] == a) && (cubeEdges[e][1] == b)) || ((cubeEdges[e][0] == b) && (cubeEdges[e][1] == a)))
+			return e;
+	return -1;
+}
+
+/**
+ * The triangles of the 256 cases of marching cubes (bit c of the case set when the value
+ * of the corner c is >= iso value).
+ * On each face the iso line goes from the edge where the corners go above -> below to the
+ * edge where they came below -> above, so the corners above are on its left and an ambiguous
+ * face cuts its two corners above apart. Each cut edge is on two faces, the lines of the
+ * faces make closed polygons cut in triangles.
+ */
+static TCubeCase *BuildCubeCases(void)
+{
+	static TCubeCase cases[256];
+
+	// The faces of each edge
+	int faces[12] = {0};
+	for (int f = 0; f < 6; f++)
+		for (int k = 0; k < 4; k++)
+			faces[CubeEdge(cubeFaces[f][k], cubeFaces[f][(k + 1) & 3])] |= 1 << f;
+
+	for (int c = 0; c < 256; c++)
+	{
+		int next[12];
+		for (int e = 0; e < 12; e++)
+			next[e] = -1;
+
+		for (int f = 0; f < 6; f++)
+		{
+			const int *corner = cubeFaces[f];
+			for (int k = 0; k < 4; k++)
+			{
+				const int a = corner[k], b = corner[(k + 1) & 3];
+				if (!((c >> a) & 1) || ((c >> b) & 1))
+					continue;
+				// Beginning of the corners above that end with a
+				int m = k;
+				while ((c >> corner[(m + 3) & 3]) & 1)
+					m = (m + 3) & 3;
+				next[CubeEdge(a, b)] = CubeEdge(corner[(m + 3) & 3], corner[m]);
+			}
+		}
+
+		TCubeCase &cube = cases[c];
+		cube.count = 0;
+		bool used[12] = {false};
+		int polygon[12];
+		for (int e = 0; e < 12; e++)
+		{
+			if ((next[e] < 0) || used[e])
+				continue;
+			int length = 0;
+			for (int n = e; !used[n]; n = next[n])
+			{
+				used[n] = true;
+				polygon[length++] = n;
+			}
+			// Fan from the first point that makes no triangle in a face of the cube (the
+			// triangle would also be made by the next cube)
+			int first = 0;
+			for (int start = 0; start < length; start++)
+			{
+				bool inFace = false;
+				for (int k = 1; k < length - 1; k++)
+					inFace |= ((faces[polygon[start]] & faces[polygon[(start + k) % length]] &
+							faces[polygon[(start + k + 1) % length]]) != 0);
+				if (!inFace)
+				{
+					first = start;
+					break;
+				}
+			}
+			for (int k = 1; k < length - 1; k++)
+			{
+				signed char *edge = &cube.edges[3 * cube.count++];
+				edge[0] = polygon[first];
+				edge[1] = polygon[(first + k) % length];
+				edge[2] = polygon[(first + k + 1) % length];
+			}
+		}
+	}
+	return cases;
+}
+
+static const TCubeCase *cubeCases = BuildCubeCases();
+
+TIsosurface::TIsosurface(GLuint dimX, GLuint dimY, GLuint dimZ, const TVector3D &pos) : TObject3D(pos)
+{
+	ObjectType = otIsosurface;
+
+	if ((dimX < 2) || (dimY < 2) || (dimZ < 2))
+	{
+		std::cout << "[WARNING] Isosurface needs at least 2 points on each axis." << std::endl;
+		dimX = std::max(dimX, 2u);
+		dimY = std::max(dimY, 2u);
+		dimZ = std::max(dimZ, 2u);
+	}
+	sizeX = dimX;
+	sizeY = dimY;
+	sizeZ = dimZ;
+	volume.assign((size_t) sizeX * sizeY * sizeZ, 0.0f);
+
+	isoValue = 0.0f;
+	vertexCount = 0;
+	indiceLength = 0;
+	useNormal = true;
+
+	bricksX = (sizeX - 2) / ISO_BRICK + 1;
+	bricksY = (sizeY - 2) / ISO_BRICK + 1;
+	bricksZ = (sizeZ - 2) / ISO_BRICK + 1;
+	bricks.resize((size_t) bricksX * bricksY * bricksZ);
+	SetBox(0.0, sizeX - 1, 0.0, sizeY - 1, 0.0, sizeZ - 1);
+	VolumeChanged();
+
+	material.SetColor(mfFront, msAmbient, {0.1, 0.1, 0.8, 1.0});
+	material.SetColor(mfFront, msDiffuse, GLColor_blue);
+
+	material.SetColor(mfBack, msAmbient, {0.2, 0.2, 0.2, 1.0});
+	material.SetColor(mfBack, msDiffuse, {0.8, 0.8, 0.8, 1.0});
+
+	DoPosition = true;
+}
+
+TIsosurface::~TIsosurface()
+{
+	FreeMesh();
+}
+
+/**
+ * Compute the values of the volume with the function in the box
+ */
+void TIsosurface::InitializeVolume(double xMin, double xMax, double yMin, double yMax, double zMin, double zMax)
+{
+	if (Function == NULL)
+	{
+		std::cout << "[WARNING] Isosurface function not defined." << std::endl;
+		return;
+	}
+
+	SetBox(xMin, xMax, yMin, yMax, zMin, zMax);
+	GLfloat *value = volume.data();
+	ParallelFor(0, sizeZ, [this, value](size_t begin, size_t end)
+	{
+		for (size_t z = begin; z < end; z++)
+		{
+			GLfloat *dest = value + z * sizeY * sizeX;
+			const double pz = origin[2] + z * step[2];
+			for (GLuint y = 0; y < sizeY; y++)
+			{
+				const double py = origin[1] + y * step[1];
+				for (GLuint x = 0; x < sizeX; x++)
+					*dest++ = Function(origin[0] + x * step[0], py, pz);
+			}
+		}
+	});
+	VolumeChanged();
+}
+
+/**
+ * The coordinates of the first and the last points of the volume on each axis
+ */
+void TIsosurface::SetBox(double xMin, double xMax, double yMin, double yMax, double zMin, double zMax)
+{
+	origin[0] = xMin;
+	origin[1] = yMin;
+	origin[2] = zMin;
+	step[0] = (xMax - xMin) / (sizeX - 1);
+	step[1] = (yMax - yMin) / (sizeY - 1);
+	step[2] = (zMax - zMin) / (sizeZ - 1);
+
+	for (TIsoBrick &brick : bricks)
+		brick.dirtyVertices = brick.dirtyTriangles = true;
+	meshChanged = true;
+}
+
+/**
+ * Replace all the values, dimX * dimY * dimZ values (x first, then y, then z)
+ */
+void TIsosurface::SetVolume(const GLfloat *values)
+{
+	if (values == NULL)
+		return;
+	memcpy(volume.data(), values, volume.size() * sizeof(GLfloat));
+	VolumeChanged();
+}
+
+/**
+ * Load the values from a raw file of dimX * dimY * dimZ floats (x first, then y, then z)
+ */
+bool TIsosurface::LoadVolumeBinary(const char *filename)
+{
+	char message[256];
+	TMappedFile file;
+
+	loadError.clear();
+	if (!file.Open(filename))
+	{
+		loadError = std::string("Can not open the file ") + filename;
+		return false;
+	}
+
+	const size_t expected = volume.size() * sizeof(float);
+	if (file.Size() < expected)
+	{
+		snprintf(message, sizeof(message), "%s: %lu bytes, expected %lu bytes for %u*%u*%u points", filename,
+				(unsigned long) file.Size(), (unsigned long) expected, sizeX, sizeY, sizeZ);
+		loadError = message;
+		return false;
+	}
+
+	SetVolume((const float*) file.Data());
+	return true;
+}
+
+/**
+ * Replace the values of the block of countX * countY * countZ points from (x, y, z),
+ * values are x first, then y, then z.
+ * Only the bricks around the block are extracted again.
+ */
+void TIsosurface::SetBlock(GLuint x, GLuint y, GLuint z, GLuint countX, GLuint countY, GLuint countZ,
+		const GLfloat *values)
+{
+	if ((values == NULL) || (countX == 0) || (countY == 0) || (countZ == 0))
+		return;
+	if ((x + countX > sizeX) || (y + countY > sizeY) || (z + countZ > sizeZ))
+	{
+		std::cout << "[WARNING] Isosurface block outside of the volume." << std::endl;
+		return;
+	}
+
+	for (GLuint k = 0; k < countZ; k++)
+		for (GLuint j = 0; j < countY; j++)
+			memcpy(&volume[((size_t) (z + k) * sizeY + y + j) * sizeX + x],
+					&values[((size_t) k * countY + j) * countX], countX * sizeof(GLfloat));
+
+	// The range of a brick reads its points and the first points of the next bricks
+	const GLint low[3] = {(GLint) x, (GLint) y, (GLint) z};
+	const GLint high[3] = {(GLint) (x + countX - 1), (GLint) (y + countY - 1), (GLint) (z + countZ - 1)};
+	GLuint brickLow[3], brickHigh[3];
+	const GLuint size[3] = {sizeX, sizeY, sizeZ};
+	for (int axis = 0; axis < 3; axis++)
+	{
+		brickLow[axis] = std::max(low[axis] - 1, 0) / ISO_BRICK;
+		brickHigh[axis] = std::min((GLuint) high[axis], size[axis] - 2) / ISO_BRICK;
+	}
+	for (GLuint k = brickLow[2]; k <= brickHigh[2]; k++)
+		for (GLuint j = brickLow[1]; j <= brickHigh[1]; j++)
+			for (GLuint i = brickLow[0]; i <= brickHigh[0]; i++)
+				UpdateRange(((size_t) k * bricksY + j) * bricksX + i);
+
+	Minimum = bricks[0].valueMin;
+	Maximum = bricks[0].valueMax;
+	for (const TIsoBrick &brick : bricks)
+	{
+		Minimum = std::min(Minimum, (double) brick.valueMin);
+		Maximum = std::max(Maximum, (double) brick.valueMax);
+	}
+
+	// The vertices of the edges that read the values (with the gradients)
+	GLint vertexLow[3], vertexHigh[3];
+	for (int axis = 0; axis < 3; axis++)
+	{
+		vertexLow[axis] = low[axis] - 2;
+		vertexHigh[axis] = high[axis] + 1;
+	}
+	MarkBricks(vertexLow, vertexHigh);
+	meshChanged = true;
+}
+
+/**
+ * Only the bricks that have triangles before or after the change are extracted again
+ */
+void TIsosurface::SetIsoValue(GLfloat iso)
+{
+	if (iso == isoValue)
+		return;
+
+	isoValue = iso;
+	for (TIsoBrick &brick : bricks)
+	{
+		if (!brick.vertices.empty() || !brick.corners.empty() || ((brick.valueMin < iso) && (iso <= brick.valueMax)))
+			brick.dirtyVertices = brick.dirtyTriangles = true;
+	}
+	meshChanged = true;
+}
+
+void TIsosurface::SetNormal(bool use)
+{
+	useNormal = use;
+}
+
+void TIsosurface::SetVertexFormat(TVertexFormat format)
+{
+	TObject3D::SetVertexFormat(format);
+	meshChanged = true;
+}
+
+/**
+ * Derivative of the values along the axis (central difference, one side on the border)
+ */
+GLfloat TIsosurface::Gradient(GLuint x, GLuint y, GLuint z, int axis) const
+{
+	GLuint p[3] = {x, y, z};
+	const GLuint size[3] = {sizeX, sizeY, sizeZ};
+	GLuint lo = p[axis], hi = p[axis];
+	if (lo > 0)
+		lo--;
+	if (hi < size[axis] - 1)
+		hi++;
+
+	p[axis] = lo;
+	const GLfloat a = Value(p[0], p[1], p[2]);
+	p[axis] = hi;
+	const GLfloat b = Value(p[0], p[1], p[2]);
+	return (b - a) / ((hi - lo) * step[axis]);
+}
+
+/**
+ * All the values changed
+ */
+void TIsosurface::VolumeChanged(void)
+{
+	ParallelFor(0, bricks.size(), [this](size_t begin, size_t end)
+	{
+		for (size_t b = begin; b < end; b++)
+			UpdateRange(b);
+	});
+
+	Minimum = bricks[0].valueMin;
+	Maximum = bricks[0].valueMax;
+	for (TIsoBrick &brick : bricks)
+	{
+		Minimum = std::min(Minimum, (double) brick.valueMin);
+		Maximum = std::max(Maximum, (double) brick.valueMax);
+		brick.dirtyVertices = brick.dirtyTriangles = true;
+	}
+	meshChanged = true;
+}
+
+/**
+ * Range of the values of the points of the cells of the brick
+ */
+void TIsosurface::UpdateRange(GLuint brick)
+{
+	const GLuint bx = brick % bricksX, by = (brick / bricksX) % bricksY, bz = brick / (bricksX * bricksY);
+	const GLuint x0 = bx * ISO_BRICK, x1 = std::min(x0 + ISO_BRICK, sizeX - 1);
+	const GLuint y0 = by * ISO_BRICK, y1 = std::min(y0 + ISO_BRICK, sizeY - 1);
+	const GLuint z0 = bz * ISO_BRICK, z1 = std::min(z0 + ISO_BRICK, sizeZ - 1);
+
+	GLfloat vMin = Value(x0, y0, z0), vMax = vMin;
+	for (GLuint z = z0; z <= z1; z++)
+		for (GLuint y = y0; y <= y1; y++)
+		{
+			const GLfloat *value = &volume[((size_t) z * sizeY + y) * sizeX];
+			for (GLuint x = x0; x <= x1; x++)
+			{
+				vMin = std::min(vMin, value[x]);
+				vMax = std::max(vMax, value[x]);
+			}
+		}
+	bricks[brick].valueMin = vMin;
+	bricks[brick].valueMax = vMax;
+}
+
+/**
+ * Extract the vertices of the bricks that own the points [low, high] (clipped to the volume),
+ * and the triangles of these bricks and of the previous bricks that use their vertices
+ */
+void TIsosurface::MarkBricks(const GLint *low, const GLint *high)
+{
+	const GLint count[3] = {(GLint) bricksX, (GLint) bricksY, (GLint) bricksZ};
+	GLint first[3], last[3];
+	for (int axis = 0; axis < 3; axis++)
+	{
+		first[axis] = std::max(low[axis], 0) / ISO_BRICK;
+		last[axis] = std::min(std::max(high[axis], 0) / ISO_BRICK, count[axis] - 1);
+	}
+
+	for (GLint k = std::max(first[2] - 1, 0); k <= last[2]; k++)
+		for (GLint j = std::max(first[1] - 1, 0); j <= last[1]; j++)
+			for (GLint i = std::max(first[0] - 1, 0); i <= last[0]; i++)
+			{
+				TIsoBrick &brick = bricks[((size_t) k * bricksY + j) * bricksX + i];
+				brick.dirtyTriangles = true;
+				if ((i >= first[0]) && (j >= first[1]) && (k >= first[2]))
+					brick.dirtyVertices = true;
+			}
+}
+
+/**
+ * The vertices of the edges cut by the surface that start from the points of the brick
+ */
+void TIsosurface::ExtractVertices(GLuint brick)
+{
+	TIsoBrick &current = bricks[brick];
+	current.vertices.clear();
+	current.keys.clear();
+	if (!((current.valueMin < isoValue) && (isoValue <= current.valueMax)))
+		return;
+
+	const GLuint bx = brick % bricksX, by = (brick / bricksX) % bricksY, bz = brick / (bricksX * bricksY);
+	// The last bricks also own the last points of the volume
+	const GLuint x0 = bx * ISO_BRICK, x1 = (bx + 1 == bricksX) ? sizeX : x0 + ISO_BRICK;
+	const GLuint y0 = by * ISO_BRICK, y1 = (by + 1 == bricksY) ? sizeY : y0 + ISO_BRICK;
+	const GLuint z0 = bz * ISO_BRICK, z1 = (bz + 1 == bricksZ) ? sizeZ : z0 + ISO_BRICK;
+	const GLuint size[3] = {sizeX, sizeY, sizeZ};
+
+	TVertex vertex;
+	for (GLuint z = z0; z < z1; z++)
+		for (GLuint y = y0; y < y1; y++)
+			for (GLuint x = x0; x < x1; x++)
+			{
+				const GLuint p[3] = {x, y, z};
+				const GLfloat a = Value(x, y, z);
+				for (int axis = 0; axis < 3; axis++)
+				{
+					if (p[axis] + 1 >= size[axis])
+						continue;
+					const GLuint q[3] = {x + (axis == 0), y + (axis == 1), z + (axis == 2)};
+					const GLfloat b = Value(q[0], q[1], q[2]);
+					if ((a >= isoValue) == (b >= isoValue))
+						continue;
+
+					const GLfloat t = (isoValue - a) / (b - a);
+					GLfloat point[3], normal[3];
+					for (int n = 0; n < 3; n++)
+					{
+						point[n] = origin[n] + (p[n] + ((n == axis) ? t : 0.0f)) * step[n];
+						normal[n] = (1.0f - t) * Gradient(x, y, z, n) + t * Gradient(q[0], q[1], q[2], n);
+					}
+					TVector3D norm(normal[0], normal[1], normal[2]);
+					if (!norm.IsNull())
+						norm.Normalize();
+					vertex.SetVertice(point[0], point[1], point[2]);
+					vertex.SetNormal(norm.X, norm.Y, norm.Z);
+					current.vertices.push_back(vertex);
+					current.keys.push_back(ISO_KEY(x - x0, y - y0, z - z0, axis));
+				}
+			}
+}
+
+/**
+ * The triangles of the cells of the brick, the vertices of the bricks must be extracted
+ */
+void TIsosurface::ExtractTriangles(GLuint brick)
+{
+	TIsoBrick &current = bricks[brick];
+	current.corners.clear();
+	if (!((current.valueMin < isoValue) && (isoValue <= current.valueMax)))
+		return;
+
+	const GLuint bx = brick % bricksX, by = (brick / bricksX) % bricksY, bz = brick / (bricksX * bricksY);
+	const GLuint x0 = bx * ISO_BRICK, x1 = std::min(x0 + ISO_BRICK, sizeX - 1);
+	const GLuint y0 = by * ISO_BRICK, y1 = std::min(y0 + ISO_BRICK, sizeY - 1);
+	const GLuint z0 = bz * ISO_BRICK, z1 = std::min(z0 + ISO_BRICK, sizeZ - 1);
+
+	for (GLuint z = z0; z < z1; z++)
+		for (GLuint y = y0; y < y1; y++)
+			for (GLuint x = x0; x < x1; x++)
+			{
+				int index = 0;
+				for (int c = 0; c < 8; c++)
+					if (Value(x + (c & 1), y + ((c >> 1) & 1), z + ((c >> 2) & 1)) >= isoValue)
+						index |= 1 << c;
+				const TCubeCase &cube = cubeCases[index];
+				if (cube.count == 0)
+					continue;
+
+				uint32_t corner[12];
+				for (int e = 0; e < 12; e++)
+					corner[e] = 0xFFFFFFFF;
+				for (int k = 0; k < 3 * cube.count; k++)
+				{
+					const int e = cube.edges[k];
+					if (corner[e] == 0xFFFFFFFF)
+					{
+						// The point where the edge starts and the brick that owns it
+						const int c = cubeEdges[e][0];
+						GLuint lx = x - x0 + (c & 1), ly = y - y0 + ((c >> 1) & 1), lz = z - z0 + ((c >> 2) & 1);
+						uint32_t owner = 0;
+						if ((lx == ISO_BRICK) && (bx + 1 < bricksX))
+						{
+							lx = 0;
+							owner |= 1;
+						}
+						if ((ly == ISO_BRICK) && (by + 1 < bricksY))
+						{
+							ly = 0;
+							owner |= 2;
+						}
+						if ((lz == ISO_BRICK) && (bz + 1 < bricksZ))
+						{
+							lz = 0;
+							owner |= 4;
+						}
+						const TIsoBrick &ownerBrick = bricks[brick + (owner & 1) + ((owner >> 1) & 1) * bricksX +
+								((owner >> 2) & 1) * bricksX * bricksY];
+						const uint16_t key = ISO_KEY(lx, ly, lz, e >> 2);
+						const uint32_t place = std::lower_bound(ownerBrick.keys.begin(), ownerBrick.keys.end(), key) -
+								ownerBrick.keys.begin();
+						corner[e] = (owner << ISO_OWNER_SHIFT) | place;
+					}
+					current.corners.push_back(corner[e]);
+				}
+			}
+}
+
+/**
+ * Extract the bricks that changed, then merge the vertices and the triangles of all the bricks
+ */
+void TIsosurface::BuildMesh(void)
+{
+	FreeMesh();
+	meshChanged = false;
+
+	std::vector<GLuint> dirty;
+	for (GLuint b = 0; b < bricks.size(); b++)
+		if (bricks[b].dirtyVertices)
+			dirty.push_back(b);
+	ParallelFor(0, dirty.size(), [this, &dirty](size_t begin, size_t end)
+	{
+		for (size_t k = begin; k < end; k++)
+			ExtractVertices(dirty[k]);
+	});
+
+	dirty.clear();
+	for (GLuint b = 0; b < bricks.size(); b++)
+	{
+		if (bricks[b].dirtyTriangles)
+			dirty.push_back(b);
+		bricks[b].dirtyVertices = bricks[b].dirtyTriangles = false;
+	}
+	ParallelFor(0, dirty.size(), [this, &dirty](size_t begin, size_t end)
+	{
+		for (size_t k = begin; k < end; k++)
+			ExtractTriangles(dirty[k]);
+	});
+
+	// Place of the vertices and the triangles of each brick in the mesh
+	std::vector<size_t> vertexOffset(bricks.size() + 1), indiceOffset(bricks.size() + 1);
+	vertexOffset[0] = indiceOffset[0] = 0;
+	for (size_t b = 0; b < bricks.size(); b++)
+	{
+		vertexOffset[b + 1] = vertexOffset[b] + bricks[b].vertices.size();
+		indiceOffset[b + 1] = indiceOffset[b] + bricks[b].corners.size();
+	}
+	if ((indiceOffset.back() == 0) || (vertexOffset.back() > 0xFFFFFFFF) || (indiceOffset.back() > 0xFFFFFFFF))
+		return;
+
+	vertexCount = vertexOffset.back();
+	indiceLength = indiceOffset.back();
+	vertices = new TVertex[vertexCount];
+	indices = new GLuint[indiceLength];
+	ParallelFor(0, bricks.size(), [this, &vertexOffset, &indiceOffset](size_t begin, size_t end)
+	{
+		const size_t neighbour[8] = {0, 1, bricksX, bricksX + 1, (size_t) bricksX * bricksY, (size_t) bricksX * bricksY + 1,
+				(size_t) bricksX * bricksY + bricksX, (size_t) bricksX * bricksY + bricksX + 1};
+		for (size_t b = begin; b < end; b++)
+		{
+			const TIsoBrick &brick = bricks[b];
+			if (!brick.vertices.empty())
+				memcpy(&vertices[vertexOffset[b]], brick.vertices.data(), SIZE_VERTEX(brick.vertices.size()));
+			GLuint *indice = &indices[indiceOffset[b]];
+			for (const uint32_t corner : brick.corners)
+				*indice++ = vertexOffset[b + neighbour[corner >> ISO_OWNER_SHIFT]] + (corner & ISO_INDEX_MASK);
+		}
+	});
+
+#ifdef USE_VBO
+	initOGL();
+	vboId = createVertexVBO(vertices, vertexCount, vertexFormat);
+	iboId = createVBO(indices, SIZE_UINT(indiceLength), GL_ELEMENT_ARRAY_BUFFER);
+	if ((vboId == 0) || (iboId == 0))
+		std::cout << "[WARNING] VBO array not created for Isosurface." << std::endl;
+	else
+	{
+		DeleteAndNull(vertices);
+		DeleteAndNull(indices);
+	}
+#endif
+}
+
+void TIsosurface::FreeMesh(void)
+{
+	DeleteAndNull(vertices);
+	DeleteAndNull(indices);
+#ifdef USE_VBO
+	DeleteAndNullVBO(1, vboId);
+	DeleteAndNullVBO(1, iboId);
+#endif
+	vertexCount = 0;
+	indiceLength = 0;
+}
+
+void TIsosurface::DoDisplay(TDisplayMode mode __attribute__((unused)))
+{
+	if (meshChanged)
+		BuildMesh();
+	if (indiceLength == 0)
+		return;
+
+	glDisable(GL_CULL_FACE);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	if (useNormal)
+		glEnableClientState(GL_NORMAL_ARRAY);
+
+#ifdef USE_VBO
+
+	if ((vboId != 0) && (iboId != 0))
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, vboId);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboId);
+
+		setVertexPointers(vertexFormat, useNormal);
+		glDrawElements(GL_TRIANGLES, indiceLength, GL_UNSIGNED_INT, (GLvoid*) 0);
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+	else
+
+#endif
+	if (vertices != NULL)
+	{
+		glVertexPointer(3, GL_FLOAT, SIZE_VERTEX(1), &vertices[0].vertice);
+		if (useNormal)
+			glNormalPointer(GL_FLOAT, SIZE_VERTEX(1), &vertices[0].normal);
+		glDrawElements(GL_TRIANGLES, indiceLength, GL_UNSIGNED_INT, &indices[0]);
+	}
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	if (useNormal)
+		glDisableClientState(GL_NORMAL_ARRAY);
+
+	glEnable(GL_CULL_FACE);
+}
+
+/**
+ * The box of the volume (see SetBox)
+ */
+bool TIsosurface::GetBounds(TVector3D &boxMin, TVector3D &boxMax)
+{
+	if (volume.empty())
+		return false;
+
+	const GLuint size[3] = {sizeX, sizeY, sizeZ};
+	for (int i = 0; i < 3; i++)
+	{
+		const GLfloat a = origin[i], b = origin[i] + (size[i] - 1) * step[i];
+		boxMin.array[i] = std::min(a, b);
+		boxMax.array[i] = std::max(a, b);
+	}
+	return true;
+}
+
+// ********************************************************************************
+// End of file
+// ********************************************************************************
@@ -0,0 +1,147 @@
+#ifndef _ISOSURFACE_H
+#define _ISOSURFACE_H
+
+#include "Object3D.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <functional>
+
+namespace GLScene
+{
+
+typedef std::function<double(double x, double y, double z)> TFunctionXYZ;
+
+// Number of cells on each side of a brick of the volume
+#define ISO_BRICK	16
+
+/**
+ * A brick of ISO_BRICK^3 cells of the volume.
+ * The brick owns the vertices on the edges that start from its points, keys gives the
+ * place of each vertex in the brick (sorted, see ISO_KEY).
+ * The corners of the triangles are the brick that owns the vertex (the brick itself or one
+ * of its neighbours toward +x, +y and +z, given by the 3 high bits) and the index of the
+ * vertex in this brick.
+ */
+typedef struct TIsoBrick
+{
+	public:
+		GLfloat valueMin, valueMax;  // Range of the values of the points read by the cells
+		std::vector<TVertex> vertices;
+		std::vector<uint16_t> keys;
+		std::vector<uint32_t> corners;
+		bool dirtyVertices, dirtyTriangles;
+} TIsoBrick;
+
+/**
+ * TIsosurface class
+ * The surface f(x, y, z) = iso of a volume of dimX * dimY * dimZ values.
+ * Params: dimensions of the volume, position (default (0,0,0))
+ * eg : setFunction([](double x, double y, double z) {return x * x + y * y + z * z;});
+ *      InitializeVolume(-1.0, 1.0, -1.0, 1.0, -1.0, 1.0);
+ *      SetIsoValue(0.5);
+ *    or LoadVolumeBinary("volume.raw") for a raw file of dimX * dimY * dimZ floats (x first,
+ *    then y, then z) in the box given by SetBox (default [0, dim - 1] on each axis).
+ * The triangles are extracted by marching cubes, the cases are built from the faces of the
+ * cube (the ambiguous faces separate the points above the iso value) so the triangles of two
+ * cubes match on their common face. A vertex is shared by all the cubes around its edge,
+ * the normal is the gradient of the values (toward the increasing values).
+ * The volume is cut in bricks of ISO_BRICK^3 cells extracted in parallel, at the next
+ * display only the bricks touched by SetBlock are extracted again, and SetIsoValue
+ * only extracts the bricks whose range of values contains the old or the new iso value.
+ */
+class TIsosurface: public TObject3D
+{
+	public:
+		TIsosurface(GLuint dimX, GLuint dimY, GLuint dimZ, const TVector3D &pos = GLDefaultPosition);
+		virtual ~TIsosurface();
+
+		virtual bool GetBounds(TVector3D &boxMin, TVector3D &boxMax);
+
+		void setFunction(TFunctionXYZ fonc)
+		{
+			Function = fonc;
+		}
+		void InitializeVolume(double xMin, double xMax, double yMin, double yMax, double zMin, double zMax);
+
+		void SetBox(double xMin, double xMax, double yMin, double yMax, double zMin, double zMax);
+		void SetVolume(const GLfloat *values);
+		bool LoadVolumeBinary(const char *filename);
+		std::string GetLoadError(void)
+		{
+			return loadError;
+		}
+		void SetBlock(GLuint x, GLuint y, GLuint z, GLuint countX, GLuint countY, GLuint countZ, const GLfloat *values);
+
+		void SetIsoValue(GLfloat iso);
+		GLfloat GetIsoValue(void)
+		{
+			return isoValue;
+		}
+		void SetNormal(bool use);
+		virtual void SetVertexFormat(TVertexFormat format);
+
+		/// Number of vertices and triangles of the last mesh drawn
+		GLuint GetVertexCount(void)
+		{
+			return vertexCount;
+		}
+		GLuint GetTriangleCount(void)
+		{
+			return indiceLength / 3;
+		}
+
+		double getMinimum(void)
+		{
+			return Minimum;
+		}
+		double getMaximum(void)
+		{
+			return Maximum;
+		}
+
+	protected:
+		void DoDisplay(TDisplayMode mode = dmRender);
+
+	private:
+		TFunctionXYZ Function = NULL;
+		GLuint sizeX, sizeY, sizeZ;
+		std::vector<GLfloat> volume;
+		double origin[3], step[3];
+		double Minimum, Maximum;
+		GLfloat isoValue;
+		std::string loadError;
+
+		GLuint bricksX, bricksY, bricksZ;
+		std::vector<TIsoBrick> bricks;
+		bool meshChanged;
+
+		TVertex *vertices = NULL;
+		GLuint *indices = NULL;
+		GLuint vertexCount;
+		GLuint indiceLength;
+#ifdef USE_VBO
+		GLuint vboId = 0;  // ID of VBO for vertex and normal interleaved arrays
+		GLuint iboId = 0;  // ID of VBO for index array
+#endif
+		bool useNormal;
+
+		inline GLfloat Value(GLuint x, GLuint y, GLuint z) const
+		{
+			return volume[((size_t) z * sizeY + y) * sizeX + x];
+		}
+		GLfloat Gradient(GLuint x, GLuint y, GLuint z, int axis) const;
+
+		void VolumeChanged(void);
+		void UpdateRange(GLuint brick);
+		void MarkBricks(const GLint *low, const GLint *high);
+		void ExtractVertices(GLuint brick);
+		void ExtractTriangles(GLuint brick);
+		void BuildMesh(void);
+		void FreeMesh(void);
+};
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _ISOSURFACE_H
@@ -0,0 +1,236 @@
+#ifndef _MATRIX_4_H
+#define _MATRIX_4_H
+
+#include "Vector3D.h"
+#include <cstring>
+
+namespace GLScene
+{
+
+/**
+ * TMatrix4 : a 4x4 matrix stored like OpenGL (column major, array[12..14] is the translation)
+ * Translate, Rotate and Scale multiply the matrix on the right like glTranslate, glRotate
+ * and glScale, so the same sequence of calls gives the same matrix.
+ * eg : glMultMatrixf(matrix.Array());
+ */
+typedef struct TMatrix4
+{
+	public:
+		GLfloat array[16];
+
+		TMatrix4()
+		{
+			Identity();
+		}
+
+		TMatrix4(const GLfloat m[])
+		{
+			memcpy(array, m, sizeof(array));
+		}
+
+		inline void Identity(void)
+		{
+			static const GLfloat identity[16] = {1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+			memcpy(array, identity, sizeof(array));
+		}
+
+		inline const GLfloat* Array(void) const
+		{
+			return array;
+		}
+
+		inline GLfloat& operator [](const int index)
+		{
+			return array[index];
+		}
+
+		inline GLfloat operator [](const int index) const
+		{
+			return array[index];
+		}
+
+		inline TMatrix4 operator *(const TMatrix4 &m) const
+		{
+			TMatrix4 result;
+			for (int c = 0; c < 4; c++)
+				for (int r = 0; r < 4; r++)
+					result.array[c * 4 + r] = array[r] * m.array[c * 4] + array[r + 4] * m.array[c * 4 + 1] +
+							array[r + 8] * m.array[c * 4 + 2] + array[r + 12] * m.array[c * 4 + 3];
+			return result;
+		}
+
+		inline TMatrix4& operator *=(const TMatrix4 &m)
+		{
+			*this = *this * m;
+			return *this;
+		}
+
+		/// Like glTranslatef
+		inline TMatrix4& Translate(const GLfloat x, const GLfloat y, const GLfloat z)
+		{
+			for (int r = 0; r < 4; r++)
+				array[r + 12] += array[r] * x + array[r + 4] * y + array[r + 8] * z;
+			return *this;
+		}
+
+		inline TMatrix4& Translate(const TVector3D &vect)
+		{
+			return Translate(vect.X, vect.Y, vect.Z);
+		}
+
+		/// Like glScalef
+		inline TMatrix4& Scale(const GLfloat x, const GLfloat y, const GLfloat z)
+		{
+			for (int r = 0; r < 4; r++)
+			{
+				array[r] *= x;
+				array[r + 4] *= y;
+				array[r + 8] *= z;
+			}
+			return *this;
+		}
+
+		inline TMatrix4& Scale(const TVector3D &vect)
+		{
+			return Scale(vect.X, vect.Y, vect.Z);
+		}
+
+		/// Like glRotatef : angle in degrees around the axis (x, y, z), nothing for a null axis
+		inline TMatrix4& Rotate(const GLfloat angle, GLfloat x, GLfloat y, GLfloat z)
+		{
+			const GLfloat length = sqrtf(x * x + y * y + z * z);
+			if ((length < 1.0e-4) || (angle == 0.0f))
+				return *this;
+			x /= length;
+			y /= length;
+			z /= length;
+
+			const GLfloat c = cos(angle / RADtoDEG), s = sin(angle / RADtoDEG), t = 1.0f - c;
+			TMatrix4 rotation;
+			rotation.array[0] = x * x * t + c;
+			rotation.array[1] = y * x * t + z * s;
+			rotation.array[2] = x * z * t - y * s;
+			rotation.array[4] = x * y * t - z * s;
+			rotation.array[5] = y * y * t + c;
+			rotation.array[6] = y * z * t + x * s;
+			rotation.array[8] = x * z * t + y * s;
+			rotation.array[9] = y * z * t - x * s;
+			rotation.array[10] = z * z * t + c;
+			*this *= rotation;
+			return *this;
+		}
+
+		inline TMatrix4& Rotate(const GLfloat angle, const TVector3D &axis)
+		{
+			return Rotate(angle, axis.X, axis.Y, axis.Z);
+		}
+
+		/// The inverse matrix, the identity if the matrix can not be inverted
+		TMatrix4 Inverse(void) const
+		{
+			const GLfloat *m = array;
+			TMatrix4 inv;
+			GLfloat *r = inv.array;
+			r[0] = m[5] * m[10] * m[15] - m[5] * m[11] * m[14] - m[9] * m[6] * m[15] + m[9] * m[7] * m[14] + m[13] * m[6] * m[11] - m[13] * m[7] * m[10];
+			r[4] = -m[4] * m[10] * m[15] + m[4] * m[11] * m[14] + m[8] * m[6] * m[15] - m[8] * m[7] * m[14] - m[12] * m[6] * m[11] + m[12] * m[7] * m[10];
+			r[8] = m[4] * m[9] * m[15] - m[4] * m[11] * m[13] - m[8] * m[5] * m[15] + m[8] * m[7] * m[13] + m[12] * m[5] * m[11] - m[12] * m[7] * m[9];
+			r[12] = -m[4] * m[9] * m[14] + m[4] * m[10] * m[13] + m[8] * m[5] * m[14] - m[8] * m[6] * m[13] - m[12] * m[5] * m[10] + m[12] * m[6] * m[9];
+			r[1] = -m[1] * m[10] * m[15] + m[1] * m[11] * m[14] + m[9] * m[2] * m[15] - m[9] * m[3] * m[14] - m[13] * m[2] * m[11] + m[13] * m[3] * m[10];
+			r[5] = m[0] * m[10] * m[15] - m[0] * m[11] * m[14] - m[8] * m[2] * m[15] + m[8] * m[3] * m[14] + m[12] * m[2] * m[11] - m[12] * m[3] * m[10];
+			r[9] = -m[0] * m[9] * m[15] + m[0] * m[11] * m[13] + m[8] * m[1] * m[15] - m[8] * m[3] * m[13] - m[12] * m[1] * m[11] + m[12] * m[3] * m[9];
+			r[13] = m[0] * m[9] * m[14] - m[0] * m[10] * m[13] - m[8] * m[1] * m[14] + m[8] * m[2] * m[13] + m[12] * m[1] * m[10] - m[12] * m[2] * m[9];
+			r[2] = m[1] * m[6] * m[15] - m[1] * m[7] * m[14] - m[5] * m[2] * m[15] + m[5] * m[3] * m[14] + m[13] * m[2] * m[7] - m[13] * m[3] * m[6];
+			r[6] = -m[0] * m[6] * m[15] + m[0] * m[7] * m[14] + m[4] * m[2] * m[15] - m[4] * m[3] * m[14] - m[12] * m[2] * m[7] + m[12] * m[3] * m[6];
+			r[10] = m[0] * m[5] * m[15] - m[0] * m[7] * m[13] - m[4] * m[1] * m[15] + m[4] * m[3] * m[13] + m[12] * m[1] * m[7] - m[12] * m[3] * m[5];
+			r[14] = -m[0] * m[5] * m[14] + m[0] * m[6] * m[13] + m[4] * m[1] * m[14] - m[4] * m[2] * m[13] - m[12] * m[1] * m[6] + m[12] * m[2] * m[5];
+			r[3] = -m[1] * m[6] * m[11] + m[1] * m[7] * m[10] + m[5] * m[2] * m[11] - m[5] * m[3] * m[10] - m[9] * m[2] * m[7] + m[9] * m[3] * m[6];
+			r[7] = m[0] * m[6] * m[11] - m[0] * m[7] * m[10] - m[4] * m[2] * m[11] + m[4] * m[3] * m[10] + m[8] * m[2] * m[7] - m[8] * m[3] * m[6];
+			r[11] = -m[0] * m[5] * m[11] + m[0] * m[7] * m[9] + m[4] * m[1] * m[11] - m[4] * m[3] * m[9] - m[8] * m[1] * m[7] + m[8] * m[3] * m[5];
+			r[15] = m[0] * m[5] * m[10] - m[0] * m[6] * m[9] - m[4] * m[1] * m[10] + m[4] * m[2] * m[9] + m[8] * m[1] * m[6] - m[8] * m[2] * m[5];
+
+			const double det = (double) m[0] * r[0] + (double) m[1] * r[4] + (double) m[2] * r[8] + (double) m[3] * r[12];
+			if (fabs(det) < 1.0e-30)
+				return TMatrix4();
+			const GLfloat invDet = 1.0 / det;
+			for (int i = 0; i < 16; i++)
+				r[i] *= invDet;
+			return inv;
+		}
+
+		/// Like glFrustum
+		static TMatrix4 Frustum(double left, double right, double bottom, double top, double zNear, double zFar)
+		{
+			TMatrix4 m;
+			m[0] = 2.0 * zNear / (right - left);
+			m[5] = 2.0 * zNear / (top - bottom);
+			m[8] = (right + left) / (right - left);
+			m[9] = (top + bottom) / (top - bottom);
+			m[10] = -(zFar + zNear) / (zFar - zNear);
+			m[11] = -1.0f;
+			m[14] = -2.0 * zFar * zNear / (zFar - zNear);
+			m[15] = 0.0f;
+			return m;
+		}
+
+		/// Like gluPerspective, fovy in degrees
+		static TMatrix4 Perspective(double fovy, double aspect, double zNear, double zFar)
+		{
+			const double top = zNear * tan(0.5 * fovy / RADtoDEG);
+			return Frustum(-top * aspect, top * aspect, -top, top, zNear, zFar);
+		}
+
+		/// Like glOrtho
+		static TMatrix4 Ortho(double left, double right, double bottom, double top, double zNear, double zFar)
+		{
+			TMatrix4 m;
+			m[0] = 2.0 / (right - left);
+			m[5] = 2.0 / (top - bottom);
+			m[10] = -2.0 / (zFar - zNear);
+			m[12] = -(right + left) / (right - left);
+			m[13] = -(top + bottom) / (top - bottom);
+			m[14] = -(zFar + zNear) / (zFar - zNear);
+			return m;
+		}
+
+		/// Like gluLookAt
+		static TMatrix4 LookAt(const TVector3D &eye, const TVector3D &center, const TVector3D &up)
+		{
+			TVector3D f = center - eye;
+			f.Normalize();
+			TVector3D s = f ^ up;
+			s.Normalize();
+			const TVector3D u = s ^ f;
+			TMatrix4 m;
+			m[0] = s.X;
+			m[4] = s.Y;
+			m[8] = s.Z;
+			m[1] = u.X;
+			m[5] = u.Y;
+			m[9] = u.Z;
+			m[2] = -f.X;
+			m[6] = -f.Y;
+			m[10] = -f.Z;
+			return m.Translate(-eye.X, -eye.Y, -eye.Z);
+		}
+
+		/// The point transformed by the matrix (w = 1, no perspective division)
+		inline TVector3D TransformPoint(const TVector3D &point) const
+		{
+			return TVector3D(array[0] * point.X + array[4] * point.Y + array[8] * point.Z + array[12],
+					array[1] * point.X + array[5] * point.Y + array[9] * point.Z + array[13],
+					array[2] * point.X + array[6] * point.Y + array[10] * point.Z + array[14]);
+		}
+
+		/// The direction transformed by the matrix (w = 0, without the translation)
+		inline TVector3D TransformDirection(const TVector3D &vect) const
+		{
+			return TVector3D(array[0] * vect.X + array[4] * vect.Y + array[8] * vect.Z,
+					array[1] * vect.X + array[5] * vect.Y + array[9] * vect.Z,
+					array[2] * vect.X + array[6] * vect.Y + array[10] * vect.Z);
+		}
+} TMatrix4;
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _MATRIX_4_H
@@ -1,4 +1,5 @@
 #include "Object3D.h"
+#include <atomic>
 
 #ifdef USE_VBO
 
@@ -15,6 +16,29 @@ PFNGLMAPBUFFERPROC glMapBuffer = NULL;
 PFNGLUNMAPBUFFERPROC glUnmapBuffer = NULL;
 PFNGLGETBUFFERPARAMETERIVPROC glGetBufferParameteriv = NULL;
 PFNGLACTIVETEXTUREPROC glActiveTexture = NULL;
+PFNGLPRIMITIVERESTARTINDEXPROC glPrimitiveRestartIndex = NULL;
+PFNGLMAPBUFFERRANGEPROC glMapBufferRange = NULL;
+PFNGLBUFFERSTORAGEPROC glBufferStorage = NULL;
+PFNGLFENCESYNCPROC glFenceSync = NULL;
+PFNGLCLIENTWAITSYNCPROC glClientWaitSync = NULL;
+PFNGLDELETESYNCPROC glDeleteSync = NULL;
+PFNGLCREATESHADERPROC glCreateShader = NULL;
+PFNGLSHADERSOURCEPROC glShaderSource = NULL;
+PFNGLCOMPILESHADERPROC glCompileShader = NULL;
+PFNGLGETSHADERIVPROC glGetShaderiv = NULL;
+PFNGLGETSHADERINFOLOGPROC glGetShaderInfoLog = NULL;
+PFNGLDELETESHADERPROC glDeleteShader = NULL;
+PFNGLCREATEPROGRAMPROC glCreateProgram = NULL;
+PFNGLATTACHSHADERPROC glAttachShader = NULL;
+PFNGLLINKPROGRAMPROC glLinkProgram = NULL;
+PFNGLGETPROGRAMIVPROC glGetProgramiv = NULL;
+PFNGLGETPROGRAMINFOLOGPROC glGetProgramInfoLog = NULL;
+PFNGLUSEPROGRAMPROC glUseProgram = NULL;
+PFNGLDELETEPROGRAMPROC glDeleteProgram = NULL;
+PFNGLGETUNIFORMLOCATIONPROC glGetUniformLocation = NULL;
+PFNGLUNIFORM1IPROC glUniform1i = NULL;
+PFNGLUNIFORM1FPROC glUniform1f = NULL;
+PFNGLUNIFORM2FPROC glUniform2f = NULL;
 
 void initOGL()
 {
@@ -31,6 +55,29 @@ void initOGL()
 		glUnmapBuffer = (PFNGLUNMAPBUFFERPROC) wglGetProcAddress("glUnmapBuffer");
 		glGetBufferParameteriv = (PFNGLGETBUFFERPARAMETERIVPROC) wglGetProcAddress("glGetBufferParameteriv");
 		glActiveTexture = (PFNGLACTIVETEXTUREPROC) wglGetProcAddress("glActiveTexture");
+		glPrimitiveRestartIndex = (PFNGLPRIMITIVERESTARTINDEXPROC) wglGetProcAddress("glPrimitiveRestartIndex");
+		glMapBufferRange = (PFNGLMAPBUFFERRANGEPROC) wglGetProcAddress("glMapBufferRange");
+		glBufferStorage = (PFNGLBUFFERSTORAGEPROC) wglGetProcAddress("glBufferStorage");
+		glFenceSync = (PFNGLFENCESYNCPROC) wglGetProcAddress("glFenceSync");
+		glClientWaitSync = (PFNGLCLIENTWAITSYNCPROC) wglGetProcAddress("glClientWaitSync");
+		glDeleteSync = (PFNGLDELETESYNCPROC) wglGetProcAddress("glDeleteSync");
+		glCreateShader = (PFNGLCREATESHADERPROC) wglGetProcAddress("glCreateShader");
+		glShaderSource = (PFNGLSHADERSOURCEPROC) wglGetProcAddress("glShaderSource");
+		glCompileShader = (PFNGLCOMPILESHADERPROC) wglGetProcAddress("glCompileShader");
+		glGetShaderiv = (PFNGLGETSHADERIVPROC) wglGetProcAddress("glGetShaderiv");
+		glGetShaderInfoLog = (PFNGLGETSHADERINFOLOGPROC) wglGetProcAddress("glGetShaderInfoLog");
+		glDeleteShader = (PFNGLDELETESHADERPROC) wglGetProcAddress("glDeleteShader");
+		glCreateProgram = (PFNGLCREATEPROGRAMPROC) wglGetProcAddress("glCreateProgram");
+		glAttachShader = (PFNGLATTACHSHADERPROC) wglGetProcAddress("glAttachShader");
+		glLinkProgram = (PFNGLLINKPROGRAMPROC) wglGetProcAddress("glLinkProgram");
+		glGetProgramiv = (PFNGLGETPROGRAMIVPROC) wglGetProcAddress("glGetProgramiv");
+		glGetProgramInfoLog = (PFNGLGETPROGRAMINFOLOGPROC) wglGetProcAddress("glGetProgramInfoLog");
+		glUseProgram = (PFNGLUSEPROGRAMPROC) wglGetProcAddress("glUseProgram");
+		glDeleteProgram = (PFNGLDELETEPROGRAMPROC) wglGetProcAddress("glDeleteProgram");
+		glGetUniformLocation = (PFNGLGETUNIFORMLOCATIONPROC) wglGetProcAddress("glGetUniformLocation");
+		glUniform1i = (PFNGLUNIFORM1IPROC) wglGetProcAddress("glUniform1i");
+		glUniform1f = (PFNGLUNIFORM1FPROC) wglGetProcAddress("glUniform1f");
+		glUniform2f = (PFNGLUNIFORM2FPROC) wglGetProcAddress("glUniform2f");
 #pragma GCC diagnostic pop
 	}
 }
@@ -83,6 +130,152 @@ void updateVBO(int id, const void *data, int dataSize, GLenum target)
 	glBindBuffer(target, 0);                                  // unactivate vbo after use
 }
 
+// The normal of the packed formats : 3 signed bytes + 1 for the alignment
+#define SIZE_PACKED_NORMAL	(4 * sizeof(GLbyte))
+
+/**
+ * The half float vertex is core since OpenGL 3.0
+ */
+static bool HalfVertexSupported(void)
+{
+	static int supported = -1;
+
+	if (supported < 0)
+	{
+		int major = 0, minor = 0;
+		const char *version = (const char*) glGetString(GL_VERSION);
+		if (version != NULL)
+			sscanf(version, "%d.%d", &major, &minor);
+		supported = (major >= 3) ? 1 : 0;
+	}
+	return (supported == 1);
+}
+
+/**
+ * The normal in a signed byte by coordinate, the GPU maps [-127, 127] to [-1, 1].
+ * GL_INT_2_10_10_10_REV would be more accurate but glNormalPointer doesn't take it
+ * everywhere (it wants 4 coordinates).
+ */
+void GLScene::packNormal(const TGLfloat3D &normal, GLbyte packed[4])
+{
+	for (int i = 0; i < 3; i++)
+	{
+		const GLfloat value = (normal.array[i] > 1.0f) ? 1.0f : ((normal.array[i] < -1.0f) ? -1.0f : normal.array[i]);
+		packed[i] = (GLbyte) lroundf(value * 127.0f);
+	}
+	packed[3] = 0;
+}
+
+/**
+ * The nearest half float (the too large values give the infinity)
+ */
+GLushort GLScene::floatToHalf(GLfloat value)
+{
+	GLuint bits;
+	memcpy(&bits, &value, sizeof(bits));
+	const GLushort sign = (bits >> 16) & 0x8000;
+	const GLint exponent = (GLint) ((bits >> 23) & 0xFF) - 127 + 15;
+	GLuint mantissa = bits & 0x007FFFFF;
+
+	if (((bits >> 23) & 0xFF) == 0xFF)
+		return sign | 0x7C00 | (mantissa ? 0x200 : 0);  // NaN or infinity
+	if (exponent >= 31)
+		return sign | 0x7C00;
+	if (exponent <= 0)
+	{
+		// Subnormal half or zero
+		if (exponent < -10)
+			return sign;
+		mantissa |= 0x00800000;
+		const GLuint shift = 14 - exponent;
+		GLuint half = mantissa >> shift;
+		if ((mantissa >> (shift - 1)) & 1)
+			half++;
+		return sign | half;
+	}
+
+	GLuint half = ((GLuint) exponent << 10) | (mantissa >> 13);
+	// Round to nearest, the carry can go in the exponent
+	if ((mantissa & 0x1FFF) > 0x1000 || ((mantissa & 0x1FFF) == 0x1000 && (half & 1)))
+		half++;
+	return sign | (GLushort) half;
+}
+
+GLsizei GLScene::vertexFormatSize(TVertexFormat format)
+{
+	switch (format)
+	{
+		case vfPackedNormal:
+			return SIZE_PACKED_NORMAL + SIZE_FLOAT3D(1);
+		case vfHalf:
+			return SIZE_PACKED_NORMAL + 4 * sizeof(GLushort);
+		default:
+			return SIZE_VERTEX(1);
+	}
+}
+
+/**
+ * The VBO of the vertices in the format, format becomes vfPackedNormal if the half float
+ * is not supported
+ */
+GLuint GLScene::createVertexVBO(const TVertex *vertices, GLuint count, TVertexFormat &format)
+{
+	if ((format == vfHalf) && !HalfVertexSupported())
+	{
+		std::cout << "[WARNING] Half float vertex needs OpenGL 3.0, float position used." << std::endl;
+		format = vfPackedNormal;
+	}
+	if (format == vfFloat)
+		return createVBO(vertices, SIZE_VERTEX(count));
+
+	const GLsizei size = vertexFormatSize(format);
+	GLubyte *data = new GLubyte[(size_t) size * count];
+	GLubyte *vertex = data;
+	for (GLuint k = 0; k < count; k++, vertex += size)
+	{
+		packNormal(vertices[k].normal, (GLbyte*) vertex);
+		if (format == vfPackedNormal)
+			memcpy(vertex + SIZE_PACKED_NORMAL, &vertices[k].vertice, SIZE_FLOAT3D(1));
+		else
+		{
+			GLushort position[4];
+			for (int i = 0; i < 3; i++)
+				position[i] = floatToHalf(vertices[k].vertice.array[i]);
+			position[3] = 0;
+			memcpy(vertex + SIZE_PACKED_NORMAL, position, sizeof(position));
+		}
+	}
+	const GLuint id = createVBO(data, size * count);
+	delete[] data;
+	return id;
+}
+
+/**
+ * The pointers of the vertex VBO bound in GL_ARRAY_BUFFER. With texCoordZ, the Z of the
+ * position is the texture coordinate (color map).
+ */
+void GLScene::setVertexPointers(TVertexFormat format, bool normal, bool texCoordZ)
+{
+	const GLsizei stride = vertexFormatSize(format);
+	if (format == vfFloat)
+	{
+		glVertexPointer(3, GL_FLOAT, stride, (GLvoid*) SIZE_FLOAT3D(1));
+		if (normal)
+			glNormalPointer(GL_FLOAT, stride, (GLvoid*) 0);
+		if (texCoordZ)
+			glTexCoordPointer(1, GL_FLOAT, stride, (GLvoid*) (5 * sizeof(GLfloat)));
+		return;
+	}
+
+	const GLenum type = (format == vfHalf) ? GL_HALF_FLOAT : GL_FLOAT;
+	const size_t coordinate = (format == vfHalf) ? sizeof(GLushort) : sizeof(GLfloat);
+	glVertexPointer(3, type, stride, (GLvoid*) SIZE_PACKED_NORMAL);
+	if (normal)
+		glNormalPointer(GL_BYTE, stride, (GLvoid*) 0);
+	if (texCoordZ)
+		glTexCoordPointer(1, type, stride, (GLvoid*) (SIZE_PACKED_NORMAL + 2 * coordinate));
+}
+
 #endif // USE_VBO
 
 const TVector3D GLScene::GLDefaultPosition(0.0f, 0.0f, 0.0f);
@@ -135,6 +328,7 @@ void TObject3D::defaultSettings()
 
 	levelOfDetail = 12;
 	selected = false;
+	vertexFormat = vfFloat;
 }
 
 // SETTERS
@@ -198,20 +392,7 @@ void TObject3D::Display(int id, TDisplayMode mode)
 	if (!Visible) return;
 
 	glPushMatrix();
-
-	// translation
-	if (DoPosition) glTranslatef(position.X, position.Y, position.Z);
-
-	// rotation
-	if (DoRotation)
-	{
-		glRotatef(rotation.X, 1.0, 0.0, 0.0);
-		glRotatef(rotation.Y, 0.0, 1.0, 0.0);
-		glRotatef(rotation.Z, 0.0, 0.0, 1.0);
-	}
-
-	// scale
-	if (DoScale) glScalef(scale.X, scale.Y, scale.Z);
+	glMultMatrixf(GetModelMatrix().Array());
 
 	if (DoUseMaterial && (mode == dmRender))
 	{
@@ -225,6 +406,70 @@ void TObject3D::Display(int id, TDisplayMode mode)
 	glPopMatrix();
 }
 
+/**
+ * The model matrix of the object, only computed again when the object changed
+ */
+const TMatrix4& TObject3D::GetModelMatrix(void)
+{
+	if (Changed)
+	{
+		ComputeModelMatrix();
+		Changed = false;
+	}
+	return modelMatrix;
+}
+
+/**
+ * The bounding box of the object in the scene : the box of GetBounds transformed by
+ * the model matrix. False if the object has no size.
+ */
+bool TObject3D::GetWorldBounds(TVector3D &boxMin, TVector3D &boxMax)
+{
+	TVector3D localMin, localMax;
+	if (!GetBounds(localMin, localMax))
+		return false;
+
+	const TMatrix4 &matrix = GetModelMatrix();
+	for (int k = 0; k < 8; k++)
+	{
+		const TVector3D corner((k & 1) ? localMax.X : localMin.X, (k & 2) ? localMax.Y : localMin.Y,
+				(k & 4) ? localMax.Z : localMin.Z);
+		const TVector3D point = matrix.TransformPoint(corner);
+		if (k == 0)
+			boxMin = boxMax = point;
+		else
+			for (int i = 0; i < 3; i++)
+			{
+				if (point.array[i] < boxMin.array[i]) boxMin.array[i] = point.array[i];
+				if (point.array[i] > boxMax.array[i]) boxMax.array[i] = point.array[i];
+			}
+	}
+	return true;
+}
+
+/**
+ * The translation, rotation and scale of the object. The objects that place themselves
+ * (see TBaseCylinder, TCube) add their own transformation after this one.
+ */
+void TObject3D::ComputeModelMatrix(void)
+{
+	modelMatrix.Identity();
+
+	// translation
+	if (DoPosition) modelMatrix.Translate(position);
+
+	// rotation
+	if (DoRotation)
+	{
+		modelMatrix.Rotate(rotation.X, 1.0, 0.0, 0.0);
+		modelMatrix.Rotate(rotation.Y, 0.0, 1.0, 0.0);
+		modelMatrix.Rotate(rotation.Z, 0.0, 0.0, 1.0);
+	}
+
+	// scale
+	if (DoScale) modelMatrix.Scale(scale);
+}
+
 /**
  * Move the center of the object to the 'position' and make the rotation to
  * be in 'direction' for drawing an object with 'len' size in the direction
@@ -274,25 +519,51 @@ void TObject3D::PrepareRotate(GLfloat len)
 // Random functions
 // ********************************************************************************
 
+// The seed of the generators of the threads and the number of generators
+static std::atomic<uint64_t> randomSeed(0x853C49E6748FEA9BULL);
+static std::atomic<uint64_t> randomStreams(0);
+
+/**
+ * The generator of the thread, the generators of the threads are different streams of the seed
+ */
+static TRandom& ThreadRandom(void)
+{
+	thread_local TRandom random(randomSeed.load(), randomStreams++);
+	return random;
+}
+
+/**
+ * Seed the generator of the calling thread, and the generators of the threads that
+ * don't have used GLRand yet
+ */
+void GLScene::GLRandSeed(uint64_t seed)
+{
+	randomSeed = seed;
+	ThreadRandom().Seed(seed);
+}
+
 /**
- * Return a random number between [-1, 1]
+ * Return a random number between [-1, 1[
  */
 GLfloat GLScene::GLRand(void)
 {
-	return (GLfloat) ((1.0 * rand() / RAND_MAX - 0.5) * 2.0);
+	return ThreadRandom().Uniform(-1.0f, 1.0f);
 }
 
 /**
- * Return a random number between [0, max]
+ * Return a random number between [0, max[
  */
 GLfloat GLScene::GLRand(GLfloat max)
 {
-	return (GLfloat)(rand())/(RAND_MAX*1.0) * max;
+	return ThreadRandom().Uniform() * max;
 }
 
 TVector4D GLScene::RandomColor(void)
 {
-	return TVector4D(GLRand(1.0), GLRand(1.0), GLRand(1.0), 1.0);
+	TRandom &random = ThreadRandom();
+	const GLfloat red = random.Uniform();
+	const GLfloat green = random.Uniform();
+	return TVector4D(red, green, random.Uniform(), 1.0f);
 }
 
 // ********************************************************************************
@@ -30,7 +30,10 @@
 
 #include "Vector3D.h"
 #include "Vector4D.h"
+#include "Matrix4.h"
+#include "Quaternion.h"
 #include "Material.h"
+#include "Random.h"
 #include <initializer_list> // for std::initializer_list
 #include "GLColor.h"
 
@@ -57,6 +60,29 @@ extern PFNGLMAPBUFFERPROC glMapBuffer;
 extern PFNGLUNMAPBUFFERPROC glUnmapBuffer;
 extern PFNGLGETBUFFERPARAMETERIVPROC glGetBufferParameteriv;
 extern PFNGLACTIVETEXTUREPROC glActiveTexture;
+extern PFNGLPRIMITIVERESTARTINDEXPROC glPrimitiveRestartIndex;
+extern PFNGLMAPBUFFERRANGEPROC glMapBufferRange;
+extern PFNGLBUFFERSTORAGEPROC glBufferStorage;
+extern PFNGLFENCESYNCPROC glFenceSync;
+extern PFNGLCLIENTWAITSYNCPROC glClientWaitSync;
+extern PFNGLDELETESYNCPROC glDeleteSync;
+extern PFNGLCREATESHADERPROC glCreateShader;
+extern PFNGLSHADERSOURCEPROC glShaderSource;
+extern PFNGLCOMPILESHADERPROC glCompileShader;
+extern PFNGLGETSHADERIVPROC glGetShaderiv;
+extern PFNGLGETSHADERINFOLOGPROC glGetShaderInfoLog;
+extern PFNGLDELETESHADERPROC glDeleteShader;
+extern PFNGLCREATEPROGRAMPROC glCreateProgram;
+extern PFNGLATTACHSHADERPROC glAttachShader;
+extern PFNGLLINKPROGRAMPROC glLinkProgram;
+extern PFNGLGETPROGRAMIVPROC glGetProgramiv;
+extern PFNGLGETPROGRAMINFOLOGPROC glGetProgramInfoLog;
+extern PFNGLUSEPROGRAMPROC glUseProgram;
+extern PFNGLDELETEPROGRAMPROC glDeleteProgram;
+extern PFNGLGETUNIFORMLOCATIONPROC glGetUniformLocation;
+extern PFNGLUNIFORM1IPROC glUniform1i;
+extern PFNGLUNIFORM1FPROC glUniform1f;
+extern PFNGLUNIFORM2FPROC glUniform2f;
 #endif
 
 #endif // USE_GLEW
@@ -72,7 +98,7 @@ namespace GLScene
 
 typedef enum {
 	otAxis, otCube, otCuboid, otCylinder, otCone, otSphere,
-	otEllipsoid, otArrow, otGrid, otSpin, otSurface, otNone
+	otEllipsoid, otArrow, otGrid, otSpin, otSurface, otTiledSurface, otAdaptiveSurface, otScatteredSurface, otIsosurface, otPointCloud, otPolyline, otNone
 } TObjectType;
 
 typedef enum {
@@ -146,6 +172,28 @@ typedef union TVertex
 #define SIZE_USHORT(size)	((size) * sizeof(GLushort))
 #define SIZE_UINT(size)	((size) * sizeof(GLuint))
 
+/**
+ * The format of the vertices in the VBO, the arrays in memory stay TVertex :
+ * vfFloat : GL_N3F_V3F, 24 bytes
+ * vfPackedNormal : the normal in 3 signed bytes (+ 1 byte for the alignment) then the
+ *   position, 16 bytes
+ * vfHalf : the packed normal then the position in half float, 12 bytes. Half float keeps
+ *   11 bits, it is for the primitives of about unit size, not for large coordinates.
+ * The GPU unpacks the vertex when it reads it. vfHalf needs OpenGL 3.0, else the VBO
+ * is in vfPackedNormal.
+ */
+typedef enum {
+	vfFloat, vfPackedNormal, vfHalf
+} TVertexFormat;
+
+#ifdef USE_VBO
+void packNormal(const TGLfloat3D &normal, GLbyte packed[4]);
+GLushort floatToHalf(GLfloat value);
+GLsizei vertexFormatSize(TVertexFormat format);
+GLuint createVertexVBO(const TVertex *vertices, GLuint count, TVertexFormat &format);
+void setVertexPointers(TVertexFormat format, bool normal = true, bool texCoordZ = false);
+#endif
+
 /// An usefull shortcut to delete and null array structure
 /// Note the use of brace {} to enclose the operations
 #define DeleteAndNull(p)	\
@@ -188,6 +236,17 @@ class TObject3D {
 
 		void Display(int id, TDisplayMode mode = dmRender);
 
+		const TMatrix4& GetModelMatrix(void);
+
+		/// The bounding box in the coordinates of the object, false if the object has no size
+		virtual bool GetBounds(TVector3D &boxMin, TVector3D &boxMax)
+		{
+			(void) boxMin;
+			(void) boxMax;
+			return false;
+		}
+		bool GetWorldBounds(TVector3D &boxMin, TVector3D &boxMax);
+
 		void Select()
 		{
 			selected = true;
@@ -196,6 +255,10 @@ class TObject3D {
 		{
 			selected = false;
 		}
+		bool IsSelected()
+		{
+			return selected;
+		}
 
 		// setters
 		void virtual SetPosition(const TVector3D *pos, bool normalize = true)
@@ -267,6 +330,11 @@ class TObject3D {
 		{
 			return direction;
 		}
+		/// The rotation from the Z axis to the direction (objects with a direction)
+		inline TQuaternion GetOrientation()
+		{
+			return orientation;
+		}
 		inline TVector3D GetRotation()
 		{
 			return rotation;
@@ -281,6 +349,19 @@ class TObject3D {
 			return levelOfDetail;
 		}
 
+		/**
+		 * The format of the vertices in the VBO (see TVertexFormat). The objects build their VBO
+		 * again, except TAdaptiveSurface : the format is used by the next InitializeSurface.
+		 */
+		virtual void SetVertexFormat(TVertexFormat format)
+		{
+			vertexFormat = format;
+		}
+		inline TVertexFormat GetVertexFormat()
+		{
+			return vertexFormat;
+		}
+
 	protected:
 		TObjectType ObjectType;
 		bool Lighted;
@@ -293,9 +374,12 @@ class TObject3D {
 		TVector3D direction;
 		TVector3D rotation;
 		TVector3D scale;
+		TQuaternion orientation;
 		bool DoPosition = false;
 		bool DoRotation = false;
 		bool DoScale = false;
+		// The transformation of the object, computed again when Changed is set
+		TMatrix4 modelMatrix;
 
 		// Material
 		TMaterial material = TMaterial();
@@ -304,6 +388,7 @@ class TObject3D {
 
 		int levelOfDetail;
 		bool selected;
+		TVertexFormat vertexFormat;
 
 #ifdef USE_VBO
     bool createVBO_OK = true;
@@ -315,6 +400,7 @@ class TObject3D {
     	(void) normalize;
     }
 		virtual void SetLevelOfDetail(int detail);
+		virtual void ComputeModelMatrix(void);
 		virtual void DoDisplay(TDisplayMode mode = dmRender) = 0;
 		void PrepareRotate(GLfloat len);
 
@@ -323,7 +409,8 @@ class TObject3D {
 		void Draw();
 };
 
-// Random functions
+// Random functions, each thread has its generator (see TRandom for the batches)
+void GLRandSeed(uint64_t seed);
 GLfloat GLRand(void);
 GLfloat GLRand(GLfloat max);
 TVector4D RandomColor(void);
@@ -0,0 +1,63 @@
+#ifndef _PARALLEL_H
+#define _PARALLEL_H
+
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+namespace GLScene
+{
+
+// The prototype of the work done by a thread on the range [begin, end[
+typedef std::function<void(size_t begin, size_t end)> TParallelRange;
+
+/**
+ * Number of threads used by ParallelFor (at least 1)
+ */
+inline unsigned int ParallelThreadCount(void)
+{
+	unsigned int count = std::thread::hardware_concurrency();
+	return (count == 0) ? 1 : count;
+}
+
+/**
+ * Split [begin, end[ in contiguous ranges of at least minRange elements
+ * and run them on threads. Return when all the ranges are done.
+ * The last range is done by the calling thread.
+ */
+inline void ParallelFor(size_t begin, size_t end, TParallelRange range, size_t minRange = 1)
+{
+	if (end <= begin)
+		return;
+
+	const size_t count = end - begin;
+	size_t threads = ParallelThreadCount();
+	if (minRange < 1)
+		minRange = 1;
+	if (threads > count / minRange)
+		threads = count / minRange;
+	if (threads <= 1)
+	{
+		range(begin, end);
+		return;
+	}
+
+	std::vector<std::thread> workers;
+	const size_t step = count / threads;
+	size_t first = begin;
+	for (size_t i = 0; i < threads - 1; i++)
+	{
+		workers.push_back(std::thread(range, first, first + step));
+		first += step;
+	}
+	range(first, end);
+
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+}
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _PARALLEL_H
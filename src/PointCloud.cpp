@@ -0,0 +1,471 @@
+#include "PointCloud.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// Size of a point of each attribute
+static const GLuint pointStride[paCount] = {3 * sizeof(GLfloat), 4 * sizeof(GLubyte), sizeof(GLfloat)};
+// SetPoints sorts the points in cells of about POINT_CHUNK / POINT_CELL_RATIO points
+#define POINT_CELL_RATIO	8
+#define POINT_MAX_LEVEL	7
+
+TPointCloud::TPointCloud(const TVector3D &pos) : TObject3D(pos)
+{
+	ObjectType = otPointCloud;
+
+	pointCount = 0;
+	hasColors = hasScalars = false;
+	scalarMin = scalarMax = 0.0f;
+
+	pointColor = GLColor_white;
+
+	pointSize = 1.0f;
+	splatSize = 0.0f;
+	pointDensity = 0.0f;
+	visibleChunks = 0;
+	visiblePoints = 0;
+
+	DoPosition = true;
+}
+
+TPointCloud::~TPointCloud()
+{
+	Clear();
+}
+
+/**
+ * Replace the points of the cloud
+ */
+void TPointCloud::SetPoints(const TVector3D *points, GLuint count)
+{
+	Clear();
+	std::vector<GLuint> order;
+	SortPoints(points, count, order);
+	Append(points, count, NULL, NULL, order.data());
+}
+
+void TPointCloud::SetPoints(const TVector3D *points, GLuint count, const TVector4D *colors)
+{
+	Clear();
+	std::vector<GLuint> order;
+	SortPoints(points, count, order);
+	Append(points, count, colors, NULL, order.data());
+}
+
+void TPointCloud::SetPoints(const TVector3D *points, GLuint count, const GLfloat *scalars)
+{
+	Clear();
+	std::vector<GLuint> order;
+	SortPoints(points, count, order);
+	Append(points, count, NULL, scalars, order.data());
+}
+
+/**
+ * Add the points at the end of the cloud, only the new points are uploaded
+ */
+void TPointCloud::AddPoints(const TVector3D *points, GLuint count)
+{
+	Append(points, count, NULL, NULL, NULL);
+}
+
+void TPointCloud::AddPoints(const TVector3D *points, GLuint count, const TVector4D *colors)
+{
+	Append(points, count, colors, NULL, NULL);
+}
+
+void TPointCloud::AddPoints(const TVector3D *points, GLuint count, const GLfloat *scalars)
+{
+	Append(points, count, NULL, scalars, NULL);
+}
+
+void TPointCloud::Clear(void)
+{
+	for (TPointChunk &chunk : chunks)
+		FreeChunk(chunk);
+	chunks.clear();
+	pointCount = 0;
+	hasColors = hasScalars = false;
+	scalarMin = scalarMax = 0.0f;
+}
+
+/**
+ * Spread the 3 bits of cells of a Z-order curve
+ */
+static inline GLuint SpreadBits(GLuint v)
+{
+	GLuint result = 0;
+	for (GLuint bit = 0; bit < POINT_MAX_LEVEL; bit++)
+		result |= ((v >> bit) & 1) << (3 * bit);
+	return result;
+}
+
+/**
+ * The order of the points sorted by cells of a grid on the bounding box, the cells along
+ * a Z-order curve (counting sort)
+ */
+void TPointCloud::SortPoints(const TVector3D *points, GLuint count, std::vector<GLuint> &order)
+{
+	if ((points == NULL) || (count == 0))
+		return;
+
+	TVector3D low = points[0], high = points[0];
+	for (GLuint k = 1; k < count; k++)
+	{
+		low.X = std::min(low.X, points[k].X);
+		low.Y = std::min(low.Y, points[k].Y);
+		low.Z = std::min(low.Z, points[k].Z);
+		high.X = std::max(high.X, points[k].X);
+		high.Y = std::max(high.Y, points[k].Y);
+		high.Z = std::max(high.Z, points[k].Z);
+	}
+
+	// 2^level cells on each axis
+	GLuint level = 0;
+	while ((level < POINT_MAX_LEVEL) && ((size_t) 1 << (3 * level)) * (POINT_CHUNK / POINT_CELL_RATIO) < count)
+		level++;
+	const GLuint side = 1 << level;
+	const GLfloat scaleX = (high.X > low.X) ? side / (high.X - low.X) : 0.0f;
+	const GLfloat scaleY = (high.Y > low.Y) ? side / (high.Y - low.Y) : 0.0f;
+	const GLfloat scaleZ = (high.Z > low.Z) ? side / (high.Z - low.Z) : 0.0f;
+
+	std::vector<GLuint> cells(count);
+	GLuint *cell = cells.data();
+	ParallelFor(0, count, [=](size_t begin, size_t end)
+	{
+		for (size_t k = begin; k < end; k++)
+		{
+			const GLuint x = std::min((GLuint) ((points[k].X - low.X) * scaleX), side - 1);
+			const GLuint y = std::min((GLuint) ((points[k].Y - low.Y) * scaleY), side - 1);
+			const GLuint z = std::min((GLuint) ((points[k].Z - low.Z) * scaleZ), side - 1);
+			cell[k] = SpreadBits(x) | (SpreadBits(y) << 1) | (SpreadBits(z) << 2);
+		}
+	}, 1 << 16);
+
+	std::vector<GLuint> first((size_t) 1 << (3 * level), 0);
+	for (GLuint k = 0; k < count; k++)
+		first[cell[k]]++;
+	GLuint sum = 0;
+	for (GLuint &n : first)
+	{
+		const GLuint c = n;
+		n = sum;
+		sum += c;
+	}
+
+	order.resize(count);
+	for (GLuint k = 0; k < count; k++)
+		order[first[cell[k]]++] = k;
+}
+
+/**
+ * An attribute given for the first time, the previous points are white or have the scalar 0
+ */
+void TPointCloud::AddAttribute(TPointAttribute attribute)
+{
+	const GLubyte fill = (attribute == paColor) ? 255 : 0;
+	for (TPointChunk &chunk : chunks)
+	{
+		TPointArray &array = chunk.arrays[attribute];
+		array.data.assign((size_t) chunk.count * pointStride[attribute], fill);
+		array.uploaded = 0;
+	}
+
+	if (attribute == paColor)
+		hasColors = true;
+	else
+		hasScalars = true;
+}
+
+/**
+ * Copy the points (in the order given or in the order of the arrays) at the end of the chunks
+ */
+void TPointCloud::Append(const TVector3D *points, GLuint count, const TVector4D *colors, const GLfloat *scalars,
+		const GLuint *order)
+{
+	if ((points == NULL) || (count == 0))
+		return;
+
+	if ((colors != NULL) && !hasColors)
+		AddAttribute(paColor);
+	if ((scalars != NULL) && !hasScalars)
+		AddAttribute(paScalar);
+	if ((scalars != NULL) && (pointCount == 0))
+		scalarMin = scalarMax = scalars[order ? order[0] : 0];
+
+	const bool active[paCount] = {true, hasColors, hasScalars};
+	GLuint k = 0;
+	while (k < count)
+	{
+		if (chunks.empty() || (chunks.back().count == POINT_CHUNK))
+		{
+			chunks.push_back(TPointChunk());
+			TPointChunk &chunk = chunks.back();
+			chunk.count = 0;
+			chunk.visible = false;
+			for (int a = 0; a < paCount; a++)
+			{
+				chunk.arrays[a].uploaded = 0;
+#ifdef USE_VBO
+				chunk.arrays[a].vboId = 0;
+#endif
+			}
+		}
+
+		TPointChunk &chunk = chunks.back();
+		const GLuint n = std::min(count - k, (GLuint) POINT_CHUNK - chunk.count);
+		for (int a = 0; a < paCount; a++)
+			if (active[a])
+				chunk.arrays[a].data.resize((size_t) (chunk.count + n) * pointStride[a]);
+
+		GLfloat *position = (GLfloat*) chunk.arrays[paPosition].data.data() + 3 * chunk.count;
+		GLubyte *color = hasColors ? chunk.arrays[paColor].data.data() + 4 * chunk.count : NULL;
+		GLfloat *scalar = hasScalars ? (GLfloat*) chunk.arrays[paScalar].data.data() + chunk.count : NULL;
+		if (chunk.count == 0)
+			chunk.boxMin = chunk.boxMax = points[order ? order[k] : k];
+
+		for (GLuint i = 0; i < n; i++)
+		{
+			const GLuint src = order ? order[k + i] : k + i;
+			const TVector3D &point = points[src];
+			*position++ = point.X;
+			*position++ = point.Y;
+			*position++ = point.Z;
+			chunk.boxMin.X = std::min(chunk.boxMin.X, point.X);
+			chunk.boxMin.Y = std::min(chunk.boxMin.Y, point.Y);
+			chunk.boxMin.Z = std::min(chunk.boxMin.Z, point.Z);
+			chunk.boxMax.X = std::max(chunk.boxMax.X, point.X);
+			chunk.boxMax.Y = std::max(chunk.boxMax.Y, point.Y);
+			chunk.boxMax.Z = std::max(chunk.boxMax.Z, point.Z);
+
+			if (color != NULL)
+			{
+				if (colors != NULL)
+				{
+					const TVector4D &c = colors[src];
+					*color++ = (GLubyte) (std::min(std::max(c.R, 0.0f), 1.0f) * 255.0f + 0.5f);
+					*color++ = (GLubyte) (std::min(std::max(c.G, 0.0f), 1.0f) * 255.0f + 0.5f);
+					*color++ = (GLubyte) (std::min(std::max(c.B, 0.0f), 1.0f) * 255.0f + 0.5f);
+					*color++ = (GLubyte) (std::min(std::max(c.Alpha, 0.0f), 1.0f) * 255.0f + 0.5f);
+				}
+				else
+				{
+					memset(color, 255, 4);
+					color += 4;
+				}
+			}
+			if (scalar != NULL)
+			{
+				*scalar = (scalars != NULL) ? scalars[src] : 0.0f;
+				scalarMin = std::min(scalarMin, *scalar);
+				scalarMax = std::max(scalarMax, *scalar);
+				scalar++;
+			}
+		}
+
+		chunk.count += n;
+		pointCount += n;
+		k += n;
+	}
+}
+
+/**
+ * Upload the points added since the last upload. The VBOs have the size of a full chunk,
+ * the data of a full chunk are freed once uploaded.
+ * Return true when all the attributes are in VBOs.
+ */
+bool TPointCloud::Upload(TPointChunk &chunk)
+{
+#ifdef USE_VBO
+	const bool active[paCount] = {true, hasColors, hasScalars};
+	bool ready = true;
+	for (int a = 0; a < paCount; a++)
+	{
+		TPointArray &array = chunk.arrays[a];
+		if (!active[a] || (array.uploaded == chunk.count))
+			continue;
+
+		if (array.vboId == 0)
+		{
+			initOGL();
+			array.vboId = createVBO(NULL, POINT_CHUNK * pointStride[a], GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW);
+			if (array.vboId == 0)
+			{
+				std::cout << "[WARNING] VBO array not created for PointCloud." << std::endl;
+				ready = false;
+				continue;
+			}
+		}
+
+		const GLuint stride = pointStride[a];
+		glBindBuffer(GL_ARRAY_BUFFER, array.vboId);
+		glBufferSubData(GL_ARRAY_BUFFER, (GLintptr) array.uploaded * stride, (GLsizeiptr) (chunk.count - array.uploaded) * stride,
+				array.data.data() + (size_t) array.uploaded * stride);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		array.uploaded = chunk.count;
+
+		if (chunk.count == POINT_CHUNK)
+			std::vector<GLubyte>().swap(array.data);
+	}
+	return ready;
+#else
+	(void) chunk;
+	return false;
+#endif
+}
+
+void TPointCloud::FreeChunk(TPointChunk &chunk)
+{
+	for (int a = 0; a < paCount; a++)
+	{
+		std::vector<GLubyte>().swap(chunk.arrays[a].data);
+		chunk.arrays[a].uploaded = 0;
+#ifdef USE_VBO
+		DeleteAndNullVBO(1, chunk.arrays[a].vboId);
+#endif
+	}
+	chunk.count = 0;
+}
+
+void TPointCloud::DoDisplay(TDisplayMode mode __attribute__((unused)))
+{
+	visibleChunks = 0;
+	visiblePoints = 0;
+	if (pointCount == 0)
+		return;
+
+	GLfloat mv[16], proj[16];
+	GLint viewport[4];
+	glGetFloatv(GL_MODELVIEW_MATRIX, mv);
+	glGetFloatv(GL_PROJECTION_MATRIX, proj);
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	frustum.Extract(mv, proj);
+
+	glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_POINT_BIT | GL_COLOR_BUFFER_BIT);
+	glDisable(GL_LIGHTING);
+	glColor4f(pointColor.R, pointColor.G, pointColor.B, pointColor.Alpha);
+	glPointSize(pointSize);
+	// Round splats : the border of the smooth points is cut by the alpha test
+	if (splatSize > 0.0f)
+	{
+		glEnable(GL_POINT_SMOOTH);
+		glEnable(GL_ALPHA_TEST);
+		glAlphaFunc(GL_GREATER, 0.5f);
+	}
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	// The scalar of the point is the texture coordinate of the color map
+	if (hasScalars)
+	{
+		if (colorMap == NULL)
+			colorMap = new TColorMap();
+		BindColorMap(colorMap, scalarMin, scalarMax);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	}
+	else
+		if (hasColors)
+			glEnableClientState(GL_COLOR_ARRAY);
+
+	for (TPointChunk &chunk : chunks)
+	{
+		chunk.visible = frustum.BoxVisible(chunk.boxMin, chunk.boxMax);
+		if (!chunk.visible)
+			continue;
+
+		// One point out of step when the chunk has more points than its pixels allow
+		GLuint step = 1;
+		if ((splatSize > 0.0f) || (pointDensity > 0.0f))
+		{
+			const GLfloat scale = TFrustum::PixelScale(mv, proj, viewport, chunk.boxMin, chunk.boxMax);
+			if (splatSize > 0.0f)
+				glPointSize((scale > 0.0f) ? std::min(std::max(splatSize * scale, 1.0f), POINT_MAX_SIZE) : POINT_MAX_SIZE);
+			if ((pointDensity > 0.0f) && (scale > 0.0f))
+			{
+				const GLfloat dx = chunk.boxMax.X - chunk.boxMin.X;
+				const GLfloat dy = chunk.boxMax.Y - chunk.boxMin.Y;
+				const GLfloat dz = chunk.boxMax.Z - chunk.boxMin.Z;
+				const GLfloat area = scale * scale * std::max(std::max(dx * dy, dy * dz), dx * dz) + 1.0f;
+				const GLfloat allowed = area * pointDensity;
+				if (chunk.count > allowed)
+					step = (GLuint) ceilf(chunk.count / allowed);
+			}
+		}
+		const GLuint count = (chunk.count + step - 1) / step;
+
+		visibleChunks++;
+		visiblePoints += count;
+
+#ifdef USE_VBO
+
+		if (Upload(chunk))
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, chunk.arrays[paPosition].vboId);
+			glVertexPointer(3, GL_FLOAT, step * pointStride[paPosition], (GLvoid*) 0);
+			if (hasScalars)
+			{
+				glBindBuffer(GL_ARRAY_BUFFER, chunk.arrays[paScalar].vboId);
+				glTexCoordPointer(1, GL_FLOAT, step * pointStride[paScalar], (GLvoid*) 0);
+			}
+			else
+				if (hasColors)
+				{
+					glBindBuffer(GL_ARRAY_BUFFER, chunk.arrays[paColor].vboId);
+					glColorPointer(4, GL_UNSIGNED_BYTE, step * pointStride[paColor], (GLvoid*) 0);
+				}
+			glDrawArrays(GL_POINTS, 0, count);
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+
+#else
+
+		glVertexPointer(3, GL_FLOAT, step * pointStride[paPosition], chunk.arrays[paPosition].data.data());
+		if (hasScalars)
+			glTexCoordPointer(1, GL_FLOAT, step * pointStride[paScalar], chunk.arrays[paScalar].data.data());
+		else
+			if (hasColors)
+				glColorPointer(4, GL_UNSIGNED_BYTE, step * pointStride[paColor], chunk.arrays[paColor].data.data());
+		glDrawArrays(GL_POINTS, 0, count);
+
+#endif
+	}
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	if (hasScalars)
+	{
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		colorMap->Unbind();
+	}
+	else
+		if (hasColors)
+			glDisableClientState(GL_COLOR_ARRAY);
+	glPopAttrib();
+}
+
+/**
+ * The union of the boxes of the chunks
+ */
+bool TPointCloud::GetBounds(TVector3D &boxMin, TVector3D &boxMax)
+{
+	bool found = false;
+	for (const TPointChunk &chunk : chunks)
+	{
+		if (chunk.count == 0)
+			continue;
+		if (!found)
+		{
+			boxMin = chunk.boxMin;
+			boxMax = chunk.boxMax;
+			found = true;
+		}
+		for (int i = 0; i < 3; i++)
+		{
+			boxMin.array[i] = std::min(boxMin.array[i], chunk.boxMin.array[i]);
+			boxMax.array[i] = std::max(boxMax.array[i], chunk.boxMax.array[i]);
+		}
+	}
+	return found;
+}
+
+// ********************************************************************************
+// End of file
+// ********************************************************************************
@@ -0,0 +1,143 @@
+#ifndef _POINT_CLOUD_H
+#define _POINT_CLOUD_H
+
+#include "Object3D.h"
+#include "ColorMap.h"
+#include "Frustum.h"
+#include <vector>
+
+namespace GLScene
+{
+
+// Number of points of a chunk, the chunk is culled and drawn as a whole
+#define POINT_CHUNK	(1 << 16)
+// Max size of a splat in pixels
+#define POINT_MAX_SIZE	64.0f
+
+typedef enum {
+	paPosition, paColor, paScalar, paCount
+} TPointAttribute;
+
+/**
+ * An attribute of the points of a chunk (x, y, z floats, r, g, b, a bytes or a scalar).
+ * data keeps the points of the chunk, with USE_VBO it is freed when the chunk is full
+ * and uploaded (uploaded is the number of points already in the VBO).
+ */
+typedef struct TPointArray
+{
+	public:
+		std::vector<GLubyte> data;
+		GLuint uploaded;
+#ifdef USE_VBO
+		GLuint vboId;
+#endif
+} TPointArray;
+
+typedef struct TPointChunk
+{
+	public:
+		TVector3D boxMin;  // Bounding box for the culling
+		TVector3D boxMax;
+		GLuint count;
+		bool visible;
+		TPointArray arrays[paCount];
+} TPointChunk;
+
+/**
+ * TPointCloud class
+ * A cloud of points (scans, measures, particles), with an optional color or scalar by point.
+ * Params: position (default (0,0,0))
+ * eg : SetPoints(points, count, colors);
+ *      AddPoints(points, count);
+ * The points are stored in chunks of POINT_CHUNK points with their own VBOs, the chunks
+ * outside the view are not drawn. SetPoints sorts the points along a Z-order curve so a
+ * chunk is a compact part of the cloud, AddPoints appends the points to the last chunk
+ * and only uploads the new points.
+ * Colors : the color of each point, or a scalar by point mapped by a color map on the GPU
+ * (see TColorMap), else the color given by SetColor.
+ * The points are drawn with a size in pixels (SetPointSize), or as round splats with a
+ * size in the units of the scene (SetSplatSize). SetPointDensity limits the number of
+ * points drawn for a chunk to its area on the screen (one point out of n).
+ */
+class TPointCloud: public TObject3D, public TColorMapped
+{
+	public:
+		TPointCloud(const TVector3D &pos = GLDefaultPosition);
+		virtual ~TPointCloud();
+
+		virtual bool GetBounds(TVector3D &boxMin, TVector3D &boxMax);
+
+		void SetPoints(const TVector3D *points, GLuint count);
+		void SetPoints(const TVector3D *points, GLuint count, const TVector4D *colors);
+		void SetPoints(const TVector3D *points, GLuint count, const GLfloat *scalars);
+		void AddPoints(const TVector3D *points, GLuint count);
+		void AddPoints(const TVector3D *points, GLuint count, const TVector4D *colors);
+		void AddPoints(const TVector3D *points, GLuint count, const GLfloat *scalars);
+		void Clear(void);
+
+		void SetColor(const TVector4D &color)
+		{
+			pointColor = color;
+		}
+
+		/// Size of the points in pixels (default 1)
+		void SetPointSize(GLfloat size)
+		{
+			pointSize = size;
+		}
+		/// Size of the splats in the units of the scene, 0 to draw points (default)
+		void SetSplatSize(GLfloat size)
+		{
+			splatSize = size;
+		}
+		/// Max number of points drawn by pixel of a chunk, 0 to draw all the points (default)
+		void SetPointDensity(GLfloat density)
+		{
+			pointDensity = density;
+		}
+
+		size_t GetPointCount(void)
+		{
+			return pointCount;
+		}
+
+		/// Number of chunks and points drawn during the last display
+		GLuint GetVisibleChunks(void)
+		{
+			return visibleChunks;
+		}
+		size_t GetVisiblePoints(void)
+		{
+			return visiblePoints;
+		}
+
+	protected:
+		void DoDisplay(TDisplayMode mode = dmRender);
+
+	private:
+		std::vector<TPointChunk> chunks;
+		size_t pointCount;
+		bool hasColors, hasScalars;
+		GLfloat scalarMin, scalarMax;
+
+		TVector4D pointColor;
+
+		GLfloat pointSize;
+		GLfloat splatSize;
+		GLfloat pointDensity;
+		TFrustum frustum;
+		GLuint visibleChunks;
+		size_t visiblePoints;
+
+		void Append(const TVector3D *points, GLuint count, const TVector4D *colors, const GLfloat *scalars,
+				const GLuint *order);
+		void SortPoints(const TVector3D *points, GLuint count, std::vector<GLuint> &order);
+		void AddAttribute(TPointAttribute attribute);
+		bool Upload(TPointChunk &chunk);
+		void FreeChunk(TPointChunk &chunk);
+};
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _POINT_CLOUD_H
@@ -0,0 +1,218 @@
+#include "Polyline.h"
+#include <algorithm>
+#include <cstring>
+
+TPolyline::TPolyline(GLuint capacity, GLuint traces, const TVector3D &pos) : TObject3D(pos)
+{
+	ObjectType = otPolyline;
+
+	if (capacity < 2)
+	{
+		std::cout << "[WARNING] Polyline needs at least 2 points by trace." << std::endl;
+		capacity = 2;
+	}
+	this->capacity = capacity;
+	this->traces.resize(std::max(traces, 1u));
+	ring.assign(this->traces.size() * (capacity + 1) * 3, 0.0f);
+	lineWidth = 1.0f;
+	boxEmpty = true;
+
+	for (TPolylineTrace &trace : this->traces)
+	{
+		trace.head = trace.count = trace.pending = 0;
+		trace.color = GLColor_white;
+	}
+
+	DoPosition = true;
+}
+
+TPolyline::~TPolyline()
+{
+#ifdef USE_VBO
+	DeleteAndNullVBO(1, vboId);
+#endif
+}
+
+void TPolyline::AddPoint(GLuint trace, const TVector3D &point)
+{
+	AddPoints(trace, &point, 1);
+}
+
+/**
+ * Add the points at the end of the trace, they replace the oldest points when the trace is full
+ */
+void TPolyline::AddPoints(GLuint trace, const TVector3D *points, GLuint count)
+{
+	if ((trace >= traces.size()) || (points == NULL) || (count == 0))
+		return;
+
+	TPolylineTrace &current = traces[trace];
+	GLfloat *base = &ring[(size_t) trace * (capacity + 1) * 3];
+
+	// Only the last capacity points are kept
+	if (count > capacity)
+	{
+		points += count - capacity;
+		count = capacity;
+	}
+
+	if (boxEmpty)
+	{
+		boxMin = boxMax = points[0];
+		boxEmpty = false;
+	}
+
+	for (GLuint k = 0; k < count; k++)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			boxMin.array[i] = std::min(boxMin.array[i], points[k].array[i]);
+			boxMax.array[i] = std::max(boxMax.array[i], points[k].array[i]);
+		}
+
+		GLfloat *dest = base + 3 * current.head;
+		dest[0] = points[k].X;
+		dest[1] = points[k].Y;
+		dest[2] = points[k].Z;
+		if (current.head == 0)
+			memcpy(base + 3 * capacity, dest, 3 * sizeof(GLfloat));
+		current.head = (current.head + 1) % capacity;
+	}
+	current.count = std::min(current.count + count, capacity);
+	current.pending = std::min(current.pending + count, capacity);
+}
+
+void TPolyline::Clear(GLuint trace)
+{
+	if (trace >= traces.size())
+		return;
+	traces[trace].head = traces[trace].count = traces[trace].pending = 0;
+}
+
+void TPolyline::Clear(void)
+{
+	for (GLuint t = 0; t < traces.size(); t++)
+		Clear(t);
+	boxEmpty = true;
+}
+
+void TPolyline::SetColor(const TVector4D &color)
+{
+	for (TPolylineTrace &trace : traces)
+		trace.color = color;
+}
+
+void TPolyline::SetColor(GLuint trace, const TVector4D &color)
+{
+	if (trace < traces.size())
+		traces[trace].color = color;
+}
+
+#ifdef USE_VBO
+
+/**
+ * Upload count points of the ring of the trace from the point first
+ */
+void TPolyline::Upload(GLuint trace, GLuint first, GLuint count)
+{
+	const size_t offset = ((size_t) trace * (capacity + 1) + first) * 3;
+	glBufferSubData(GL_ARRAY_BUFFER, offset * sizeof(GLfloat), (size_t) count * 3 * sizeof(GLfloat), &ring[offset]);
+}
+
+#endif
+
+void TPolyline::DoDisplay(TDisplayMode mode __attribute__((unused)))
+{
+	glPushAttrib(GL_ENABLE_BIT | GL_CURRENT_BIT | GL_LINE_BIT);
+	glDisable(GL_LIGHTING);
+	glLineWidth(lineWidth);
+	glEnableClientState(GL_VERTEX_ARRAY);
+
+#ifdef USE_VBO
+
+	if (vboId == 0)
+	{
+		initOGL();
+		vboId = createVBO(ring.data(), ring.size() * sizeof(GLfloat), GL_ARRAY_BUFFER, GL_DYNAMIC_DRAW);
+		if (vboId == 0)
+			std::cout << "[WARNING] VBO array not created for Polyline." << std::endl;
+		for (TPolylineTrace &trace : traces)
+			trace.pending = 0;
+	}
+
+	if (vboId != 0)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, vboId);
+
+		// The new points end before head, the copy of the point 0 is uploaded with them
+		for (GLuint t = 0; t < traces.size(); t++)
+		{
+			TPolylineTrace &trace = traces[t];
+			if (trace.pending == 0)
+				continue;
+			if (trace.pending <= trace.head)
+			{
+				Upload(t, trace.head - trace.pending, trace.pending);
+				if (trace.pending == trace.head)
+					Upload(t, capacity, 1);
+			}
+			else
+			{
+				Upload(t, 0, trace.head);
+				const GLuint first = capacity - (trace.pending - trace.head);
+				Upload(t, first, capacity + 1 - first);
+			}
+			trace.pending = 0;
+		}
+
+		glVertexPointer(3, GL_FLOAT, 0, (GLvoid*) 0);
+	}
+	else
+
+#endif
+	glVertexPointer(3, GL_FLOAT, 0, ring.data());
+
+	for (GLuint t = 0; t < traces.size(); t++)
+	{
+		const TPolylineTrace &trace = traces[t];
+		if (trace.count < 2)
+			continue;
+
+		glColor4f(trace.color.R, trace.color.G, trace.color.B, trace.color.Alpha);
+		const GLint base = t * (capacity + 1);
+		if ((trace.count < capacity) || (trace.head == 0))
+			glDrawArrays(GL_LINE_STRIP, base, trace.count);
+		else
+		{
+			// The oldest points up to the copy of the point 0, then the newest points
+			glDrawArrays(GL_LINE_STRIP, base + trace.head, capacity + 1 - trace.head);
+			if (trace.head > 1)
+				glDrawArrays(GL_LINE_STRIP, base, trace.head);
+		}
+	}
+
+#ifdef USE_VBO
+	if (vboId != 0)
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+#endif
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glPopAttrib();
+}
+
+/**
+ * The box of the points added since the last Clear(), the points replaced in the rings
+ * are still in the box
+ */
+bool TPolyline::GetBounds(TVector3D &boxMin, TVector3D &boxMax)
+{
+	if (boxEmpty)
+		return false;
+	boxMin = this->boxMin;
+	boxMax = this->boxMax;
+	return true;
+}
+
+// ********************************************************************************
+// End of file
+// ********************************************************************************
@@ -0,0 +1,90 @@
+#ifndef _POLYLINE_H
+#define _POLYLINE_H
+
+#include "Object3D.h"
+#include <vector>
+
+namespace GLScene
+{
+
+/**
+ * A trace of the polyline : the last points in a ring of capacity + 1 points.
+ * head is the place of the next point, the point 0 is copied at the end of the ring
+ * so the oldest part of the trace [head, capacity] ends where the newest part [0, head[
+ * begins. pending is the number of points added since the last upload.
+ */
+typedef struct TPolylineTrace
+{
+	public:
+		GLuint head;
+		GLuint count;
+		GLuint pending;
+		TVector4D color;
+} TPolylineTrace;
+
+/**
+ * TPolyline class
+ * Trajectories or time series : traces of the last capacity points.
+ * Params: capacity, the number of points kept by trace
+ * Params: traces, the number of traces (default 1)
+ * Params: position (default (0,0,0))
+ * eg : TPolyline paths(5000, 1000);
+ *      paths.AddPoint(trace, TVector3D(x, y, z));  // In the loop of the simulation
+ * All the traces are in one VBO, a trace is a ring of points so a new point replaces
+ * the oldest one. Only the points added since the last display are uploaded (one or two
+ * ranges by trace) and a trace is drawn with one or two glDrawArrays.
+ */
+class TPolyline: public TObject3D
+{
+	public:
+		TPolyline(GLuint capacity, GLuint traces = 1, const TVector3D &pos = GLDefaultPosition);
+		virtual ~TPolyline();
+
+		virtual bool GetBounds(TVector3D &boxMin, TVector3D &boxMax);
+
+		void AddPoint(GLuint trace, const TVector3D &point);
+		void AddPoints(GLuint trace, const TVector3D *points, GLuint count);
+		void Clear(GLuint trace);
+		void Clear(void);
+
+		void SetColor(const TVector4D &color);
+		void SetColor(GLuint trace, const TVector4D &color);
+		void SetLineWidth(GLfloat width)
+		{
+			lineWidth = width;
+		}
+
+		GLuint GetCapacity(void)
+		{
+			return capacity;
+		}
+		GLuint GetTraceCount(void)
+		{
+			return (GLuint) traces.size();
+		}
+		/// Number of points of the trace, at most capacity
+		GLuint GetPointCount(GLuint trace)
+		{
+			return (trace < traces.size()) ? traces[trace].count : 0;
+		}
+
+	protected:
+		void DoDisplay(TDisplayMode mode = dmRender);
+
+	private:
+		GLuint capacity;
+		std::vector<TPolylineTrace> traces;
+		std::vector<GLfloat> ring;  // The rings of the traces, capacity + 1 points by trace
+		GLfloat lineWidth;
+		TVector3D boxMin, boxMax;  // Box of the points added since the last Clear(), for GetBounds
+		bool boxEmpty;
+#ifdef USE_VBO
+		GLuint vboId = 0;
+		void Upload(GLuint trace, GLuint first, GLuint count);
+#endif
+};
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _POLYLINE_H
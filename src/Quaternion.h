@@ -0,0 +1,179 @@
+#ifndef _QUATERNION_H
+#define _QUATERNION_H
+
+#include "Vector3D.h"
+#include "Matrix4.h"
+
+namespace GLScene
+{
+
+/**
+ * TQuaternion : an unit quaternion (X, Y, Z, W) for the orientation of the objects
+ * eg : TQuaternion q = TQuaternion::FromTo(z_direction, direction);
+ *      matrix *= q.ToMatrix();
+ */
+typedef union TQuaternion
+{
+	public:
+		GLfloat array[4];
+		struct
+		{
+				GLfloat X;
+				GLfloat Y;
+				GLfloat Z;
+				GLfloat W;
+		};
+
+		/// The identity (no rotation)
+		TQuaternion()
+		{
+			X = Y = Z = 0.0f;
+			W = 1.0f;
+		}
+
+		TQuaternion(const GLfloat x, const GLfloat y, const GLfloat z, const GLfloat w)
+		{
+			X = x;
+			Y = y;
+			Z = z;
+			W = w;
+		}
+
+		/// Rotation of angle degrees around the axis
+		static TQuaternion FromAxisAngle(const TVector3D &axis, const GLfloat angle)
+		{
+			TVector3D k = axis;
+			k.Normalize();
+			if (k.IsNull())
+				return TQuaternion();
+			const GLfloat half = 0.5 * angle / RADtoDEG;
+			const GLfloat s = sin(half);
+			return TQuaternion(k.X * s, k.Y * s, k.Z * s, cos(half));
+		}
+
+		/**
+		 * The shortest rotation from the direction from to the direction to.
+		 * For opposite directions, the rotation of 180 degrees around an axis
+		 * perpendicular to from.
+		 */
+		static TQuaternion FromTo(const TVector3D &from, const TVector3D &to)
+		{
+			TVector3D f = from, t = to;
+			f.Normalize();
+			t.Normalize();
+			if (f.IsNull() || t.IsNull())
+				return TQuaternion();
+
+			const GLfloat w = 1.0f + f * t;
+			if (w < 1.0e-6)
+			{
+				TVector3D axis = (fabs(f.X) < 0.9f) ? f ^ TVector3D(1.0f, 0.0f, 0.0f) : f ^ TVector3D(0.0f, 1.0f, 0.0f);
+				axis.Normalize();
+				return TQuaternion(axis.X, axis.Y, axis.Z, 0.0f);
+			}
+			const TVector3D axis = f ^ t;
+			return TQuaternion(axis.X, axis.Y, axis.Z, w).Normalize();
+		}
+
+		inline GLfloat Dot(const TQuaternion &q) const
+		{
+			return X * q.X + Y * q.Y + Z * q.Z + W * q.W;
+		}
+
+		inline TQuaternion& Normalize()
+		{
+			const GLfloat norm = Dot(*this);
+			if (norm < Epsilon)
+				*this = TQuaternion();
+			else
+			{
+				const GLfloat inv = 1.0f / sqrtf(norm);
+				X *= inv;
+				Y *= inv;
+				Z *= inv;
+				W *= inv;
+			}
+			return *this;
+		}
+
+		/// The inverse rotation
+		inline TQuaternion Conjugate(void) const
+		{
+			return TQuaternion(-X, -Y, -Z, W);
+		}
+
+		/// The rotation q then this rotation
+		inline TQuaternion operator *(const TQuaternion &q) const
+		{
+			return TQuaternion(W * q.X + X * q.W + Y * q.Z - Z * q.Y,
+					W * q.Y - X * q.Z + Y * q.W + Z * q.X,
+					W * q.Z + X * q.Y - Y * q.X + Z * q.W,
+					W * q.W - X * q.X - Y * q.Y - Z * q.Z);
+		}
+
+		/// The vector v rotated
+		inline TVector3D Rotate(const TVector3D &v) const
+		{
+			// v + 2 w (u ^ v) + 2 u ^ (u ^ v) with u = (X, Y, Z)
+			const TVector3D u(X, Y, Z);
+			const TVector3D t = (u ^ v) * 2.0f;
+			return v + t * W + (u ^ t);
+		}
+
+		/// The rotation matrix (like glRotate)
+		inline TMatrix4 ToMatrix(void) const
+		{
+			TMatrix4 m;
+			m[0] = 1.0f - 2.0f * (Y * Y + Z * Z);
+			m[1] = 2.0f * (X * Y + Z * W);
+			m[2] = 2.0f * (X * Z - Y * W);
+			m[4] = 2.0f * (X * Y - Z * W);
+			m[5] = 1.0f - 2.0f * (X * X + Z * Z);
+			m[6] = 2.0f * (Y * Z + X * W);
+			m[8] = 2.0f * (X * Z + Y * W);
+			m[9] = 2.0f * (Y * Z - X * W);
+			m[10] = 1.0f - 2.0f * (X * X + Y * Y);
+			return m;
+		}
+
+		/// Is the identity
+		inline bool IsIdentity(void) const
+		{
+			return (fabs(X) + fabs(Y) + fabs(Z)) < Epsilon;
+		}
+
+		/**
+		 * Spherical interpolation from a (t = 0) to b (t = 1) by the shortest way
+		 */
+		static TQuaternion Slerp(const TQuaternion &a, const TQuaternion &b, const GLfloat t)
+		{
+			TQuaternion c = b;
+			GLfloat cosine = a.Dot(b);
+			if (cosine < 0.0f)
+			{
+				c = TQuaternion(-b.X, -b.Y, -b.Z, -b.W);
+				cosine = -cosine;
+			}
+
+			GLfloat ka, kc;
+			if (cosine > 0.9995f)
+			{
+				// Near, linear interpolation
+				ka = 1.0f - t;
+				kc = t;
+			}
+			else
+			{
+				const GLfloat theta = acos(cosine);
+				const GLfloat inv = 1.0f / sin(theta);
+				ka = sin((1.0f - t) * theta) * inv;
+				kc = sin(t * theta) * inv;
+			}
+			return TQuaternion(ka * a.X + kc * c.X, ka * a.Y + kc * c.Y, ka * a.Z + kc * c.Z, ka * a.W + kc * c.W).Normalize();
+		}
+} TQuaternion;
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _QUATERNION_H
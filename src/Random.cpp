@@ -0,0 +1,103 @@
+#include "Random.h"
+#include "Parallel.h"
+
+// Size of the blocks of RandomPositions and RandomColors, each block has its generator
+#define RANDOM_BLOCK	4096
+
+/**
+ * SplitMix64 : spreads a seed on 64 bits, used to initialize the state
+ */
+static inline uint64_t SplitMix64(uint64_t &x)
+{
+	uint64_t z = (x += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/**
+ * The state from the seed and the stream : two streams of the same seed give
+ * independent sequences
+ */
+void TRandom::Seed(uint64_t seed, uint64_t stream)
+{
+	uint64_t x = seed;
+	if (stream != 0)
+	{
+		uint64_t s = stream;
+		x ^= SplitMix64(s);
+	}
+	for (int i = 0; i < 4; i++)
+		state[i] = SplitMix64(x);
+}
+
+/**
+ * Advance the generator of 2^128 numbers
+ */
+void TRandom::Jump(void)
+{
+	static const uint64_t jump[4] = {0x180EC6D33CFD0ABAULL, 0xD5A61266F0C9392CULL, 0xA9582618E03FC9AAULL,
+			0x39ABDC4529B1661CULL};
+
+	uint64_t s[4] = {0, 0, 0, 0};
+	for (int i = 0; i < 4; i++)
+	{
+		for (int b = 0; b < 64; b++)
+		{
+			if (jump[i] & (1ULL << b))
+			{
+				for (int k = 0; k < 4; k++)
+					s[k] ^= state[k];
+			}
+			Next();
+		}
+	}
+	for (int k = 0; k < 4; k++)
+		state[k] = s[k];
+}
+
+/**
+ * A generator for the next 2^128 numbers of this generator, this generator jumps after them
+ */
+TRandom TRandom::Split(void)
+{
+	TRandom result = *this;
+	Jump();
+	return result;
+}
+
+void GLScene::RandomPositions(TVector3D *points, size_t count, const TVector3D &boxMin, const TVector3D &boxMax,
+		uint64_t seed)
+{
+	const size_t blocks = (count + RANDOM_BLOCK - 1) / RANDOM_BLOCK;
+	ParallelFor(0, blocks, [=](size_t begin, size_t end)
+	{
+		for (size_t b = begin; b < end; b++)
+		{
+			TRandom random(seed, b + 1);
+			const size_t last = (b + 1) * RANDOM_BLOCK < count ? (b + 1) * RANDOM_BLOCK : count;
+			for (size_t k = b * RANDOM_BLOCK; k < last; k++)
+				points[k] = TVector3D(random.Uniform(boxMin.X, boxMax.X), random.Uniform(boxMin.Y, boxMax.Y),
+						random.Uniform(boxMin.Z, boxMax.Z));
+		}
+	});
+}
+
+void GLScene::RandomColors(TVector4D *colors, size_t count, uint64_t seed)
+{
+	const size_t blocks = (count + RANDOM_BLOCK - 1) / RANDOM_BLOCK;
+	ParallelFor(0, blocks, [=](size_t begin, size_t end)
+	{
+		for (size_t b = begin; b < end; b++)
+		{
+			TRandom random(seed, b + 1);
+			const size_t last = (b + 1) * RANDOM_BLOCK < count ? (b + 1) * RANDOM_BLOCK : count;
+			for (size_t k = b * RANDOM_BLOCK; k < last; k++)
+				colors[k] = TVector4D(random.Uniform(), random.Uniform(), random.Uniform(), 1.0f);
+		}
+	});
+}
+
+// ********************************************************************************
+// End of file
+// ********************************************************************************
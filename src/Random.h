@@ -0,0 +1,86 @@
+#ifndef _RANDOM_H
+#define _RANDOM_H
+
+#include <cstdint>
+#include "Vector3D.h"
+#include "Vector4D.h"
+
+namespace GLScene
+{
+
+/**
+ * TRandom class
+ * A fast random generator (xoshiro256**, period 2^256 - 1) seeded by SplitMix64.
+ * An instance is not shared between threads : give each thread its own generator,
+ * from Split (the next 2^128 numbers of this generator, they never overlap) or from a
+ * seed and a stream number (reproducible whatever the order of the threads).
+ * eg : TRandom random(1234);
+ *      TRandom other = random.Split();  // For an other thread
+ *      GLfloat x = random.Uniform(-1.0f, 1.0f);
+ */
+class TRandom
+{
+	public:
+		TRandom(uint64_t seed = 0x853C49E6748FEA9BULL, uint64_t stream = 0)
+		{
+			Seed(seed, stream);
+		}
+
+		void Seed(uint64_t seed, uint64_t stream = 0);
+
+		/// The next 64 bits
+		inline uint64_t Next(void)
+		{
+			const uint64_t result = Rotate(state[1] * 5, 7) * 9;
+			const uint64_t t = state[1] << 17;
+			state[2] ^= state[0];
+			state[3] ^= state[1];
+			state[1] ^= state[2];
+			state[0] ^= state[3];
+			state[2] ^= t;
+			state[3] = Rotate(state[3], 45);
+			return result;
+		}
+
+		/// A number in [0, 1[ (multiple of 2^-24, the precision of a float)
+		inline GLfloat Uniform(void)
+		{
+			return (Next() >> 40) * (1.0f / 16777216.0f);
+		}
+
+		/// A number in [min, max[
+		inline GLfloat Uniform(GLfloat min, GLfloat max)
+		{
+			return min + (max - min) * Uniform();
+		}
+
+		/// A number in [0, count[
+		inline uint32_t Integer(uint32_t count)
+		{
+			return (uint32_t) (((Next() >> 32) * count) >> 32);
+		}
+
+		void Jump(void);
+		TRandom Split(void);
+
+	private:
+		uint64_t state[4];
+
+		static inline uint64_t Rotate(const uint64_t x, int k)
+		{
+			return (x << k) | (x >> (64 - k));
+		}
+};
+
+/**
+ * Fill the arrays in parallel. The result only depends on the seed (the array is cut
+ * in blocks of fixed size, each block has its generator), not on the number of threads.
+ * Use different seeds for arrays that must not be correlated.
+ */
+void RandomPositions(TVector3D *points, size_t count, const TVector3D &boxMin, const TVector3D &boxMax, uint64_t seed);
+void RandomColors(TVector4D *colors, size_t count, uint64_t seed);
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _RANDOM_H
@@ -0,0 +1,280 @@
+#include "ScatteredSurface.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cstring>
+
+// AddPoints triangulates all the points again when it adds more than 1/SCATTERED_REBUILD_RATIO
+// of the points (an insertion costs about as much as the triangulation of 3 points on one
+// thread, more with several threads)
+#define SCATTERED_REBUILD_RATIO	4
+
+TScatteredSurface::TScatteredSurface(const TVector3D &pos) : TObject3D(pos)
+{
+	ObjectType = otScatteredSurface;
+
+	Minimum = Maximum = 0.0;
+	meshChanged = false;
+	vertexCount = 0;
+	indiceLength = 0;
+
+	useNormal = true;
+
+	material.SetColor(mfFront, msAmbient, {0.1, 0.1, 0.8, 1.0});
+	material.SetColor(mfFront, msDiffuse, GLColor_blue);
+
+	material.SetColor(mfBack, msAmbient, {0.2, 0.2, 0.2, 1.0});
+	material.SetColor(mfBack, msDiffuse, {0.8, 0.8, 0.8, 1.0});
+
+	DoPosition = true;
+}
+
+TScatteredSurface::~TScatteredSurface()
+{
+	FreeMesh();
+}
+
+/**
+ * The gradient is applied with a two colors color map
+ */
+void TScatteredSurface::SetColor(const TVector4D &begin, const TVector4D &end)
+{
+	SetColorMap(TColorMap(begin, end));
+}
+
+/**
+ * The color map is applied to the height of the vertex instead of the material
+ */
+void TScatteredSurface::ColorMapChanged(void)
+{
+	SetUseMaterial(false);
+}
+
+void TScatteredSurface::SetNormal(bool use)
+{
+	useNormal = use;
+}
+
+void TScatteredSurface::SetVertexFormat(TVertexFormat format)
+{
+	TObject3D::SetVertexFormat(format);
+	meshChanged = true;
+}
+
+/**
+ * Replace the points of the surface
+ */
+void TScatteredSurface::SetPoints(const TVector3D *points, GLuint count)
+{
+	if ((points == NULL) || (count == 0))
+	{
+		this->points.clear();
+		delaunay.Clear();
+		Minimum = Maximum = 0.0;
+		meshChanged = true;
+		return;
+	}
+
+	this->points.assign(points, points + count);
+	boxMin = boxMax = points[0];
+	GrowBox(points, count);
+
+	delaunay.Triangulate(points, count);
+	meshChanged = true;
+}
+
+/**
+ * Add the points to the box of the surface, Minimum and Maximum are the Z range of the box
+ */
+void TScatteredSurface::GrowBox(const TVector3D *points, GLuint count)
+{
+	for (GLuint k = 0; k < count; k++)
+		for (int i = 0; i < 3; i++)
+		{
+			boxMin.array[i] = std::min(boxMin.array[i], points[k].array[i]);
+			boxMax.array[i] = std::max(boxMax.array[i], points[k].array[i]);
+		}
+	Minimum = boxMin.Z;
+	Maximum = boxMax.Z;
+}
+
+void TScatteredSurface::AddPoint(const TVector3D &point)
+{
+	AddPoints(&point, 1);
+}
+
+/**
+ * Add the points to the surface. The points are inserted in the triangulation, or all
+ * the points are triangulated again if there are many new points.
+ */
+void TScatteredSurface::AddPoints(const TVector3D *points, GLuint count)
+{
+	if ((points == NULL) || (count == 0))
+		return;
+
+	if (this->points.empty())
+	{
+		SetPoints(points, count);
+		return;
+	}
+
+	const GLuint first = (GLuint) this->points.size();
+	this->points.insert(this->points.end(), points, points + count);
+	GrowBox(points, count);
+	meshChanged = true;
+
+	bool rebuild = ((uint64_t) count * SCATTERED_REBUILD_RATIO > first);
+	for (GLuint k = 0; (k < count) && !rebuild; k++)
+		rebuild = !delaunay.Insert(points[k]);
+	if (rebuild)
+		delaunay.Triangulate(this->points.data(), (GLuint) this->points.size());
+}
+
+/**
+ * The vertices with the normals (mean of the normals of the triangles weighted by
+ * their area) and the triangles
+ */
+void TScatteredSurface::BuildMesh(void)
+{
+	FreeMesh();
+	meshChanged = false;
+
+	std::vector<GLuint> triangles;
+	delaunay.GetTriangles(triangles, points.data());
+	if (triangles.empty())
+		return;
+
+	vertexCount = (GLuint) points.size();
+	indiceLength = (GLuint) triangles.size();
+	const GLuint triangleCount = indiceLength / 3;
+
+	std::vector<TVector3D> faceNormals(triangleCount);
+	const TVector3D *point = points.data();
+	const GLuint *triangle = triangles.data();
+	ParallelFor(0, triangleCount, [point, triangle, &faceNormals](size_t begin, size_t end)
+	{
+		for (size_t t = begin; t < end; t++)
+		{
+			const TVector3D &a = point[triangle[3 * t]];
+			const TVector3D &b = point[triangle[3 * t + 1]];
+			const TVector3D &c = point[triangle[3 * t + 2]];
+			faceNormals[t] = TVector3D(b.X - a.X, b.Y - a.Y, b.Z - a.Z) ^ TVector3D(c.X - a.X, c.Y - a.Y, c.Z - a.Z);
+		}
+	}, 1 << 14);
+
+	std::vector<TVector3D> normals(vertexCount, TVector3D(0.0f, 0.0f, 0.0f));
+	for (GLuint t = 0; t < triangleCount; t++)
+		for (int k = 0; k < 3; k++)
+			normals[triangle[3 * t + k]] += faceNormals[t];
+
+	vertices = new TVertex[vertexCount];
+	TVertex *vertex = vertices;
+	ParallelFor(0, vertexCount, [point, vertex, &normals](size_t begin, size_t end)
+	{
+		for (size_t k = begin; k < end; k++)
+		{
+			TVector3D &norm = normals[k];
+			if (!norm.IsNull())
+				norm.Normalize();
+			vertex[k].SetVertice(point[k].X, point[k].Y, point[k].Z);
+			vertex[k].SetNormal(norm.X, norm.Y, norm.Z);
+		}
+	}, 1 << 14);
+
+	indices = new GLuint[indiceLength];
+	memcpy(indices, triangle, SIZE_UINT(indiceLength));
+
+#ifdef USE_VBO
+	initOGL();
+	vboId = createVertexVBO(vertices, vertexCount, vertexFormat);
+	iboId = createVBO(indices, SIZE_UINT(indiceLength), GL_ELEMENT_ARRAY_BUFFER);
+	if ((vboId == 0) || (iboId == 0))
+		std::cout << "[WARNING] VBO array not created for ScatteredSurface." << std::endl;
+	else
+	{
+		DeleteAndNull(vertices);
+		DeleteAndNull(indices);
+	}
+#endif
+}
+
+void TScatteredSurface::FreeMesh(void)
+{
+	DeleteAndNull(vertices);
+	DeleteAndNull(indices);
+#ifdef USE_VBO
+	DeleteAndNullVBO(1, vboId);
+	DeleteAndNullVBO(1, iboId);
+#endif
+	vertexCount = 0;
+	indiceLength = 0;
+}
+
+void TScatteredSurface::DoDisplay(TDisplayMode mode __attribute__((unused)))
+{
+	if (meshChanged)
+		BuildMesh();
+	if (indiceLength == 0)
+		return;
+
+	glDisable(GL_CULL_FACE);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	if (useNormal)
+		glEnableClientState(GL_NORMAL_ARRAY);
+	// The height of the vertex is the texture coordinate of the color map
+	if (colorMap != NULL)
+	{
+		BindColorMap(colorMap, Minimum, Maximum);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	}
+
+#ifdef USE_VBO
+
+	if ((vboId != 0) && (iboId != 0))
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, vboId);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboId);
+
+		setVertexPointers(vertexFormat, useNormal, colorMap != NULL);
+		glDrawElements(GL_TRIANGLES, indiceLength, GL_UNSIGNED_INT, (GLvoid*) 0);
+
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+	}
+	else
+
+#endif
+	if (vertices != NULL)
+	{
+		glVertexPointer(3, GL_FLOAT, SIZE_VERTEX(1), &vertices[0].vertice);
+		if (useNormal)
+			glNormalPointer(GL_FLOAT, SIZE_VERTEX(1), &vertices[0].normal);
+		if (colorMap != NULL)
+			glTexCoordPointer(1, GL_FLOAT, SIZE_VERTEX(1), &vertices[0].vertice.Z);
+		glDrawElements(GL_TRIANGLES, indiceLength, GL_UNSIGNED_INT, &indices[0]);
+	}
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	if (useNormal)
+		glDisableClientState(GL_NORMAL_ARRAY);
+	if (colorMap != NULL)
+	{
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		colorMap->Unbind();
+	}
+
+	glEnable(GL_CULL_FACE);
+}
+
+bool TScatteredSurface::GetBounds(TVector3D &boxMin, TVector3D &boxMax)
+{
+	if (points.empty())
+		return false;
+	boxMin = this->boxMin;
+	boxMax = this->boxMax;
+	return true;
+}
+
+// ********************************************************************************
+// End of file
+// ********************************************************************************
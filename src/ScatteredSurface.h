@@ -0,0 +1,97 @@
+#ifndef _SCATTERED_SURFACE_H
+#define _SCATTERED_SURFACE_H
+
+#include "Object3D.h"
+#include "ColorMap.h"
+#include "Delaunay.h"
+#include <vector>
+
+namespace GLScene
+{
+
+/**
+ * TScatteredSurface class
+ * A surface through scattered points (x, y, z), measures that are not on a grid.
+ * Params: position (default (0,0,0))
+ * eg : SetPoints(points, count);
+ *      AddPoint(TVector3D(x, y, z));
+ * The points (x, y) are triangulated with a Delaunay triangulation (see TDelaunay), the
+ * points at the same (x, y) as a previous point are ignored. AddPoint inserts the point
+ * in the triangulation, AddPoints triangulates all the points again when it adds many points.
+ * The mesh (vertices, normals and triangles) is built again at the next display after
+ * the points changed.
+ * Colors : SetColor for a gradient or SetColorMap, applied on the GPU to the height of
+ * the vertex (see TColorMap).
+ */
+class TScatteredSurface: public TObject3D, public TColorMapped
+{
+	public:
+		TScatteredSurface(const TVector3D &pos = GLDefaultPosition);
+		virtual ~TScatteredSurface();
+
+		virtual bool GetBounds(TVector3D &boxMin, TVector3D &boxMax);
+
+		void SetPoints(const TVector3D *points, GLuint count);
+		void SetPoints(const std::vector<TVector3D> &points)
+		{
+			SetPoints(points.data(), (GLuint) points.size());
+		}
+		void AddPoint(const TVector3D &point);
+		void AddPoints(const TVector3D *points, GLuint count);
+
+		void SetColor(const TVector4D &begin, const TVector4D &end);
+		void SetNormal(bool use);
+		virtual void SetVertexFormat(TVertexFormat format);
+
+		/// Number of points of the surface, without the duplicates and the NaN or infinite points
+		GLuint GetPointCount(void)
+		{
+			return delaunay.GetPointCount() - delaunay.GetDuplicateCount() - delaunay.GetRejectedCount();
+		}
+
+		/// Number of triangles of the last mesh drawn
+		GLuint GetTriangleCount(void)
+		{
+			return indiceLength / 3;
+		}
+
+		double getMinimum(void)
+		{
+			return Minimum;
+		}
+		double getMaximum(void)
+		{
+			return Maximum;
+		}
+
+	protected:
+		void DoDisplay(TDisplayMode mode = dmRender);
+		void ColorMapChanged(void);
+
+	private:
+		std::vector<TVector3D> points;
+		TDelaunay delaunay;
+		double Minimum, Maximum;
+		TVector3D boxMin, boxMax;  // Box of the points
+		bool meshChanged;
+
+		TVertex *vertices = NULL;
+		GLuint *indices = NULL;
+		GLuint vertexCount;
+		GLuint indiceLength;
+#ifdef USE_VBO
+		GLuint vboId = 0;  // ID of VBO for vertex and normal interleaved arrays
+		GLuint iboId = 0;  // ID of VBO for index array
+#endif
+
+		bool useNormal;
+
+		void BuildMesh(void);
+		void FreeMesh(void);
+		void GrowBox(const TVector3D *points, GLuint count);
+};
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _SCATTERED_SURFACE_H
@@ -0,0 +1,108 @@
+#include "Shader.h"
+
+#ifdef USE_VBO
+
+using namespace GLScene;
+
+TShader::TShader()
+{
+	program = 0;
+}
+
+TShader::~TShader()
+{
+	if (program != 0)
+		glDeleteProgram(program);
+}
+
+GLuint TShader::Compile(GLenum type, const char *source)
+{
+	GLuint shader = glCreateShader(type);
+	glShaderSource(shader, 1, &source, NULL);
+	glCompileShader(shader);
+
+	GLint status = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &status);
+	if (status != GL_TRUE)
+	{
+		GLchar info[1024] = {0};
+		glGetShaderInfoLog(shader, sizeof(info), NULL, info);
+		log += ((type == GL_VERTEX_SHADER) ? "Vertex shader: " : "Fragment shader: ");
+		log += info;
+		glDeleteShader(shader);
+		return 0;
+	}
+	return shader;
+}
+
+/**
+ * Compile and link the program. Return false if it fails.
+ */
+bool TShader::Create(const char *vertexSource, const char *fragmentSource)
+{
+	initOGL();
+	if (program != 0)
+		glDeleteProgram(program);
+	program = 0;
+	uniforms.clear();
+	log.clear();
+
+	GLuint vertex = Compile(GL_VERTEX_SHADER, vertexSource);
+	GLuint fragment = Compile(GL_FRAGMENT_SHADER, fragmentSource);
+	if ((vertex != 0) && (fragment != 0))
+	{
+		program = glCreateProgram();
+		glAttachShader(program, vertex);
+		glAttachShader(program, fragment);
+		glLinkProgram(program);
+
+		GLint status = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &status);
+		if (status != GL_TRUE)
+		{
+			GLchar info[1024] = {0};
+			glGetProgramInfoLog(program, sizeof(info), NULL, info);
+			log += "Link: ";
+			log += info;
+			glDeleteProgram(program);
+			program = 0;
+		}
+	}
+
+	// The program keeps the shaders
+	if (vertex != 0)
+		glDeleteShader(vertex);
+	if (fragment != 0)
+		glDeleteShader(fragment);
+	return (program != 0);
+}
+
+void TShader::Use(void)
+{
+	glUseProgram(program);
+}
+
+void TShader::Unuse(void)
+{
+	glUseProgram(0);
+}
+
+/**
+ * Location of the uniform, -1 if not found. The locations are cached.
+ */
+GLint TShader::Uniform(const char *name)
+{
+	std::map<std::string, GLint>::iterator it = uniforms.find(name);
+	if (it != uniforms.end())
+		return it->second;
+
+	GLint location = glGetUniformLocation(program, name);
+	uniforms[name] = location;
+	return location;
+}
+
+#endif // USE_VBO
+
+// ********************************************************************************
+// End of file
+// ********************************************************************************
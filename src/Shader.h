@@ -0,0 +1,53 @@
+#ifndef _SHADER_H
+#define _SHADER_H
+
+#include "Object3D.h"
+
+#ifdef USE_VBO
+
+#include <map>
+#include <string>
+
+namespace GLScene
+{
+
+/**
+ * TShader class
+ * A GLSL program made of a vertex shader and a fragment shader (OpenGL 2.0).
+ * Create compiles and links the program, if it fails GetLog give the reason.
+ */
+class TShader
+{
+	public:
+		TShader();
+		virtual ~TShader();
+
+		bool Create(const char *vertexSource, const char *fragmentSource);
+		void Use(void);
+		void Unuse(void);
+		GLint Uniform(const char *name);
+
+		inline bool IsValid(void) const
+		{
+			return (program != 0);
+		}
+
+		std::string GetLog(void)
+		{
+			return log;
+		}
+
+	private:
+		GLuint program;
+		std::string log;
+		std::map<std::string, GLint> uniforms;
+
+		GLuint Compile(GLenum type, const char *source);
+};
+
+} // namespace GLScene
+
+#endif // USE_VBO
+
+//---------------------------------------------------------------------------
+#endif // _SHADER_H
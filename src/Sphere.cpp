@@ -1,4 +1,5 @@
 #include "Sphere.h"
+#include "Tessellation.h"
 
 // Code for sphere construction inspired from :
 // AUTHOR: Song Ho Ahn (song.ahn@gmail.com)
@@ -7,6 +8,7 @@
 // Low resolution for picking
 #define stackCount_low	5
 #define sectorCount_low 10
+#define icosphereLevel_low	1
 
 TSphere::TSphere(GLfloat _radius, GLuint _sectorCount, GLuint _stackCount, const TVector3D &pos) : TObject3D(pos)
 {
@@ -14,12 +16,10 @@ TSphere::TSphere(GLfloat _radius, GLuint _sectorCount, GLuint _stackCount, const
 	radius = _radius;
 	sectorCount = _sectorCount;
 	stackCount = _stackCount;
+	icosphereLevel = 3;
 	IsSphere = true;
 
-	sphereLength = (sectorCount + 1) * (stackCount + 1);
-	indiceLength = 6 * (stackCount - 1) * sectorCount;
-	sphereLength_low = (sectorCount_low + 1) * (stackCount_low + 1);
-	indiceLength_low = 6 * (stackCount_low - 1) * sectorCount_low;
+	ComputeLength();
 	InitializeArray();
 
 	// Yellow sphere
@@ -47,6 +47,55 @@ TSphere::~TSphere()
 	FreeVBO();
 }
 
+/**
+ * An UV sphere of sectorCount x stackCount
+ */
+void TSphere::SetUVSphere(GLuint _sectorCount, GLuint _stackCount)
+{
+	icosphere = false;
+	sectorCount = _sectorCount;
+	stackCount = _stackCount;
+	ComputeLength();
+	Changed = true;
+	InitializeArray();
+}
+
+/**
+ * An icosphere of the level (see UnitIcosphere), 3 is about the quality of the default UV sphere
+ */
+void TSphere::SetIcosphere(GLuint level)
+{
+	icosphere = true;
+	icosphereLevel = (level > ICOSPHERE_LEVEL_MAX) ? ICOSPHERE_LEVEL_MAX : level;
+	ComputeLength();
+	Changed = true;
+	InitializeArray();
+}
+
+void TSphere::SetVertexFormat(TVertexFormat format)
+{
+	TObject3D::SetVertexFormat(format);
+	InitializeArray();
+}
+
+void TSphere::ComputeLength(void)
+{
+	if (icosphere)
+	{
+		sphereLength = IcosphereVertexCount(icosphereLevel);
+		indiceLength = IcosphereIndexCount(icosphereLevel);
+		sphereLength_low = IcosphereVertexCount(icosphereLevel_low);
+		indiceLength_low = IcosphereIndexCount(icosphereLevel_low);
+	}
+	else
+	{
+		sphereLength = (sectorCount + 1) * (stackCount + 1);
+		indiceLength = 6 * (stackCount - 1) * sectorCount;
+		sphereLength_low = (sectorCount_low + 1) * (stackCount_low + 1);
+		indiceLength_low = 6 * (stackCount_low - 1) * sectorCount_low;
+	}
+}
+
 void TSphere::InitializeArray(void)
 {
 	// Clean array
@@ -55,21 +104,30 @@ void TSphere::InitializeArray(void)
 
 	sphere = new TVertex[sphereLength];
 	indices = new GLuint[indiceLength];
-	CreateSphere(sectorCount, stackCount, sphere, indices);
 
 	// Low resolution
 	sphere_low = new TVertex[sphereLength_low];
 	indices_low = new GLuint[indiceLength_low];
-	CreateSphere(sectorCount_low, stackCount_low, sphere_low, indices_low);
+
+	if (icosphere)
+	{
+		CreateIcosphere(icosphereLevel, sphere, indices);
+		CreateIcosphere(icosphereLevel_low, sphere_low, indices_low);
+	}
+	else
+	{
+		CreateSphere(sectorCount, stackCount, sphere, indices);
+		CreateSphere(sectorCount_low, stackCount_low, sphere_low, indices_low);
+	}
 
 #ifdef USE_VBO
 	initOGL();
-	vboId = createVBO(sphere, SIZE_VERTEX(sphereLength));
+	vboId = createVertexVBO(sphere, sphereLength, vertexFormat);
 	iboId = createVBO(indices, SIZE_UINT(indiceLength), GL_ELEMENT_ARRAY_BUFFER);
 	createVBO_OK = ((vboId != 0) && (iboId != 0));
 
 	// Low resolution
-	vboId_low = createVBO(sphere_low, SIZE_VERTEX(sphereLength_low));
+	vboId_low = createVertexVBO(sphere_low, sphereLength_low, vertexFormat);
 	iboId_low = createVBO(indices_low, SIZE_UINT(indiceLength_low), GL_ELEMENT_ARRAY_BUFFER);
 	createVBO_OK = createVBO_OK && ((vboId_low != 0) && (iboId_low != 0));
 
@@ -101,38 +159,14 @@ void TSphere::FreeVBO(void)
 
 void TSphere::CreateSphere(GLuint sectorCount, GLuint stackCount, TVertex *sph, GLuint *ind)
 {
-	float x, y, z, xy;                              // vertex position
-	float nx, ny, nz, lengthInv = 1.0f / radius;    // normal
-
-	float sectorStep = 2.0f * PI / sectorCount;
-	float stackStep = PI / stackCount;
-	float sectorAngle, stackAngle;
-
-	GLuint count = 0;
-	for (GLuint i = 0; i <= stackCount; ++i)
+	// The unit sphere is computed once (at compile time for the usual levels), we only scale it
+	const TSphereTable unit = UnitSphere(sectorCount, stackCount);
+	const GLuint length = (sectorCount + 1) * (stackCount + 1);
+	const GLfloat *point = unit.Vertex;
+	for (GLuint i = 0; i < length; i++, point += 3)
 	{
-		stackAngle = PI / 2.0f - i * stackStep;     // starting from pi/2 to -pi/2
-		xy = radius * cosf(stackAngle);             // r * cos(u)
-		z = radius * sinf(stackAngle);              // r * sin(u)
-
-		// add (sectorCount+1) vertices per stack
-		// the first and last vertices have same position and normal
-		for (GLuint j = 0; j <= sectorCount; ++j)
-		{
-			sectorAngle = j * sectorStep;           // starting from 0 to 2pi
-
-			// vertex position
-			x = xy * cosf(sectorAngle);             // r * cos(u) * cos(v)
-			y = xy * sinf(sectorAngle);             // r * cos(u) * sin(v)
-			sph[count].SetVertice(x, y, z);
-
-			// normalized vertex normal
-			nx = x * lengthInv;
-			ny = y * lengthInv;
-			nz = z * lengthInv;
-			sph[count].SetNormal(nx, ny, nz);
-			count++;
-		}
+		sph[i].SetVertice(radius * point[0], radius * point[1], radius * point[2]);
+		sph[i].SetNormal(point[0], point[1], point[2]);
 	}
 
 	// indices
@@ -140,39 +174,33 @@ void TSphere::CreateSphere(GLuint sectorCount, GLuint stackCount, TVertex *sph,
 	//  |  / |
 	//  | /  |
 	//  k2--k2+1
-	GLuint k1, k2;
-	count = 0;
-	for (GLuint i = 0; i < stackCount; ++i)
-	{
-		k1 = i * (sectorCount + 1);     // beginning of current stack
-		k2 = k1 + sectorCount + 1;      // beginning of next stack
+	memcpy(ind, unit.Index, SIZE_UINT(6 * (stackCount - 1) * sectorCount));
+}
 
-		for (GLuint j = 0; j < sectorCount; ++j, ++k1, ++k2)
-		{
-			// 2 triangles per sector excluding 1st and last stacks
-			if (i != 0) // k1---k2---k1+1
-			{
-				ind[count++] = k1;
-				ind[count++] = k2;
-				ind[count++] = k1 + 1;
-			}
-
-			if (i != (stackCount - 1)) // k1+1---k2---k2+1
-			{
-				ind[count++] = k1 + 1;
-				ind[count++] = k2;
-				ind[count++] = k2 + 1;
-			}
-		}
+void TSphere::CreateIcosphere(GLuint level, TVertex *sph, GLuint *ind)
+{
+	// The unit icosphere is computed once by level, we only scale it
+	const TSphereTable unit = UnitIcosphere(level);
+	const GLuint length = IcosphereVertexCount(level);
+	const GLfloat *point = unit.Vertex;
+	for (GLuint i = 0; i < length; i++, point += 3)
+	{
+		sph[i].SetVertice(radius * point[0], radius * point[1], radius * point[2]);
+		sph[i].SetNormal(point[0], point[1], point[2]);
 	}
+	memcpy(ind, unit.Index, SIZE_UINT(IcosphereIndexCount(level)));
 }
 
-void TSphere::DoDisplay(TDisplayMode mode)
+void TSphere::ComputeModelMatrix(void)
 {
+	TObject3D::ComputeModelMatrix();
 	// Ellipsoïd case, we scale the sphere
 	if (!IsSphere)
-		glScalef(radius3D.X, radius3D.Y, radius3D.Z);
+		modelMatrix.Scale(radius3D);
+}
 
+void TSphere::DoDisplay(TDisplayMode mode)
+{
 	// interleaved array
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_NORMAL_ARRAY);
@@ -187,7 +215,7 @@ void TSphere::DoDisplay(TDisplayMode mode)
 			glBindBuffer(GL_ARRAY_BUFFER, vboId_low);
 			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboId_low);
 
-			glInterleavedArrays(GL_N3F_V3F, SIZE_VERTEX(1), (GLvoid*) 0);
+			setVertexPointers(vertexFormat);
 			glDrawElements(GL_TRIANGLES, indiceLength_low, GL_UNSIGNED_INT, (GLvoid*) 0);
 
 			glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -212,7 +240,7 @@ void TSphere::DoDisplay(TDisplayMode mode)
 			glBindBuffer(GL_ARRAY_BUFFER, vboId);
 			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboId);
 
-			glInterleavedArrays(GL_N3F_V3F, SIZE_VERTEX(1), (GLvoid*) 0);
+			setVertexPointers(vertexFormat);
 			glDrawElements(GL_TRIANGLES, indiceLength, GL_UNSIGNED_INT, (GLvoid*) 0);
 
 			glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -232,6 +260,16 @@ void TSphere::DoDisplay(TDisplayMode mode)
 	glDisableClientState(GL_NORMAL_ARRAY);
 }
 
+/**
+ * The ellipsoid is a unit sphere scaled by the model matrix
+ */
+bool TSphere::GetBounds(TVector3D &boxMin, TVector3D &boxMax)
+{
+	boxMin = TVector3D(-radius, -radius, -radius);
+	boxMax = TVector3D(radius, radius, radius);
+	return true;
+}
+
 // ********************************************************************************
 // End of file
 // ********************************************************************************
@@ -11,6 +11,8 @@ namespace GLScene
  * Params: radius of the sphere or the 3 radius of the ellipsoïd over x, y and z
  * Params: position (default (0,0,0))
  * The sphere/ellipsoïd is centered to it's position
+ * The sphere is an UV sphere (sectors and stacks) or an icosphere (SetIcosphere) that gives
+ * the same quality with less points : level 3 has 642 points against 703 for 36 x 18.
  */
 class TSphere: public TObject3D
 {
@@ -19,10 +21,13 @@ class TSphere: public TObject3D
 		TSphere(TVector3D _radius, GLuint _sectorCount = 36, GLuint _stackCount = 18, const TVector3D &pos = GLDefaultPosition);
 		virtual ~TSphere();
 
+		virtual bool GetBounds(TVector3D &boxMin, TVector3D &boxMax);
+
 		void SetRadius(GLfloat _radius)
 		{
 			radius = _radius;
 			IsSphere = true;
+			Changed = true;
 			InitializeArray();
 		}
 
@@ -30,17 +35,30 @@ class TSphere: public TObject3D
 		{
 			radius3D = _radius;
 			IsSphere = false;
+			Changed = true;
 			InitializeArray();
 		}
 
+		void SetUVSphere(GLuint _sectorCount, GLuint _stackCount);
+		void SetIcosphere(GLuint level);
+		bool IsIcosphere(void)
+		{
+			return icosphere;
+		}
+
+		virtual void SetVertexFormat(TVertexFormat format);
+
 	protected:
 		void virtual DoDisplay(TDisplayMode mode = dmRender);
+		virtual void ComputeModelMatrix(void);
 
 	private:
 		GLfloat radius;
 		TVector3D radius3D;
 		GLuint sectorCount;     // longitude, # of slices
 		GLuint stackCount;      // latitude, # of stacks
+		bool icosphere = false;
+		GLuint icosphereLevel;  // # of divisions of the icosahedron
 		bool IsSphere;
 
 		TVertex *sphere = NULL;
@@ -63,10 +81,12 @@ class TSphere: public TObject3D
 		GLuint iboId_low = 0;  // ID of VBO for index array
 #endif
 
+		void ComputeLength(void);
 		void InitializeArray(void);
 		void FreeArray(void);
 		void FreeVBO(void);
 		void CreateSphere(GLuint sectorCount, GLuint stackCount, TVertex *sph, GLuint *ind);
+		void CreateIcosphere(GLuint level, TVertex *sph, GLuint *ind);
 };
 
 } // namespace GLScene
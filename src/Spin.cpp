@@ -1,4 +1,5 @@
 #include "Spin.h"
+#include "Tessellation.h"
 
 #ifdef USE_VBO
 
@@ -99,8 +100,8 @@ void TSpin::CreateSpin(void)
 	double phi = atan2(R_Arrow, (double) len2);
 	double cos_phi = cos(phi);
 	double sin_phi = sin(phi);
-	double dtheta = (2.0 * PI / ArrowDetail);
-	double theta = 0.0;
+	// The unit circles are computed once (at compile time for the usual levels)
+	TCircleTable circle = UnitCircle(ArrowDetail);
 
 	// Arrow
 	arrow[0].SetVertice(0.0f, 0.0f, len2);
@@ -108,8 +109,8 @@ void TSpin::CreateSpin(void)
 
 	for (GLuint i = 1; i < ArrowSize; ++i)
 	{
-		const double cos_theta = cos(theta);
-		const double sin_theta = sin(theta);
+		const double cos_theta = circle.Cos[i - 1];
+		const double sin_theta = circle.Sin[i - 1];
 		const float x = (float) (R_Arrow * cos_theta);
 		const float y = (float) (R_Arrow * sin_theta);
 
@@ -121,18 +122,15 @@ void TSpin::CreateSpin(void)
 
 		arrow[arrowLength - i].SetVertice(x, y, 0.0f);
 		arrow[arrowLength - i].SetNormal(0.0f, 0.0f, -1.0f);
-
-		theta += dtheta;
 	}
 
 	// Body + base
-	dtheta = (2.0 * PI / CylinderDetail);
-	theta = 0.0;
+	circle = UnitCircle(CylinderDetail);
 
 	for (GLuint i = 0; i < baseLength; ++i)
 	{
-		const double cos_theta = cos(theta);
-		const double sin_theta = sin(theta);
+		const double cos_theta = circle.Cos[i];
+		const double sin_theta = circle.Sin[i];
 		const float x = (float) (radius * cos_theta);
 		const float y = (float) (radius * sin_theta);
 
@@ -148,16 +146,11 @@ void TSpin::CreateSpin(void)
 
 		base[baseLength - 1 - i].SetVertice(x, y, -len2);
 		base[baseLength - 1 - i].SetNormal(0.0f, 0.0f, -1.0f);
-
-		theta += dtheta;
 	}
 }
 
 void TSpin::DoDisplay(TDisplayMode mode __attribute__((unused)))
 {
-	glTranslated(position.X, position.Y, position.Z);
-	glRotated(angle, axe_angle.X, axe_angle.Y, axe_angle.Z);
-
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_NORMAL_ARRAY);
 
@@ -205,6 +198,17 @@ void TSpin::DoDisplay(TDisplayMode mode __attribute__((unused)))
 	glDisableClientState(GL_NORMAL_ARRAY);
 }
 
+/**
+ * The arrow of the spin is 4 times larger than the cylinder
+ */
+bool TSpin::GetBounds(TVector3D &boxMin, TVector3D &boxMax)
+{
+	const GLfloat r = radius * 4.0;
+	boxMin = TVector3D(-r, -r, -len2);
+	boxMax = TVector3D(r, r, len2);
+	return true;
+}
+
 // ********************************************************************************
 // End of file
 // ********************************************************************************
@@ -20,6 +20,8 @@ class TSpin: public TBaseCylinder
 		TSpin(GLfloat _len = 1.0f, GLfloat _radius = 0.03f, const TVector3D &pos = GLDefaultPosition);
 		virtual ~TSpin();
 
+		virtual bool GetBounds(TVector3D &boxMin, TVector3D &boxMax);
+
 		static bool FirstInitialization;
 
 	protected:
@@ -1,7 +1,15 @@
 #include "Surface.h"
 #include "Vector2D.h"
 #include <cstring>
+#include <charconv>
+#include <vector>
 #include "GLColor.h"
+#include "FileMapping.h"
+#include "Parallel.h"
+#include "Shader.h"
+#include "Frustum.h"
+#include "BatchMath.h"
+#include "VectorSIMD.h"
 
 #define SETMINMAX(v)	{ \
 	if ((v) > Maximum) Maximum = (v); \
@@ -27,7 +35,6 @@ TSurface::TSurface(GLuint dimX, GLuint dimY, bool useMatColor, const TVector3D &
 
 	colorBegin = GLColor_blue;
 	colorEnd = GLColor_red;
-	colorDelta = colorEnd - colorBegin;
 	colorUpdated = false;
 	useColor = !useMatColor;
 
@@ -43,7 +50,13 @@ TSurface::~TSurface()
 	FreeArray();
 #ifdef USE_VBO
 	FreeVBO();
+	if (heightTexId != 0)
+		glDeleteTextures(1, &heightTexId);
 #endif
+	ReleaseGridIndices(gridIndices);
+	delete gradientMap;
+	delete pyramid;
+	FreeLevels();
 }
 
 void TSurface::SetDimension(GLuint dimX, GLuint dimY, bool recompute)
@@ -66,85 +79,166 @@ void TSurface::SetColor(const TVector4D &begin, const TVector4D &end)
 	material.SetColor(mfFront, msAmbient, begin);
 	material.SetColor(mfFront, msDiffuse, begin);
 	colorBegin = begin;
+	ClearColorMap();
+	delete gradientMap;
+	gradientMap = NULL;
 	useColor = !(end == TVector4D(GLColor_NULL));
 	SetUseMaterial(!useColor);
 	if (useColor)
-	{
 		colorEnd = end;
-		colorDelta = colorEnd - colorBegin;
-	}
 	colorUpdated = false;
 }
 
+/**
+ * The color map is applied to the height of the vertex instead of a color array
+ */
+void TSurface::ColorMapChanged(void)
+{
+	useColor = false;
+	SetUseMaterial(false);
+	// The color array is no longer needed
+	DeleteAndNull(colors);
+#ifdef USE_VBO
+	DeleteAndNullVBO(1, cboId);
+#endif
+}
+
 void TSurface::SetNormal(bool use)
 {
 	useNormal = use;
 }
 
 /**
- * Compute the indices of the vertex in triangle that map a surface sizeX x sizeY
+ * The format only changes the normals of the VBO (GL_BYTE unless vfFloat), the positions
+ * stay in float : the coordinates of a grid are not of unit size. The VBO is built again.
+ */
+void TSurface::SetVertexFormat(TVertexFormat format)
+{
+	TObject3D::SetVertexFormat(format);
+#ifdef USE_VBO
+	if (SurfaceComputed && !useDisplacement)
+	{
+		ComputeNormals();
+		ComputeColors();
+		InitializeArray();
+	}
+#endif
+}
+
+/**
+ * Use the GPU displacement of a height texture (only with VBO).
+ * If the shader is not supported, the surface goes back to the vertex arrays.
+ */
+void TSurface::SetDisplacement(bool use)
+{
+#ifdef USE_VBO
+	if (use == useDisplacement)
+		return;
+	useDisplacement = use;
+	heightsUpdated = false;
+	if (SurfaceComputed)
+	{
+		ComputeNormals();
+		ComputeColors();
+		InitializeArray();
+	}
+#else
+	if (use)
+		std::cout << "[WARNING] GPU displacement needs VBO." << std::endl;
+#endif
+}
+
+/**
+ * Get the indices of the vertex in triangle strips that map a surface sizeX x sizeY
+ * The indices are shared with all the surfaces of the same dimensions (see IndexCache.h)
  *
- * V(sizeY-2)*(sizeX-1)         ....    V(vsizeY-1)*(sizeX-1)
- *    .
- *    .
- *    |
- * VsizeX			VsizeX+1
- * 		|          |
- * 	 V0          V1         V2  ....   VsizeX-1
- * 	 Triangle vertex coordinates are :
- * 	 (V0, V1, VsizeX), (V1, VsizeX+1, VsizeX), (V1, V2, VsizeX+1), ....
+ * V(j+1)*sizeX  V(j+1)*sizeX+1  ....
+ *    |       /     |
+ *  VjsizeX     VjsizeX+1        ....
+ * 	 Strip of the row j is : V(j+1)*sizeX, VjsizeX, V(j+1)*sizeX+1, VjsizeX+1, ...
  */
 void TSurface::ComputeIndices(void)
 {
 	sizeLength = sizeX * sizeY;
-	indiceLength = 6 * (sizeX - 1) * (sizeY - 1);
 	SurfaceComputed = false;
 
-	DeleteAndNull(indices);
-	indices = new GLuint[indiceLength];
-
-	GLuint k = 0;
-	for (GLuint j = 0; j < sizeY - 1; j++)
-	{
-		for (GLuint i = 0; i < sizeX - 1; i++)
-		{
-			indices[k++] = j * sizeX + i;
-			indices[k++] = j * sizeX + i + 1;
-			indices[k++] = (j + 1) * sizeX + i;
-			indices[k++] = j * sizeX + i + 1;
-			indices[k++] = (j + 1) * sizeX + i + 1;
-			indices[k++] = (j + 1) * sizeX + i;
-		}
-	}
+	ReleaseGridIndices(gridIndices);
+	gridIndices = AcquireGridIndices(sizeX, sizeY);
 }
 
-void TSurface::InitializeArray(void)
+/**
+ * Create the VBO. If norm is not NULL, it is used for the normals instead of the normals array.
+ */
+void TSurface::InitializeArray(const TVector3D *norm)
 {
+	HeightsChanged();
 #ifdef USE_VBO
 	initOGL();
 	FreeVBO();
+	if (useDisplacement)
+	{
+		// Only the height texture is uploaded
+		heightsUpdated = false;
+		createVBO_OK = (gridIndices->iboId != 0);
+		DeleteAndNull(normals);
+		DeleteAndNull(colors);
+		return;
+	}
+	packedNormals = (vertexFormat != vfFloat);
 	vboId = createVBO(surface, SIZE_FLOAT3D(sizeLength));
-	nboId = createVBO(normals, SIZE_FLOAT3D(sizeLength));
-	cboId = createVBO(colors, SIZE_FLOAT3D(sizeLength));
-	iboId = createVBO(indices, SIZE_UINT(indiceLength), GL_ELEMENT_ARRAY_BUFFER);
-	createVBO_OK = ((vboId != 0) && (nboId != 0) && (cboId != 0) && (iboId != 0));
+	nboId = CreateNormalVBO((norm != NULL) ? norm : normals, sizeLength);
+	// Colors are only computed for the gradient mode
+	if (colors != NULL)
+		cboId = createVBO(colors, SIZE_FLOAT3D(sizeLength));
+	createVBO_OK = ((vboId != 0) && (nboId != 0) && ((colors == NULL) || (cboId != 0)) &&
+			(gridIndices->iboId != 0));
 
 	if (!createVBO_OK)
 		std::cout << "[WARNING] VBO array not created for Surface." << std::endl;
 
-	// Now we can delete indices, normals and colors array but NOT surface !
+	// Now we can delete normals and colors array but NOT surface !
 	DeleteAndNull(normals);
 	DeleteAndNull(colors);
-	DeleteAndNull(indices);
+#else
+	if (norm != NULL)
+	{
+		DeleteAndNull(normals);
+		normals = new TVector3D[sizeLength];
+		for (GLuint i = 0; i < sizeLength; i++)
+			normals[i] = norm[i];
+	}
 #endif
 }
 
+/**
+ * The heights changed, the isolines and the pyramid of the picking must be updated
+ */
+void TSurface::HeightsChanged(void)
+{
+	if (contour != NULL)
+		contour->Invalidate();
+	if (pyramid != NULL)
+		pyramid->Invalidate();
+	FreeLevels();
+}
+
+/**
+ * Only count rows from the row first changed
+ */
+void TSurface::RowsChanged(GLuint first, GLuint count)
+{
+	if (contour != NULL)
+		contour->InvalidateRows(first, count);
+	if (pyramid != NULL)
+		pyramid->InvalidateRows(first, count);
+	FreeLevels();
+}
+
 void TSurface::FreeArray(void)
 {
 	DeleteAndNull(surface);
 	DeleteAndNull(normals);
 	DeleteAndNull(colors);
-	DeleteAndNull(indices);
 }
 
 #ifdef USE_VBO
@@ -153,7 +247,47 @@ void TSurface::FreeVBO(void)
 	DeleteAndNullVBO(1, vboId);
 	DeleteAndNullVBO(1, nboId);
 	DeleteAndNullVBO(1, cboId);
-	DeleteAndNullVBO(1, iboId);
+}
+
+/**
+ * The normals in 4 bytes each (see packNormal)
+ */
+static GLbyte* PackNormals(const TVector3D *norm, GLuint count)
+{
+	GLbyte *packed = new GLbyte[4 * count];
+	for (GLuint k = 0; k < count; k++)
+	{
+		const TGLfloat3D normal = {{norm[k].X, norm[k].Y, norm[k].Z}};
+		packNormal(normal, &packed[4 * k]);
+	}
+	return packed;
+}
+
+GLuint TSurface::CreateNormalVBO(const TVector3D *norm, GLuint count)
+{
+	if (!packedNormals)
+		return createVBO(norm, SIZE_FLOAT3D(count));
+
+	GLbyte *packed = PackNormals(norm, count);
+	const GLuint id = createVBO(packed, 4 * count);
+	delete[] packed;
+	return id;
+}
+
+/**
+ * Replace the normals from the vertex first in the normal VBO bound in GL_ARRAY_BUFFER
+ */
+void TSurface::UpdateNormalVBO(const TVector3D *norm, GLuint first, GLuint count)
+{
+	if (!packedNormals)
+	{
+		glBufferSubData(GL_ARRAY_BUFFER, SIZE_FLOAT3D(first), SIZE_FLOAT3D(count), norm);
+		return;
+	}
+
+	GLbyte *packed = PackNormals(norm, count);
+	glBufferSubData(GL_ARRAY_BUFFER, 4 * first, 4 * count, packed);
+	delete[] packed;
 }
 #endif
 
@@ -162,8 +296,18 @@ void TSurface::ComputeParameters(bool normalize)
 	reduced_pos = direction;
 	if (normalize)
 		reduced_pos.Normalize();
-	axe_angle = {-reduced_pos.Y, reduced_pos.X, 0.0};
-	angle = RADtoDEG * acos(reduced_pos.Z / sizeX);
+	orientation = TQuaternion::FromTo(z_direction, reduced_pos);
+}
+
+/**
+ * The surface is moved to its position and turned to its direction
+ */
+void TSurface::ComputeModelMatrix(void)
+{
+	TObject3D::ComputeModelMatrix();
+	modelMatrix.Translate(position);
+	if (!orientation.IsIdentity())
+		modelMatrix *= orientation.ToMatrix();
 }
 
 void TSurface::InitializeSurface(double xMin, double xMax, double yMin, double yMax)
@@ -217,115 +361,482 @@ void TSurface::InitializeSurface(double xMin, double xMax, double yMin, double y
 	}
 }
 
+// ********************************************************************************
+// Text file parser
+// ********************************************************************************
+
+// Minimal size of the part of the file parsed by a thread
+#define PARSE_MIN_RANGE	(1 << 20)
+
+/**
+ * A part of the file, always start at the beginning of a line
+ */
+typedef struct TParseRange
+{
+	public:
+		const char *begin;
+		const char *end;
+		size_t lines;       // Number of lines
+		size_t points;      // Number of not empty lines
+		size_t firstLine;   // Number of the first line (start to 1)
+		size_t firstPoint;  // Index of the first point
+		size_t errorLine;   // Line of the first error, 0 if no error
+		double zMin, zMax;
+} TParseRange;
+
+// Data separator : space or ; or tab (\r for the Windows files)
+static inline bool IsSeparator(char c)
+{
+	return (c == ' ') || (c == ';') || (c == '\t') || (c == '\r');
+}
+
+static inline const char* EndOfLine(const char *p, const char *end)
+{
+	const char *eol = (const char*) memchr(p, '\n', end - p);
+	return (eol == NULL) ? end : eol;
+}
+
+static inline bool IsEmptyLine(const char *p, const char *eol)
+{
+	while ((p < eol) && IsSeparator(*p))
+		p++;
+	return (p == eol);
+}
+
+/**
+ * Read the 3 values x, y, z of a line. Other values are ignored.
+ * std::from_chars doesn't depend of the locale.
+ */
+static bool ParseLine(const char *p, const char *eol, double data[3])
+{
+	for (int i = 0; i < 3; i++)
+	{
+		while ((p < eol) && IsSeparator(*p))
+			p++;
+		if ((p < eol) && (*p == '+'))
+			p++;
+		std::from_chars_result res = std::from_chars(p, eol, data[i]);
+		if ((res.ec != std::errc()) || ((res.ptr < eol) && !IsSeparator(*res.ptr)))
+			return false;
+		p = res.ptr;
+	}
+	return true;
+}
+
+/**
+ * Load a text file with sizeX x sizeY lines of 3 values x, y, z. The separator is
+ * space, tab or ';'. Empty lines are ignored.
+ * The file is mapped in memory and parsed by several threads in two passes:
+ * 1) count the lines of each part of the file, so we know where each part write its points
+ * 2) parse the values
+ */
 bool TSurface::LoadSurface(const char *filename)
 {
-	FILE *file = fopen(filename, "r");
-	if (file == NULL)
+	char message[256];
+	TMappedFile file;
+
+	loadError.clear();
+	if (!file.Open(filename))
+	{
+		loadError = std::string("Can not open the file ") + filename;
 		return false;
+	}
 
 	DeleteAndNull(surface);
-	surface = new TVector3D[sizeLength];
 	SurfaceComputed = false;
 	Minimum = Maximum = 0.0;
 
-	// Max line length
-	char line[128];
-	// Data separator : space or ; or tab
-	char seps[] = " ;\t\n";
-	char *token;
-	// 3 data by line : x, y, z
-	double data[3];
-	unsigned int i = 0, k = 0;
-	do
-	{
-		if (fgets(line, 128, file) == NULL)
-			continue; // EOF
-
-		token = strtok(line, seps);
-		i = 0;
-		while ((token != NULL) && (i < 3))
+	// Split the file on line boundaries
+	const char *data = file.Data();
+	const char *dataEnd = data + file.Size();
+	size_t count = file.Size() / PARSE_MIN_RANGE + 1;
+	if (count > ParallelThreadCount())
+		count = ParallelThreadCount();
+
+	std::vector<TParseRange> ranges;
+	const char *p = data;
+	for (size_t r = 0; (r < count) && (p < dataEnd); r++)
+	{
+		TParseRange range;
+		range.begin = p;
+		if (r == count - 1)
+			p = dataEnd;
+		else
+		{
+			p = data + (file.Size() * (r + 1)) / count;
+			if (p < range.begin)
+				p = range.begin;
+			p = EndOfLine(p, dataEnd);
+			if (p < dataEnd)
+				p++;
+		}
+		range.end = p;
+		range.lines = range.points = 0;
+		range.firstLine = range.firstPoint = 0;
+		range.errorLine = 0;
+		range.zMin = range.zMax = 0.0;
+		ranges.push_back(range);
+	}
+
+	// First pass : count lines and points
+	ParallelFor(0, ranges.size(), [&ranges](size_t begin, size_t end)
+	{
+		for (size_t r = begin; r < end; r++)
+		{
+			const char *p = ranges[r].begin;
+			while (p < ranges[r].end)
+			{
+				const char *eol = EndOfLine(p, ranges[r].end);
+				ranges[r].lines++;
+				if (!IsEmptyLine(p, eol))
+					ranges[r].points++;
+				p = eol + 1;
+			}
+		}
+	});
+
+	size_t points = 0;
+	size_t lines = 1;
+	for (size_t r = 0; r < ranges.size(); r++)
+	{
+		ranges[r].firstPoint = points;
+		ranges[r].firstLine = lines;
+		points += ranges[r].points;
+		lines += ranges[r].lines;
+	}
+
+	// Second pass : parse the points
+	surface = new TVector3D[sizeLength];
+	const GLuint length = sizeLength;
+	TVector3D *dest = surface;
+	ParallelFor(0, ranges.size(), [&ranges, dest, length](size_t begin, size_t end)
+	{
+		double values[3];
+		for (size_t r = begin; r < end; r++)
 		{
-			data[i++] = atof(token);
-			token = strtok(NULL, seps);
+			TParseRange &range = ranges[r];
+			size_t line = range.firstLine;
+			size_t k = range.firstPoint;
+			const char *p = range.begin;
+			while ((p < range.end) && (k < length))
+			{
+				const char *eol = EndOfLine(p, range.end);
+				if (!IsEmptyLine(p, eol))
+				{
+					if (!ParseLine(p, eol, values))
+					{
+						range.errorLine = line;
+						break;
+					}
+					if (values[2] > range.zMax) range.zMax = values[2];
+					if (values[2] < range.zMin) range.zMin = values[2];
+					dest[k++] = TVector3D(values[0], values[1], values[2]);
+				}
+				line++;
+				p = eol + 1;
+			}
 		}
+	});
 
-		if (i == 3)
+	// Report the first error
+	for (size_t r = 0; r < ranges.size(); r++)
+	{
+		if (ranges[r].errorLine != 0)
 		{
-			SETMINMAX(data[2]);
-			surface[k++] = TVector3D(data[0], data[1], data[2]);
+			snprintf(message, sizeof(message), "%s: line %lu: expected 3 numbers x y z", filename,
+					(unsigned long) ranges[r].errorLine);
+			loadError = message;
+			break;
 		}
+		if (ranges[r].zMax > Maximum) Maximum = ranges[r].zMax;
+		if (ranges[r].zMin < Minimum) Minimum = ranges[r].zMin;
+	}
 
-	} while ((!feof(file)) && (k < sizeLength));
+	if (loadError.empty() && (points != sizeLength))
+	{
+		snprintf(message, sizeof(message), "%s: %lu points read, expected sizeX*sizeY = %u*%u = %u", filename,
+				(unsigned long) points, sizeX, sizeY, sizeLength);
+		loadError = message;
+	}
 
-	// try read one more line to verify eof
-	if (fgets(line, 128, file) == NULL) {
-		; // Nothing to do
+	if (!loadError.empty())
+	{
+		DeleteAndNull(surface);
+		return false;
 	}
 
-	// Ok if eof is reached and we have sizeLength = dimX*dimY datas
-	bool success = ((feof(file)) && (k == sizeLength));
+	ComputeNormals();
+	ComputeColors();
+	InitializeArray(); // For VBO
+	SurfaceComputed = true;
+	return true;
+}
 
-	fclose(file);
+// ********************************************************************************
+// Binary file
+// ********************************************************************************
+
+/**
+ * Load a binary surface file. The dimensions of the surface are changed to
+ * the dimensions of the file. The file is mapped in memory, the heights are
+ * expanded in the surface array and the normals (if saved) are directly
+ * uploaded to the VBO.
+ */
+bool TSurface::LoadSurfaceBinary(const char *filename)
+{
+	char message[256];
+	TMappedFile file;
 
-	if (success)
+	loadError.clear();
+	if (!file.Open(filename))
 	{
-		ComputeNormals();
-		ComputeColors();
-		InitializeArray(); // For VBO
-		SurfaceComputed = true;
+		loadError = std::string("Can not open the file ") + filename;
+		return false;
+	}
+
+	// Check the header
+	const TSurfaceHeader *header = (const TSurfaceHeader*) file.Data();
+	if ((file.Size() < sizeof(TSurfaceHeader)) || (memcmp(header->magic, SURFACE_MAGIC, 4) != 0))
+	{
+		loadError = std::string(filename) + ": not a binary surface file";
+		return false;
+	}
+	if ((header->version != SURFACE_VERSION) || (header->dataType != SURFACE_FLOAT32))
+	{
+		snprintf(message, sizeof(message), "%s: unsupported version %u or data type %u", filename,
+				header->version, header->dataType);
+		loadError = message;
+		return false;
+	}
+
+	// The number of points must fit in sizeLength (GLuint) before the size is computed
+	const uint64_t points = (uint64_t) header->dimX * header->dimY;
+	if ((header->dimX < 2) || (header->dimY < 2) || (points > UINT32_MAX))
+	{
+		snprintf(message, sizeof(message), "%s: invalid dimensions %u*%u", filename, header->dimX, header->dimY);
+		loadError = message;
+		return false;
 	}
+	const size_t length = (size_t) points;
+	const bool withNormals = ((header->flags & SURFACE_NORMALS) != 0);
+	const size_t pointSize = sizeof(float) * (withNormals ? 4 : 1);
+	if ((file.Size() - sizeof(TSurfaceHeader)) / pointSize < length)
+	{
+		snprintf(message, sizeof(message), "%s: %lu bytes, expected %llu bytes for %u*%u points", filename,
+				(unsigned long) file.Size(), (unsigned long long) (sizeof(TSurfaceHeader) + points * pointSize),
+				header->dimX, header->dimY);
+		loadError = message;
+		return false;
+	}
+
+	if ((header->dimX != sizeX) || (header->dimY != sizeY))
+		SetDimension(header->dimX, header->dimY);
+
+	FreeArray();
+	SurfaceComputed = false;
+	surface = new TVector3D[sizeLength];
+
+	_xMin = header->xMin;
+	_xMax = header->xMax;
+	_yMin = header->yMin;
+	_yMax = header->yMax;
+	Minimum = header->zMin;
+	Maximum = header->zMax;
+
+	// Just a copy of the heights, no parsing
+	const float *heights = (const float*) (file.Data() + sizeof(TSurfaceHeader));
+	const double xMin = _xMin;
+	const double yMin = _yMin;
+	const double stepX = (_xMax - _xMin) / (sizeX - 1);
+	const double stepY = (_yMax - _yMin) / (sizeY - 1);
+	TVector3D *dest = surface;
+	const GLuint dimX = sizeX;
+	ParallelFor(0, sizeY, [=](size_t begin, size_t end)
+	{
+		for (size_t j = begin; j < end; j++)
+		{
+			const GLfloat y = yMin + j * stepY;
+			size_t k = j * dimX;
+			for (GLuint i = 0; i < dimX; i++, k++)
+				dest[k] = TVector3D(xMin + i * stepX, y, heights[k]);
+		}
+	});
+
+	const TVector3D *norm = NULL;
+	if (withNormals)
+		norm = (const TVector3D*) (heights + length);
 	else
-		DeleteAndNull(surface);
+		ComputeNormals();
+	ComputeColors();
+	InitializeArray(norm); // For VBO
+	SurfaceComputed = true;
+	return true;
+}
+
+/**
+ * Save the surface in a binary file to be loaded with LoadSurfaceBinary.
+ * Only the heights are saved, so the points (x, y) must be a regular grid.
+ */
+bool TSurface::SaveSurfaceBinary(const char *filename, bool withNormals)
+{
+	if (!SurfaceComputed || (surface == NULL))
+		return false;
+
+	FILE *file = fopen(filename, "wb");
+	if (file == NULL)
+		return false;
 
+	TSurfaceHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, SURFACE_MAGIC, 4);
+	header.version = SURFACE_VERSION;
+	header.dimX = sizeX;
+	header.dimY = sizeY;
+	header.xMin = surface[0].X;
+	header.xMax = surface[sizeLength - 1].X;
+	header.yMin = surface[0].Y;
+	header.yMax = surface[sizeLength - 1].Y;
+	header.zMin = Minimum;
+	header.zMax = Maximum;
+	header.dataType = SURFACE_FLOAT32;
+	header.flags = (withNormals) ? SURFACE_NORMALS : 0;
+
+	bool success = (fwrite(&header, sizeof(header), 1, file) == 1);
+
+	// Write the heights by rows
+	float *row = new float[sizeX];
+	for (GLuint j = 0; (j < sizeY) && success; j++)
+	{
+		for (GLuint i = 0; i < sizeX; i++)
+			row[i] = surface[j * sizeX + i].Z;
+		success = (fwrite(row, sizeof(float), sizeX, file) == sizeX);
+	}
+	delete[] row;
+
+	if (withNormals && success)
+	{
+		// With VBO or GPU displacement, there is no normals array
+		TVector3D *norm = normals;
+		if (normals == NULL)
+		{
+			norm = new TVector3D[sizeLength];
+			ComputeGridNormals(surface, norm, sizeX, sizeY, 0, sizeY);
+		}
+		success = (fwrite((void*) norm, SIZE_FLOAT3D(1), sizeLength, file) == sizeLength);
+		if (norm != normals)
+			delete[] norm;
+	}
+
+	fclose(file);
 	return success;
 }
 
+/**
+ * The normal of a quad is the normal of the triangle (Vk, Vk+1, Vk+sizeX).
+ * It is given to these three vertices, so each vertex get the normal of
+ * the last quad that use it.
+ */
 void TSurface::ComputeNormals(void)
 {
+	// The vertex shader computes the normals
+	if (useDisplacement)
+		return;
+
 	DeleteAndNull(normals);
 	normals = new TVector3D[sizeLength];
 
-	GLuint l = 0;
-	TVector3D norm;
-	do
+	const TVector3D *vertex = surface;
+	TVector3D *norm = normals;
+	const GLuint dimX = sizeX, dimY = sizeY;
+	ParallelFor(0, sizeY, [vertex, norm, dimX, dimY](size_t begin, size_t end)
 	{
-		norm = (surface[indices[l + 1]] - surface[indices[l]]) ^ (surface[indices[l + 2]] - surface[indices[l]]);
-		norm.Normalize();
-		normals[indices[l]] = normals[indices[l + 1]] = normals[indices[l + 2]] = norm;
-		l += 6;
-	} while (l < indiceLength);
-	// Same norm for the last vertex
-	normals[sizeLength - 1] = norm;
+		ComputeGridNormals(vertex, &norm[begin * dimX], dimX, dimY, begin, end);
+	}, GRID_MIN_ROWS(sizeX));
 }
 
-TVector3D TSurface::CreateColor(double Value)
+/**
+ * Compute the normals of the rows [rowBegin, rowEnd[ of a grid dimX x dimY.
+ * The normal of the vertex (i, j) is the normal of the cell (i, j), the last column
+ * and the last row use the normal of the previous cell.
+ * norm receives the normals of the rows from rowBegin (norm[0] is the normal of (0, rowBegin)).
+ * Each row only write its own normals so the rows can be computed in parallel.
+ */
+void TSurface::ComputeGridNormals(const TVector3D *vertex, TVector3D *norm, GLuint dimX, GLuint dimY,
+		GLuint rowBegin, GLuint rowEnd)
 {
-	double Factor = ((Value - Minimum)  / (Maximum - Minimum));
-
-	return TVector3D(colorBegin.R + (Factor * colorDelta.R),
-			colorBegin.G + (Factor * colorDelta.G),
-			colorBegin.B + (Factor *colorDelta.B));
+	// The loads take 4 floats : W is the X of the next vertex, it cancels in the differences
+	// and the cross product. The last vertex of the array is never loaded (it is never the
+	// first corner of a cell) so the loads stay in the array.
+	TVector3DA cell;
+	for (GLuint j = rowBegin; j < rowEnd; j++)
+	{
+		GLuint k = ((j < dimY - 1) ? j : dimY - 2) * dimX;
+		GLuint n = (j - rowBegin) * dimX;
+		TVector3DA corner(Float4LoadU(vertex[k].array));
+		for (GLuint i = 0; i < dimX - 1; i++, k++, n++)
+		{
+			const TVector3DA next(Float4LoadU(vertex[k + 1].array));
+			cell = (next - corner) ^ (TVector3DA(Float4LoadU(vertex[k + dimX].array)) - corner);
+			cell.Normalize();
+			norm[n] = cell.ToVector3D();
+			corner = next;
+		}
+		// Last column
+		norm[n] = cell.ToVector3D();
+	}
 }
 
 void TSurface::ComputeColors(void)
 {
 	DeleteAndNull(colors);
+	// No color array with the material or a color map
+	if (!useColor || useDisplacement)
+		return;
 	colors = new TVector3D[sizeLength];
 
+	const TVector4DA begin(colorBegin), end(colorEnd);
+	const double scale = 1.0 / (Maximum - Minimum);
 	for (GLuint i = 0; i < sizeLength; i++)
 	{
-		colors[i] = CreateColor(surface[i].Z);
-//		std::cout << colors[i].X << "\t" << colors[i].Y << "\t" << colors[i].Z << std::endl;
+		const TVector4DA color = begin.Mix(end, (surface[i].Z - Minimum) * scale);
+		colors[i] = TVector3D(color.R, color.G, color.B);
 	}
 	colorUpdated = true;
 }
 
-void TSurface::DoDisplay(TDisplayMode mode __attribute__((unused)))
+/**
+ * The gradient of SetColor is drawn with a two colors color map when the color array
+ * does not follow the vertex (displacement, levels of detail)
+ */
+bool TSurface::UseGradientMap(void)
+{
+	return useDisplacement || useLOD;
+}
+
+/**
+ * The color map to bind : the one of SetColorMap, or the gradient in a color map.
+ * NULL for the color array or the material.
+ */
+TColorMap* TSurface::DisplayedColorMap(void)
+{
+	if (colorMap != NULL)
+		return colorMap;
+	if (!useColor || !UseGradientMap())
+		return NULL;
+	if (gradientMap == NULL)
+		gradientMap = new TColorMap(colorBegin, colorEnd);
+	return gradientMap;
+}
+
+void TSurface::DoDisplay(TDisplayMode mode)
 {
 	if (!SurfaceComputed)
 		return;
 
-	if (useColor)
+	TColorMap *map = DisplayedColorMap();
+	const bool vertexColor = useColor && (map == NULL);
+
+	if (vertexColor)
 	{
 		if (!colorUpdated)
 		{
@@ -333,70 +844,623 @@ void TSurface::DoDisplay(TDisplayMode mode __attribute__((unused)))
 #ifdef USE_VBO
 			if (createVBO_OK)
 			{
-				updateVBO(cboId, colors, SIZE_FLOAT3D(sizeLength));
+				if (cboId == 0)
+					cboId = createVBO(colors, SIZE_FLOAT3D(sizeLength));
+				else
+					updateVBO(cboId, colors, SIZE_FLOAT3D(sizeLength));
 				DeleteAndNull(colors);
 			}
 #endif
 		}
 	}
 
-	glTranslated(position.X, position.Y, position.Z);
-	if (!axe_angle.IsNull())
-		glRotated(angle, axe_angle.X, axe_angle.Y, axe_angle.Z);
-
 	glDisable(GL_CULL_FACE);
 
+#ifdef USE_VBO
+	if (useDisplacement)
+	{
+		if (DisplayDisplacement(mode))
+		{
+			if ((contour != NULL) && (mode == dmRender))
+				contour->Display(surface, sizeX, sizeY, Minimum, Maximum);
+			return;
+		}
+		// Not supported, back to the vertex arrays
+		SetDisplacement(false);
+	}
+#endif
+
+	// The level is kept in select mode (the projection is restricted around the mouse)
+	if (!useLOD)
+		lodLevel = 0;
+	else
+		if (mode == dmRender)
+			lodLevel = SelectLevel();
+
+	const TGridIndices *indices = gridIndices;
+#ifdef USE_VBO
+	GLuint vertexBuffer = vboId;
+	GLuint normalBuffer = nboId;
+#else
+	const TVector3D *vertexArray = surface;
+	const TVector3D *normalArray = normals;
+#endif
+	if (lodLevel > 0)
+	{
+		const TSurfaceLevel &level = lodLevels[lodLevel - 1];
+		indices = level.indices;
+#ifdef USE_VBO
+		vertexBuffer = level.vboId;
+		normalBuffer = level.nboId;
+#else
+		vertexArray = level.vertices;
+		normalArray = level.normals;
+#endif
+	}
+
 	glEnableClientState(GL_VERTEX_ARRAY);
 	if (useNormal)
   	glEnableClientState(GL_NORMAL_ARRAY);
-	if (useColor)
+	if (vertexColor)
 	{
 		glEnable(GL_COLOR_MATERIAL);
 		glEnableClientState(GL_COLOR_ARRAY);
 	}
+	// The height of the vertex is the texture coordinate of the color map
+	if (map != NULL)
+	{
+		BindColorMap(map, Minimum, Maximum);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+	}
 
 #ifdef USE_VBO
 
 	if (createVBO_OK)
 	{
-		glBindBuffer(GL_ARRAY_BUFFER, vboId);
+		glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
 		glVertexPointer(3, GL_FLOAT, 0, (GLvoid*) 0);
+		if (map != NULL)
+			glTexCoordPointer(1, GL_FLOAT, sizeof(TVector3D), (GLvoid*) (2 * sizeof(GLfloat)));
 
 		if (useNormal)
 		{
-			glBindBuffer(GL_ARRAY_BUFFER, nboId);
-			glNormalPointer(GL_FLOAT, 0, (GLvoid*) 0);
+			glBindBuffer(GL_ARRAY_BUFFER, normalBuffer);
+			if (packedNormals)
+				glNormalPointer(GL_BYTE, 4 * sizeof(GLbyte), (GLvoid*) 0);
+			else
+				glNormalPointer(GL_FLOAT, 0, (GLvoid*) 0);
 		}
 
-		if(useColor)
+		if (vertexColor)
 		{
 			glBindBuffer(GL_ARRAY_BUFFER, cboId);
 			glColorPointer(3, GL_FLOAT, 0, (GLvoid*) 0);
 		}
 
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, iboId);
-		glDrawElements(GL_TRIANGLES, indiceLength, GL_UNSIGNED_INT, (GLvoid*) 0);
+		DrawGridIndices(indices);
 
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
-		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	}
 
 #else
 
-		glVertexPointer(3, GL_FLOAT, 0, &surface[0]);
+		glVertexPointer(3, GL_FLOAT, 0, &vertexArray[0]);
 		if (useNormal)
-			glNormalPointer(GL_FLOAT, 0, &normals[0]);
-		if (useColor)
+			glNormalPointer(GL_FLOAT, 0, &normalArray[0]);
+		if (vertexColor)
 			glColorPointer(3, GL_FLOAT, 0, &colors[0]);
-		glDrawElements(GL_TRIANGLES, indiceLength, GL_UNSIGNED_INT, &indices[0]);
+		if (map != NULL)
+			glTexCoordPointer(1, GL_FLOAT, sizeof(TVector3D), &vertexArray[0].Z);
+		DrawGridIndices(indices);
 
 #endif
 
 	glDisableClientState(GL_VERTEX_ARRAY);
 	if (useNormal)
 		glDisableClientState(GL_NORMAL_ARRAY);
-	if (useColor)
+	if (vertexColor)
 		glDisableClientState(GL_COLOR_ARRAY);
+	if (map != NULL)
+	{
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		map->Unbind();
+	}
+
+	if ((contour != NULL) && (mode == dmRender))
+		contour->Display(surface, sizeX, sizeY, Minimum, Maximum);
+}
+
+/**
+ * Change the heights of the surface (dimX x dimY values in grid order).
+ * With GPU displacement, only the height texture is updated.
+ */
+void TSurface::SetHeights(const GLfloat *z)
+{
+	if (!SurfaceComputed || (surface == NULL))
+		return;
+
+	GLfloat zMin = 0.0f, zMax = 0.0f;
+	BatchRange(z, sizeLength, zMin, zMax);
+	Minimum = std::min(0.0f, zMin);
+	Maximum = std::max(0.0f, zMax);
+	for (GLuint k = 0; k < sizeLength; k++)
+		surface[k].Z = z[k];
+
+#ifdef USE_VBO
+	if (useDisplacement)
+	{
+		heightsUpdated = false;
+		return;
+	}
+#endif
+	ComputeNormals();
+	ComputeColors();
+	InitializeArray(); // For VBO
+}
+
+/**
+ * Change count rows of the surface from the row first (count x dimX values in grid order).
+ * Only the normals and the buffers of these rows are updated. The range of the heights
+ * can only grow, use SetHeights to compute it again.
+ */
+void TSurface::SetRows(GLuint first, GLuint count, const GLfloat *z)
+{
+	if (!SurfaceComputed || (surface == NULL) || (first >= sizeY))
+		return;
+
+	count = std::min(count, sizeY - first);
+	const GLuint begin = first * sizeX;
+	const GLuint length = count * sizeX;
+	GLfloat zMin = Minimum, zMax = Maximum;
+	BatchRange(z, length, zMin, zMax);
+	Minimum = std::min(Minimum, (double) zMin);
+	Maximum = std::max(Maximum, (double) zMax);
+	for (GLuint k = 0; k < length; k++)
+		surface[begin + k].Z = z[k];
+
+	RowsChanged(first, count);
+	colorUpdated = false;
+
+#ifdef USE_VBO
+	if (useDisplacement)
+	{
+		heightsUpdated = false;
+		return;
+	}
+#endif
+
+	// The normals of the previous row use the first row, the last row uses the previous one
+	const GLuint rowBegin = (first > 0) ? first - 1 : 0;
+	const GLuint rowEnd = std::min(first + count + 1, sizeY);
+
+#ifdef USE_VBO
+	if (createVBO_OK)
+	{
+		TVector3D *norm = new TVector3D[(rowEnd - rowBegin) * sizeX];
+		ComputeGridNormals(surface, norm, sizeX, sizeY, rowBegin, rowEnd);
+
+		glBindBuffer(GL_ARRAY_BUFFER, vboId);
+		glBufferSubData(GL_ARRAY_BUFFER, SIZE_FLOAT3D(begin), SIZE_FLOAT3D(length), &surface[begin]);
+		glBindBuffer(GL_ARRAY_BUFFER, nboId);
+		UpdateNormalVBO(norm, rowBegin * sizeX, (rowEnd - rowBegin) * sizeX);
+		glBindBuffer(GL_ARRAY_BUFFER, 0);
+		delete[] norm;
+	}
+#else
+	if (normals != NULL)
+		ComputeGridNormals(surface, &normals[rowBegin * sizeX], sizeX, sizeY, rowBegin, rowEnd);
+#endif
+}
+
+/**
+ * Draw the isolines of contour over the surface (NULL to remove them).
+ * The contour is not owned by the surface.
+ */
+void TSurface::SetContour(TContour *contour)
+{
+	this->contour = contour;
+	if (contour != NULL)
+		contour->Invalidate();
+}
+
+/**
+ * Draw a coarser grid when the spacing of the grid is less than pixelSize pixels on the screen.
+ * Not used with the GPU displacement.
+ */
+void TSurface::SetLOD(bool use, GLfloat pixelSize)
+{
+	useLOD = use;
+	lodPixelSize = pixelSize;
+	if (!use)
+		FreeLevels();
+}
+
+/**
+ * Each level has one point out of 2 of the previous level (the last row and column are
+ * kept), the heights are filtered with a 3 x 3 tent so the coarse levels don't alias.
+ */
+void TSurface::BuildLevels(void)
+{
+	FreeLevels();
+
+	const TVector3D *previous = surface;
+	GLuint previousX = sizeX, previousY = sizeY;
+	while ((previousX > 2) && (previousY > 2) && (lodLevels.size() < SURFACE_LOD_MAX))
+	{
+		TSurfaceLevel level;
+		level.sizeX = previousX / 2 + 1;
+		level.sizeY = previousY / 2 + 1;
+		const GLuint dimX = level.sizeX, dimY = level.sizeY;
+		TVector3D *vertex = new TVector3D[dimX * dimY];
+		TVector3D *norm = new TVector3D[dimX * dimY];
+
+		ParallelFor(0, dimY, [previous, previousX, previousY, vertex, dimX](size_t begin, size_t end)
+		{
+			for (GLuint j = begin; j < end; j++)
+			{
+				const int pj = std::min(2 * j, previousY - 1);
+				for (GLuint i = 0; i < dimX; i++)
+				{
+					const int pi = std::min(2 * i, previousX - 1);
+					GLfloat z = 0.0f, weight = 0.0f;
+					for (int b = -1; b <= 1; b++)
+					{
+						if ((pj + b < 0) || (pj + b >= (int) previousY))
+							continue;
+						for (int a = -1; a <= 1; a++)
+						{
+							if ((pi + a < 0) || (pi + a >= (int) previousX))
+								continue;
+							const GLfloat w = ((a == 0) ? 2.0f : 1.0f) * ((b == 0) ? 2.0f : 1.0f);
+							z += w * previous[(pj + b) * previousX + pi + a].Z;
+							weight += w;
+						}
+					}
+					const TVector3D &p = previous[pj * previousX + pi];
+					vertex[j * dimX + i] = TVector3D(p.X, p.Y, z / weight);
+				}
+			}
+		}, GRID_MIN_ROWS(dimX));
+
+		ParallelFor(0, dimY, [vertex, norm, dimX, dimY](size_t begin, size_t end)
+		{
+			ComputeGridNormals(vertex, &norm[begin * dimX], dimX, dimY, begin, end);
+		}, GRID_MIN_ROWS(dimX));
+
+		level.vertices = vertex;
+		level.normals = norm;
+		level.indices = AcquireGridIndices(dimX, dimY);
+#ifdef USE_VBO
+		level.vboId = createVBO(vertex, SIZE_FLOAT3D(dimX * dimY));
+		level.nboId = CreateNormalVBO(norm, dimX * dimY);
+#endif
+		lodLevels.push_back(level);
+
+		previous = vertex;
+		previousX = dimX;
+		previousY = dimY;
+	}
+
+#ifdef USE_VBO
+	// The arrays are only needed to build the next level
+	for (size_t k = 0; k < lodLevels.size(); k++)
+	{
+		TSurfaceLevel &level = lodLevels[k];
+		if ((level.vboId == 0) || (level.nboId == 0) || (level.indices->iboId == 0))
+		{
+			std::cout << "[WARNING] VBO array not created for Surface level of detail." << std::endl;
+			lodLevels.resize(k);
+			break;
+		}
+		DeleteAndNull(level.vertices);
+		DeleteAndNull(level.normals);
+	}
+#endif
+}
+
+void TSurface::FreeLevels(void)
+{
+	for (size_t k = 0; k < lodLevels.size(); k++)
+	{
+		TSurfaceLevel &level = lodLevels[k];
+		DeleteAndNull(level.vertices);
+		DeleteAndNull(level.normals);
+		ReleaseGridIndices(level.indices);
+#ifdef USE_VBO
+		DeleteAndNullVBO(1, level.vboId);
+		DeleteAndNullVBO(1, level.nboId);
+#endif
+	}
+	lodLevels.clear();
+	lodLevel = 0;
+}
+
+/**
+ * The coarsest level whose grid spacing is less than lodPixelSize pixels at the point
+ * of the surface nearest to the eye (current OpenGL matrix)
+ */
+int TSurface::SelectLevel(void)
+{
+	if (surface == NULL)
+		return 0;
+	if (lodLevels.empty())
+		BuildLevels();
+
+	GLfloat mv[16], proj[16];
+	GLint viewport[4];
+	glGetFloatv(GL_MODELVIEW_MATRIX, mv);
+	glGetFloatv(GL_PROJECTION_MATRIX, proj);
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	const TVector3D &first = surface[0];
+	const TVector3D &last = surface[sizeLength - 1];
+	const TVector3D boxMin(std::min(first.X, last.X), std::min(first.Y, last.Y), Minimum);
+	const TVector3D boxMax(std::max(first.X, last.X), std::max(first.Y, last.Y), Maximum);
+	const GLfloat scale = TFrustum::PixelScale(mv, proj, viewport, boxMin, boxMax);
+	if (scale <= 0.0f)
+		return 0;
+
+	const GLfloat step = std::max((boxMax.X - boxMin.X) / (sizeX - 1), (boxMax.Y - boxMin.Y) / (sizeY - 1));
+	int level = 0;
+	while ((level < (int) lodLevels.size()) && (step * (2 << level) * scale <= lodPixelSize))
+		level++;
+	return level;
+}
+
+/**
+ * First intersection of the ray (origin, direction), given in the coordinates of the scene,
+ * with the surface. The point of hit is in the coordinates of the surface (x, y, f(x, y)).
+ * The first call builds a min/max pyramid of the heights (see THeightPyramid), it is
+ * updated when the heights change.
+ */
+bool TSurface::RayIntersect(const TVector3D &origin, const TVector3D &direction, TSurfaceHit &hit)
+{
+	if (!SurfaceComputed || (surface == NULL))
+		return false;
+
+	// Back in the coordinates of the grid (inverse of the model matrix)
+	const TQuaternion inverse = orientation.Conjugate();
+	const TVector3D o = inverse.Rotate(origin - position);
+	const TVector3D d = inverse.Rotate(direction);
+
+	if (pyramid == NULL)
+		pyramid = new THeightPyramid();
+	return pyramid->Intersect(surface, sizeX, sizeY, o, d, hit);
+}
+
+#ifdef USE_VBO
+
+// ********************************************************************************
+// GPU displacement
+// ********************************************************************************
+
+/**
+ * The vertex is the position (i, j) in the grid. The height is read in the texture
+ * and the normal is computed with the neighbours (central differences).
+ * Lighting is the ambient and diffuse lighting of the light 0 as the fixed pipeline.
+ */
+static const char *displacementVertex =
+		"#version 120\n"
+		"uniform sampler2D heights;\n"
+		"uniform vec2 dim;\n"
+		"uniform vec2 origin;\n"
+		"uniform vec2 step;\n"
+		"uniform bool useNormal;\n"
+		"uniform bool lighting;\n"
+		"uniform bool light0;\n"
+		"uniform bool colorMaterial;\n"
+		"varying vec4 color;\n"
+		"varying float colorCoord;\n"
+		"float Height(vec2 ij)\n"
+		"{\n"
+		"	return texture2DLod(heights, (ij + 0.5) / dim, 0.0).r;\n"
+		"}\n"
+		"void main()\n"
+		"{\n"
+		"	vec2 ij = gl_Vertex.xy;\n"
+		"	vec4 vertex = vec4(origin + ij * step, Height(ij), 1.0);\n"
+		"	gl_Position = gl_ModelViewProjectionMatrix * vertex;\n"
+		"	colorCoord = (gl_TextureMatrix[0] * vec4(vertex.z, 0.0, 0.0, 1.0)).x;\n"
+		"	if (!lighting)\n"
+		"	{\n"
+		"		color = gl_Color;\n"
+		"		return;\n"
+		"	}\n"
+		"	vec3 normal = gl_Normal;\n"
+		"	if (useNormal)\n"
+		"	{\n"
+		"		vec2 next = min(ij + 1.0, dim - 1.0);\n"
+		"		vec2 prev = max(ij - 1.0, 0.0);\n"
+		"		float dzx = (Height(vec2(next.x, ij.y)) - Height(vec2(prev.x, ij.y))) / (next.x - prev.x);\n"
+		"		float dzy = (Height(vec2(ij.x, next.y)) - Height(vec2(ij.x, prev.y))) / (next.y - prev.y);\n"
+		"		normal = vec3(-dzx * step.y, -dzy * step.x, step.x * step.y);\n"
+		"	}\n"
+		"	vec3 n = normalize(gl_NormalMatrix * normal);\n"
+		"	vec4 ambient = colorMaterial ? gl_Color : gl_FrontMaterial.ambient;\n"
+		"	vec4 diffuse = colorMaterial ? gl_Color : gl_FrontMaterial.diffuse;\n"
+		"	color = gl_FrontMaterial.emission + ambient * gl_LightModel.ambient;\n"
+		"	if (light0)\n"
+		"	{\n"
+		"		vec4 eye = gl_ModelViewMatrix * vertex;\n"
+		"		vec3 l = normalize(gl_LightSource[0].position.xyz - gl_LightSource[0].position.w * eye.xyz);\n"
+		"		color += ambient * gl_LightSource[0].ambient + diffuse * gl_LightSource[0].diffuse * max(dot(n, l), 0.0);\n"
+		"	}\n"
+		"	color = clamp(vec4(color.rgb, diffuse.a), 0.0, 1.0);\n"
+		"}\n";
+
+static const char *displacementFragment =
+		"#version 120\n"
+		"uniform sampler1D colorMap;\n"
+		"uniform bool useColorMap;\n"
+		"varying vec4 color;\n"
+		"varying float colorCoord;\n"
+		"void main()\n"
+		"{\n"
+		"	gl_FragColor = useColorMap ? color * texture1D(colorMap, colorCoord) : color;\n"
+		"}\n";
+
+// Shared by all the surfaces
+static TShader *displacementShader = NULL;
+static bool displacementFailed = false;
+
+/**
+ * The displacement shader, NULL if not supported (float texture needs OpenGL 3.0)
+ */
+static TShader* DisplacementShader(void)
+{
+	if ((displacementShader != NULL) || displacementFailed)
+		return displacementShader;
+
+	int major = 0, minor = 0;
+	const char *version = (const char*) glGetString(GL_VERSION);
+	if (version != NULL)
+		sscanf(version, "%d.%d", &major, &minor);
+	displacementFailed = (major < 3);
+#if defined(_WIN32) && !defined(USE_GLEW)
+	if (glCreateShader == NULL)
+		displacementFailed = true;
+#endif
+	if (displacementFailed)
+	{
+		std::cout << "[WARNING] GPU displacement needs OpenGL 3.0." << std::endl;
+		return NULL;
+	}
+
+	displacementShader = new TShader();
+	if (!displacementShader->Create(displacementVertex, displacementFragment))
+	{
+		std::cout << "[WARNING] Displacement shader not created. " << displacementShader->GetLog() << std::endl;
+		delete displacementShader;
+		displacementShader = NULL;
+		displacementFailed = true;
+	}
+	return displacementShader;
+}
+
+/**
+ * Upload the heights in the float texture. Only glTexSubImage2D if the dimensions do not change.
+ */
+bool TSurface::UploadHeights(void)
+{
+	GLint maxSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+	if ((sizeX > (GLuint) maxSize) || (sizeY > (GLuint) maxSize))
+	{
+		std::cout << "[WARNING] Surface too large for the height texture." << std::endl;
+		return false;
+	}
+
+	std::vector<GLfloat> heights(sizeLength);
+	const TVector3D *vertex = surface;
+	GLfloat *dest = heights.data();
+	ParallelFor(0, sizeLength, [vertex, dest](size_t begin, size_t end)
+	{
+		for (size_t k = begin; k < end; k++)
+			dest[k] = vertex[k].Z;
+	}, 1 << 16);
+
+	if ((heightTexId != 0) && (heightTexX == sizeX) && (heightTexY == sizeY))
+	{
+		glBindTexture(GL_TEXTURE_2D, heightTexId);
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, sizeX, sizeY, GL_RED, GL_FLOAT, dest);
+	}
+	else
+	{
+		if (heightTexId != 0)
+			glDeleteTextures(1, &heightTexId);
+		glGenTextures(1, &heightTexId);
+		glBindTexture(GL_TEXTURE_2D, heightTexId);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, sizeX, sizeY, 0, GL_RED, GL_FLOAT, dest);
+		heightTexX = sizeX;
+		heightTexY = sizeY;
+	}
+	glBindTexture(GL_TEXTURE_2D, 0);
+	heightsUpdated = true;
+	return true;
+}
+
+/**
+ * Draw the shared grid mesh displaced by the height texture.
+ * The grid is regular : the origin and the steps are given by the first and the last vertex.
+ * Return false if the GPU displacement is not supported.
+ */
+bool TSurface::DisplayDisplacement(TDisplayMode mode)
+{
+	if (mode == dmSelect)
+	{
+		// The selection uses the fixed pipeline
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glVertexPointer(3, GL_FLOAT, 0, &surface[0]);
+		DrawGridIndices(gridIndices);
+		glDisableClientState(GL_VERTEX_ARRAY);
+		return true;
+	}
+
+	TShader *shader = DisplacementShader();
+	if (shader == NULL)
+		return false;
+	const GLuint meshId = GridMeshBuffer(gridIndices);
+	if ((meshId == 0) || (gridIndices->iboId == 0))
+		return false;
+	if (!heightsUpdated && !UploadHeights())
+		return false;
+
+	TColorMap *map = DisplayedColorMap();
+	if (map != NULL)
+		BindColorMap(map, Minimum, Maximum);
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, heightTexId);
+	glActiveTexture(GL_TEXTURE0);
+
+	const TVector3D &first = surface[0];
+	const TVector3D &last = surface[sizeLength - 1];
+	shader->Use();
+	glUniform1i(shader->Uniform("heights"), 1);
+	glUniform1i(shader->Uniform("colorMap"), 0);
+	glUniform1i(shader->Uniform("useColorMap"), map != NULL);
+	glUniform1i(shader->Uniform("useNormal"), useNormal);
+	glUniform1i(shader->Uniform("lighting"), glIsEnabled(GL_LIGHTING));
+	glUniform1i(shader->Uniform("light0"), glIsEnabled(GL_LIGHT0));
+	glUniform1i(shader->Uniform("colorMaterial"), glIsEnabled(GL_COLOR_MATERIAL));
+	glUniform2f(shader->Uniform("dim"), sizeX, sizeY);
+	glUniform2f(shader->Uniform("origin"), first.X, first.Y);
+	glUniform2f(shader->Uniform("step"), (last.X - first.X) / (sizeX - 1), (last.Y - first.Y) / (sizeY - 1));
+
+	glBindBuffer(GL_ARRAY_BUFFER, meshId);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glVertexPointer(2, GL_FLOAT, 0, (GLvoid*) 0);
+	DrawGridIndices(gridIndices);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	shader->Unuse();
+
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE0);
+	if (map != NULL)
+		map->Unbind();
+	return true;
+}
+
+#endif // USE_VBO
+
+/**
+ * The domain of the surface and the range of the heights
+ */
+bool TSurface::GetBounds(TVector3D &boxMin, TVector3D &boxMax)
+{
+	if ((surface == NULL) || !SurfaceComputed)
+		return false;
+
+	const TVector3D &first = surface[0];
+	const TVector3D &last = surface[sizeLength - 1];
+	boxMin = TVector3D(std::min(first.X, last.X), std::min(first.Y, last.Y), Minimum);
+	boxMax = TVector3D(std::max(first.X, last.X), std::max(first.Y, last.Y), Maximum);
+	return true;
 }
 
 // ********************************************************************************
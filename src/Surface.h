@@ -2,7 +2,14 @@
 #define _SURFACE_3D_H
 
 #include "Object3D.h"
+#include "IndexCache.h"
+#include "ColorMap.h"
+#include "Contour.h"
+#include "HeightPyramid.h"
 #include <functional>
+#include <string>
+#include <vector>
+#include <cstdint>
 
 namespace GLScene
 {
@@ -10,6 +17,56 @@ namespace GLScene
 // The prototype of the function z = f(x, y)
 typedef std::function<double(double x, double y)> TFunctionZ;
 
+// Minimum number of rows of a grid computed by a thread (about 64K vertices)
+#define GRID_MIN_ROWS(dimX)	((1 << 16) / (dimX) + 1)
+
+// Max number of levels of detail
+#define SURFACE_LOD_MAX	12
+
+// Binary surface file
+#define SURFACE_MAGIC	"GLSF"
+#define SURFACE_VERSION	1
+// Data type of the heights
+#define SURFACE_FLOAT32	1
+// Flags : the normals (3 floats by vertex) follow the heights
+#define SURFACE_NORMALS	1
+
+/**
+ * Header of a binary surface file (little endian), followed by the dimX x dimY heights
+ * in grid order (X first) and optionally by the dimX x dimY normals.
+ * The points (x, y) are a regular grid over [xMin, xMax] x [yMin, yMax].
+ */
+typedef struct TSurfaceHeader
+{
+	public:
+		char magic[4];      // SURFACE_MAGIC
+		uint32_t version;   // SURFACE_VERSION
+		uint32_t dimX;
+		uint32_t dimY;
+		double xMin, xMax;
+		double yMin, yMax;
+		double zMin, zMax;
+		uint32_t dataType;  // SURFACE_FLOAT32
+		uint32_t flags;     // SURFACE_NORMALS if normals are saved
+		uint32_t reserved[2];
+} TSurfaceHeader;
+
+/**
+ * A level of detail of a surface : the grid with one point out of 2^level
+ */
+typedef struct TSurfaceLevel
+{
+	public:
+		GLuint sizeX, sizeY;
+		TVector3D *vertices;
+		TVector3D *normals;
+		TGridIndices *indices;  // Shared like the indices of the surface
+#ifdef USE_VBO
+		GLuint vboId;  // ID of VBO for vertex arrays
+		GLuint nboId;  // ID of VBO for normal arrays
+#endif
+} TSurfaceLevel;
+
 /**
  * TSurface class
  * Params: dimensions of the plane dimX x dimY. This the number of points along X axis and Y axis.
@@ -19,49 +76,97 @@ typedef std::function<double(double x, double y)> TFunctionZ;
  * eg : setFunctionZ([this](double x, double y) {return x * x + y * y;});
  *      InitializeSurface(-5, 5, -5, 5);
  * 2) you load a file with (x, y, z) coordinates with dimX x dimY points
+ *    If LoadSurface fails, GetLoadError give the reason (with the line number)
+ * 3) you load a binary file (see TSurfaceHeader) with LoadSurfaceBinary. The file is
+ *    mapped in memory, nothing is parsed. A surface can be saved with SaveSurfaceBinary.
+ * Colors : SetColor for a gradient computed for each vertex, or SetColorMap for a color map
+ * (see TColorMap) applied on the GPU to the height of the vertex. With a color map, change
+ * the colors or the range (SetColorRange) does not recompute anything.
+ * GPU displacement (SetDisplacement, needs USE_VBO and OpenGL 3.0) : the heights are a float
+ * texture that displaces a flat grid mesh shared by the surfaces of same dimensions, the
+ * normals are computed by the vertex shader. Update the heights (SetHeights) is then only
+ * one texture upload. The lighting is the ambient and diffuse lighting of the light 0.
+ * Isolines : SetContour draws a TContour over the surface. SetRows changes some rows of
+ * the surface, only these rows are updated (normals, buffers and isolines).
+ * Picking : RayIntersect gives the point of the surface under a ray (see wxGLScene::PickSurface).
+ * Level of detail (SetLOD) : coarser grids (one point out of 2^level, filtered heights) are
+ * built once, the display draws the coarsest grid whose spacing on the screen is less than
+ * pixelSize pixels, so a big surface seen from far draws only a few vertices.
  */
-class TSurface: public TObject3D
+class TSurface: public TObject3D, public TColorMapped
 {
 	public:
 		TSurface(GLuint dimX, GLuint dimY, bool useMatColor = true, const TVector3D &pos = GLDefaultPosition);
 		virtual ~TSurface();
 
-		void SetDimension(GLuint dimX, GLuint dimY, bool recompute = false);
+		virtual bool GetBounds(TVector3D &boxMin, TVector3D &boxMax);
+
+		virtual void SetDimension(GLuint dimX, GLuint dimY, bool recompute = false);
 		void SetColor(const TVector4D &begin, const TVector4D &end);
 		void SetNormal(bool use);
+		virtual void SetDisplacement(bool use);
+		void SetLOD(bool use, GLfloat pixelSize = 2.0f);
+		virtual void SetVertexFormat(TVertexFormat format);
+
+		/// Level of detail drawn at the last display (0 is the full grid)
+		int GetLODLevel(void)
+		{
+			return lodLevel;
+		}
 
 		void setFunctionZ(TFunctionZ fonc)
 		{
 			FunctionZ = fonc;
 		}
-		void InitializeSurface(double xMin, double xMax, double yMin, double yMax);
+		virtual void InitializeSurface(double xMin, double xMax, double yMin, double yMax);
 		bool LoadSurface(const char *filename);
+		bool LoadSurfaceBinary(const char *filename);
+		bool SaveSurfaceBinary(const char *filename, bool withNormals = true);
+		void SetHeights(const GLfloat *z);
+		void SetRows(GLuint first, GLuint count, const GLfloat *z);
+		void SetContour(TContour *contour);
+		bool RayIntersect(const TVector3D &origin, const TVector3D &direction, TSurfaceHit &hit);
+
+		/// The reason of the last LoadSurface failure, empty if success
+		std::string GetLoadError(void)
+		{
+			return loadError;
+		}
 
 	protected:
 		void DoDisplay(TDisplayMode mode = dmRender);
 		virtual void ComputeParameters(bool normalize = true);
+		virtual void ComputeModelMatrix(void);
+		static void ComputeGridNormals(const TVector3D *vertex, TVector3D *norm, GLuint dimX, GLuint dimY,
+				GLuint rowBegin, GLuint rowEnd);
 
-	private:
 		GLuint sizeX, sizeY;
 		TVector3D *surface = NULL;
 		TVector3D *normals = NULL;
 		TVector3D *colors = NULL;
-		GLuint *indices = NULL;
+		TGridIndices *gridIndices = NULL;  // Shared between surfaces of same dimensions
 		GLuint sizeLength;
-		GLuint indiceLength;
 		bool SurfaceComputed;
 		bool useNormal;
 
 #ifdef USE_VBO
 		GLuint vboId = 0;  // ID of VBO for vertex arrays
 		GLuint nboId = 0;  // ID of VBO for normal arrays
-		GLuint cboId = 0;  // ID of VBO for normal arrays
-		GLuint iboId = 0;  // ID of VBO for index array
+		GLuint cboId = 0;  // ID of VBO for color arrays
+		bool packedNormals = false;  // The normal VBOs are in GL_BYTE (see packNormal)
 		void FreeVBO(void);
+		GLuint CreateNormalVBO(const TVector3D *norm, GLuint count);
+		void UpdateNormalVBO(const TVector3D *norm, GLuint first, GLuint count);
+
+		// GPU displacement
+		GLuint heightTexId = 0;  // ID of the height texture
+		GLuint heightTexX = 0, heightTexY = 0;
+		bool heightsUpdated = false;
+		bool UploadHeights(void);
+		bool DisplayDisplacement(TDisplayMode mode);
 #endif
+		bool useDisplacement = false;
 
-		GLfloat angle;
-		TVector3D axe_angle;
 		TVector3D reduced_pos;
 
 		TFunctionZ FunctionZ = NULL;
@@ -75,16 +180,33 @@ class TSurface: public TObject3D
 		double Maximum, Minimum;
 		TVector4D colorBegin;
 		TVector4D colorEnd;
-		TVector4D colorDelta;
 		bool colorUpdated;
 		bool useColor;
+		TColorMap *gradientMap = NULL;  // The gradient of SetColor as a color map, built at the first use
+		TContour *contour = NULL;  // Isolines drawn over the surface, not owned
+		THeightPyramid *pyramid = NULL;  // For RayIntersect, built at the first call
+
+		// Level of detail
+		bool useLOD = false;
+		GLfloat lodPixelSize = 2.0f;
+		int lodLevel = 0;
+		std::vector<TSurfaceLevel> lodLevels;  // Levels 1, 2, ... built at the first use
+		void BuildLevels(void);
+		void FreeLevels(void);
+		int SelectLevel(void);
+
+		std::string loadError;
 
-		void InitializeArray(void);
+		virtual void InitializeArray(const TVector3D *norm = NULL);
 		void ComputeIndices(void);
 		void ComputeNormals(void);
 		void ComputeColors(void);
 		void FreeArray(void);
-		TVector3D CreateColor(double Value);
+		void HeightsChanged(void);
+		void RowsChanged(GLuint first, GLuint count);
+		void ColorMapChanged(void);
+		virtual bool UseGradientMap(void);
+		TColorMap* DisplayedColorMap(void);
 };
 
 } // namespace GLScene
@@ -0,0 +1,179 @@
+#include "Tessellation.h"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <vector>
+
+/**
+ * The usual levels : the circles of the cylinders (20), of the spin (10 and 20) and of
+ * the spheres (36 and 10), the default sphere and the low resolution sphere
+ */
+static constexpr TUnitCircle<10> Circle10;
+static constexpr TUnitCircle<20> Circle20;
+static constexpr TUnitCircle<36> Circle36;
+static constexpr TUnitSphere<36, 18> Sphere36x18;
+static constexpr TUnitSphere<10, 5> Sphere10x5;
+
+TCircleTable GLScene::UnitCircle(GLuint n)
+{
+	switch (n)
+	{
+		case 10:
+			return {Circle10.Cos, Circle10.Sin};
+		case 20:
+			return {Circle20.Cos, Circle20.Sin};
+		case 36:
+			return {Circle36.Cos, Circle36.Sin};
+		default:
+			break;
+	}
+
+	// Other level, computed once. The objects can be built in parallel : the lock guards the
+	// map, the tables don't move once built (the nodes of a map are stable)
+	static std::map<GLuint, std::vector<double>> circles;
+	static std::mutex lock;
+	std::lock_guard<std::mutex> guard(lock);
+	std::vector<double> &table = circles[n];
+	if (table.empty())
+	{
+		table.resize(2 * (n + 1));
+		for (GLuint i = 0; i < n; i++)
+		{
+			table[i] = cos(2.0 * PI * i / n);
+			table[n + 1 + i] = sin(2.0 * PI * i / n);
+		}
+		table[n] = table[0];
+		table[2 * n + 1] = table[n + 1];
+	}
+	return {table.data(), table.data() + n + 1};
+}
+
+TSphereTable GLScene::UnitSphere(GLuint sectors, GLuint stacks)
+{
+	if ((sectors == 36) && (stacks == 18))
+		return {Sphere36x18.Vertex, Sphere36x18.Index};
+	if ((sectors == 10) && (stacks == 5))
+		return {Sphere10x5.Vertex, Sphere10x5.Index};
+
+	// Other level, computed once (under the lock like the circles)
+	static std::map<std::pair<GLuint, GLuint>, std::pair<std::vector<GLfloat>, std::vector<GLuint>>> spheres;
+	static std::mutex lock;
+	std::lock_guard<std::mutex> guard(lock);
+	std::pair<std::vector<GLfloat>, std::vector<GLuint>> &table = spheres[std::make_pair(sectors, stacks)];
+	if (table.first.empty())
+	{
+		const TCircleTable circle = UnitCircle(sectors);
+		std::vector<GLfloat> &vertex = table.first;
+		vertex.reserve((sectors + 1) * (stacks + 1) * 3);
+		for (GLuint i = 0; i <= stacks; i++)
+		{
+			// Starting from pi/2 to -pi/2
+			const double stackAngle = PI / 2.0 - i * PI / stacks;
+			const double xy = cos(stackAngle);
+			const double z = sin(stackAngle);
+			for (GLuint j = 0; j <= sectors; j++)
+			{
+				vertex.push_back(xy * circle.Cos[j]);
+				vertex.push_back(xy * circle.Sin[j]);
+				vertex.push_back(z);
+			}
+		}
+
+		// 2 triangles per sector excluding 1st and last stacks
+		std::vector<GLuint> &index = table.second;
+		index.reserve(6 * (stacks - 1) * sectors);
+		for (GLuint i = 0; i < stacks; i++)
+		{
+			GLuint k1 = i * (sectors + 1);  // beginning of current stack
+			GLuint k2 = k1 + sectors + 1;   // beginning of next stack
+			for (GLuint j = 0; j < sectors; j++, k1++, k2++)
+			{
+				if (i != 0)
+					index.insert(index.end(), {k1, k2, k1 + 1});
+				if (i != (stacks - 1))
+					index.insert(index.end(), {k1 + 1, k2, k2 + 1});
+			}
+		}
+	}
+	return {table.first.data(), table.second.data()};
+}
+
+/**
+ * Each level is computed from the previous one (level <= ICOSPHERE_LEVEL_MAX).
+ * The lock guards the levels, their arrays don't move when the vector grows.
+ */
+TSphereTable GLScene::UnitIcosphere(GLuint level)
+{
+	static std::vector<std::pair<std::vector<GLfloat>, std::vector<GLuint>>> levels;
+	static std::mutex lock;
+	if (level > ICOSPHERE_LEVEL_MAX)
+		level = ICOSPHERE_LEVEL_MAX;
+
+	std::lock_guard<std::mutex> guard(lock);
+
+	if (levels.empty())
+	{
+		// The icosahedron
+		const GLfloat t = (1.0 + sqrt(5.0)) / 2.0;
+		const GLfloat points[12][3] = {{-1, t, 0}, {1, t, 0}, {-1, -t, 0}, {1, -t, 0}, {0, -1, t}, {0, 1, t},
+				{0, -1, -t}, {0, 1, -t}, {t, 0, -1}, {t, 0, 1}, {-t, 0, -1}, {-t, 0, 1}};
+		const GLuint faces[60] = {0, 11, 5, 0, 5, 1, 0, 1, 7, 0, 7, 10, 0, 10, 11, 1, 5, 9, 5, 11, 4, 11, 10, 2,
+				10, 7, 6, 7, 1, 8, 3, 9, 4, 3, 4, 2, 3, 2, 6, 3, 6, 8, 3, 8, 9, 4, 9, 5, 2, 4, 11, 6, 2, 10,
+				8, 6, 7, 9, 8, 1};
+
+		levels.resize(1);
+		for (int i = 0; i < 12; i++)
+		{
+			TVector3D point(points[i][0], points[i][1], points[i][2]);
+			point.Normalize();
+			levels[0].first.insert(levels[0].first.end(), point.array, point.array + 3);
+		}
+		levels[0].second.assign(faces, faces + 60);
+	}
+
+	while (levels.size() <= level)
+	{
+		const std::pair<std::vector<GLfloat>, std::vector<GLuint>> &previous = levels.back();
+		std::pair<std::vector<GLfloat>, std::vector<GLuint>> next;
+		const GLuint n = levels.size();
+		std::vector<GLfloat> &vertex = next.first;
+		std::vector<GLuint> &index = next.second;
+		vertex = previous.first;
+		vertex.reserve(3 * IcosphereVertexCount(n));
+		index.reserve(IcosphereIndexCount(n));
+
+		// The middle of an edge is shared by the 2 triangles of the edge
+		std::map<std::pair<GLuint, GLuint>, GLuint> middles;
+		auto Middle = [&](GLuint a, GLuint b) -> GLuint
+		{
+			const std::pair<GLuint, GLuint> edge = std::minmax(a, b);
+			std::map<std::pair<GLuint, GLuint>, GLuint>::iterator it = middles.find(edge);
+			if (it != middles.end())
+				return it->second;
+
+			TVector3D point(vertex[3 * a] + vertex[3 * b], vertex[3 * a + 1] + vertex[3 * b + 1],
+					vertex[3 * a + 2] + vertex[3 * b + 2]);
+			point.Normalize();
+			const GLuint m = vertex.size() / 3;
+			vertex.insert(vertex.end(), point.array, point.array + 3);
+			middles[edge] = m;
+			return m;
+		};
+
+		for (GLuint i = 0; i < previous.second.size(); i += 3)
+		{
+			const GLuint a = previous.second[i];
+			const GLuint b = previous.second[i + 1];
+			const GLuint c = previous.second[i + 2];
+			const GLuint ab = Middle(a, b), bc = Middle(b, c), ca = Middle(c, a);
+			index.insert(index.end(), {a, ab, ca, b, bc, ab, c, ca, bc, ab, bc, ca});
+		}
+		levels.push_back(std::move(next));
+	}
+
+	return {levels[level].first.data(), levels[level].second.data()};
+}
+
+// ********************************************************************************
+// End of file
+// ********************************************************************************
@@ -0,0 +1,157 @@
+#ifndef _TESSELLATION_H
+#define _TESSELLATION_H
+
+#include "Vector3D.h"
+
+namespace GLScene
+{
+
+/**
+ * Sine and cosine usable at compile time : reduction to [-pi, pi] then Taylor series
+ * (the error is below 1e-15, like sin and cos of the library)
+ */
+constexpr double ConstSin(double x)
+{
+	while (x > PI)
+		x -= 2.0 * PI;
+	while (x < -PI)
+		x += 2.0 * PI;
+
+	double term = x, sum = x;
+	for (int n = 1; n < 20; n++)
+	{
+		term *= -x * x / ((2 * n) * (2 * n + 1));
+		sum += term;
+	}
+	return sum;
+}
+
+constexpr double ConstCos(double x)
+{
+	return ConstSin(x + PI / 2.0);
+}
+
+/**
+ * The points of the unit circle at the angles 2 pi i / N, i in [0, N]. The last point
+ * closes the circle (it is the first one).
+ */
+template<GLuint N>
+struct TUnitCircle
+{
+	public:
+		double Cos[N + 1];
+		double Sin[N + 1];
+
+		constexpr TUnitCircle() : Cos(), Sin()
+		{
+			for (GLuint i = 0; i <= N; i++)
+			{
+				Cos[i] = ConstCos(2.0 * PI * i / N);
+				Sin[i] = ConstSin(2.0 * PI * i / N);
+			}
+			Cos[N] = Cos[0];
+			Sin[N] = Sin[0];
+		}
+};
+
+/**
+ * The unit sphere : (Sectors + 1) * (Stacks + 1) points from the north pole to the south pole
+ * (the point is also the normal), and 6 * (Stacks - 1) * Sectors indices of the triangles.
+ */
+template<GLuint Sectors, GLuint Stacks>
+struct TUnitSphere
+{
+	public:
+		GLfloat Vertex[(Sectors + 1) * (Stacks + 1) * 3];
+		GLuint Index[6 * (Stacks - 1) * Sectors];
+
+		constexpr TUnitSphere() : Vertex(), Index()
+		{
+			GLuint count = 0;
+			for (GLuint i = 0; i <= Stacks; i++)
+			{
+				// Starting from pi/2 to -pi/2
+				const double stackAngle = PI / 2.0 - i * PI / Stacks;
+				const double xy = ConstCos(stackAngle);
+				const double z = ConstSin(stackAngle);
+				for (GLuint j = 0; j <= Sectors; j++)
+				{
+					const double sectorAngle = (j == Sectors) ? 0.0 : 2.0 * PI * j / Sectors;
+					Vertex[count++] = xy * ConstCos(sectorAngle);
+					Vertex[count++] = xy * ConstSin(sectorAngle);
+					Vertex[count++] = z;
+				}
+			}
+
+			// 2 triangles per sector excluding 1st and last stacks
+			count = 0;
+			for (GLuint i = 0; i < Stacks; i++)
+			{
+				GLuint k1 = i * (Sectors + 1);  // beginning of current stack
+				GLuint k2 = k1 + Sectors + 1;   // beginning of next stack
+				for (GLuint j = 0; j < Sectors; j++, k1++, k2++)
+				{
+					if (i != 0)
+					{
+						Index[count++] = k1;
+						Index[count++] = k2;
+						Index[count++] = k1 + 1;
+					}
+					if (i != (Stacks - 1))
+					{
+						Index[count++] = k1 + 1;
+						Index[count++] = k2;
+						Index[count++] = k2 + 1;
+					}
+				}
+			}
+		}
+};
+
+/// A unit circle of any size (see UnitCircle)
+typedef struct TCircleTable
+{
+	public:
+		const double *Cos;
+		const double *Sin;
+} TCircleTable;
+
+/// A unit sphere of any size (see UnitSphere)
+typedef struct TSphereTable
+{
+	public:
+		const GLfloat *Vertex;
+		const GLuint *Index;
+} TSphereTable;
+
+/**
+ * The icosphere of level n : the icosahedron with its triangles divided in 4 n times, the points
+ * pushed on the unit sphere. Unlike the UV sphere, the points are evenly spread (no crowd at
+ * the poles) and there is no seam : 10 * 4^n + 2 points and 20 * 4^n triangles. The 4
+ * triangles of a division follow each other, so the indices stay near in the vertex cache.
+ */
+#define ICOSPHERE_LEVEL_MAX	7
+
+inline GLuint IcosphereVertexCount(GLuint level)
+{
+	return 10 * (1 << (2 * level)) + 2;
+}
+
+inline GLuint IcosphereIndexCount(GLuint level)
+{
+	return 60 * (1 << (2 * level));
+}
+
+/**
+ * The tables of the usual levels of the primitives are built at compile time, the other
+ * levels are computed at the first use and kept (the functions can be called from several
+ * threads). The tables are shared, not to be freed.
+ */
+TCircleTable UnitCircle(GLuint n);
+TSphereTable UnitSphere(GLuint sectors, GLuint stacks);
+TSphereTable UnitIcosphere(GLuint level);
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _TESSELLATION_H
@@ -0,0 +1,520 @@
+#include "TiledSurface.h"
+#include "Parallel.h"
+#include <algorithm>
+#include <cstring>
+
+// Index of the neighbours
+enum
+{
+	nbLeft = 0,
+	nbRight,
+	nbBottom,
+	nbTop
+};
+
+/**
+ * Position (in cells) of the vertex k of a chunk of c cells drawn with a step s.
+ * The last vertex is always the border of the chunk.
+ */
+static inline GLuint LevelPosition(GLuint k, GLuint s, GLuint c)
+{
+	return std::min(k * s, c);
+}
+
+/**
+ * Number of vertices of a chunk of c cells drawn with a step s
+ */
+static inline GLuint LevelCount(GLuint s, GLuint c)
+{
+	return (c + s - 1) / s + 1;
+}
+
+TTiledSurface::TTiledSurface(GLuint dimX, GLuint dimY, GLuint chunkSize, const TVector3D &pos) : TObject3D(pos)
+{
+	ObjectType = otTiledSurface;
+
+	sizeX = dimX;
+	sizeY = dimY;
+	_xMin = _yMin = 0.0;
+	stepX = stepY = 1.0;
+	SurfaceComputed = false;
+	pixelError = 2.0f;
+	visibleChunks = 0;
+
+	// Chunk size is a power of 2 in [4, TILED_MAX_CHUNK]
+	maxLevel = 2;
+	while (((GLuint) 2 << maxLevel) <= std::min(chunkSize, (GLuint) TILED_MAX_CHUNK))
+		maxLevel++;
+	this->chunkSize = 1 << maxLevel;
+
+	material.SetColor(mfFront, msAmbient, {0.1, 0.1, 0.8, 1.0});
+	material.SetColor(mfFront, msDiffuse, GLColor_blue);
+
+	material.SetColor(mfBack, msAmbient, {0.2, 0.2, 0.2, 1.0});
+	material.SetColor(mfBack, msDiffuse, {0.8, 0.8, 0.8, 1.0});
+
+	DoPosition = true;
+}
+
+TTiledSurface::~TTiledSurface()
+{
+	FreeChunks();
+	DeleteAndNull(heights);
+}
+
+void TTiledSurface::InitializeSurface(double xMin, double xMax, double yMin, double yMax)
+{
+	SurfaceComputed = false;
+	if ((FunctionZ == NULL) || (sizeX < 2) || (sizeY < 2))
+		return;
+
+	DeleteAndNull(heights);
+	heights = new GLfloat[(size_t) sizeX * sizeY];
+
+	_xMin = xMin;
+	_yMin = yMin;
+	stepX = (xMax - xMin) / (sizeX - 1);
+	stepY = (yMax - yMin) / (sizeY - 1);
+
+	try
+	{
+		size_t k = 0;
+		for (GLuint j = 0; j < sizeY; j++)
+		{
+			const double y = yMin + j * stepY;
+			for (GLuint i = 0; i < sizeX; i++)
+				heights[k++] = (GLfloat) FunctionZ(xMin + i * stepX, y);
+		}
+
+		CreateChunks();
+		SurfaceComputed = true;
+	} catch (...)
+	{
+
+	}
+}
+
+/**
+ * Copy the sizeX x sizeY heights (grid order, X first) of the surface
+ */
+void TTiledSurface::SetHeights(const GLfloat *z, double xMin, double xMax, double yMin, double yMax)
+{
+	SurfaceComputed = false;
+	if ((z == NULL) || (sizeX < 2) || (sizeY < 2))
+		return;
+
+	DeleteAndNull(heights);
+	heights = new GLfloat[(size_t) sizeX * sizeY];
+	memcpy(heights, z, (size_t) sizeX * sizeY * sizeof(GLfloat));
+
+	_xMin = xMin;
+	_yMin = yMin;
+	stepX = (xMax - xMin) / (sizeX - 1);
+	stepY = (yMax - yMin) / (sizeY - 1);
+
+	CreateChunks();
+	SurfaceComputed = true;
+}
+
+/**
+ * The visible chunks are built again in the format at the next display
+ */
+void TTiledSurface::SetVertexFormat(TVertexFormat format)
+{
+	TObject3D::SetVertexFormat(format);
+	for (size_t k = 0; k < chunks.size(); k++)
+		FreeChunk(chunks[k]);
+}
+
+void TTiledSurface::CreateChunks(void)
+{
+	FreeChunks();
+
+	chunkCountX = (sizeX - 2) / chunkSize + 1;
+	chunkCountY = (sizeY - 2) / chunkSize + 1;
+	chunks.resize((size_t) chunkCountX * chunkCountY);
+
+	size_t k = 0;
+	for (GLuint j = 0; j < chunkCountY; j++)
+	{
+		for (GLuint i = 0; i < chunkCountX; i++)
+		{
+			TSurfaceChunk &chunk = chunks[k++];
+			chunk.x0 = i * chunkSize;
+			chunk.y0 = j * chunkSize;
+			chunk.cx = std::min(chunkSize, sizeX - 1 - chunk.x0);
+			chunk.cy = std::min(chunkSize, sizeY - 1 - chunk.y0);
+			chunk.level = 0;
+			chunk.builtLevel = -1;
+			for (int n = 0; n < 4; n++)
+				chunk.neighbour[n] = -1;
+			chunk.visible = false;
+			chunk.vertices = NULL;
+			chunk.indices = NULL;
+			chunk.vertexCount = 0;
+			chunk.indiceLength = 0;
+#ifdef USE_VBO
+			chunk.vboId = 0;
+			chunk.iboId = 0;
+#endif
+		}
+	}
+
+	// Bounding box and errors are independent for each chunk
+	ParallelFor(0, chunks.size(), [this](size_t begin, size_t end)
+	{
+		for (size_t c = begin; c < end; c++)
+			ComputeChunkError(chunks[c]);
+	});
+}
+
+/**
+ * Compute the bounding box and the max error between the full resolution and
+ * each level of the chunk
+ */
+void TTiledSurface::ComputeChunkError(TSurfaceChunk &chunk)
+{
+	GLfloat zMin = Height(chunk.x0, chunk.y0);
+	GLfloat zMax = zMin;
+
+	for (GLuint j = 0; j <= chunk.cy; j++)
+		for (GLuint i = 0; i <= chunk.cx; i++)
+		{
+			const GLfloat z = Height(chunk.x0 + i, chunk.y0 + j);
+			if (z < zMin) zMin = z;
+			if (z > zMax) zMax = z;
+		}
+
+	chunk.boxMin = TVector3D(_xMin + chunk.x0 * stepX, _yMin + chunk.y0 * stepY, zMin);
+	chunk.boxMax = TVector3D(_xMin + (chunk.x0 + chunk.cx) * stepX, _yMin + (chunk.y0 + chunk.cy) * stepY, zMax);
+
+	chunk.error[0] = 0.0f;
+	for (GLuint level = 1; level <= maxLevel; level++)
+	{
+		const GLuint s = 1 << level;
+		GLfloat error = chunk.error[level - 1];
+
+		for (GLuint j = 0; j <= chunk.cy; j++)
+		{
+			// Cell of the level that contains the vertex
+			const GLuint j0 = std::min((j / s) * s, chunk.cy);
+			const GLuint j1 = std::min(j0 + s, chunk.cy);
+			const GLfloat v = (j1 > j0) ? (GLfloat) (j - j0) / (j1 - j0) : 0.0f;
+
+			for (GLuint i = 0; i <= chunk.cx; i++)
+			{
+				const GLuint i0 = std::min((i / s) * s, chunk.cx);
+				const GLuint i1 = std::min(i0 + s, chunk.cx);
+				const GLfloat u = (i1 > i0) ? (GLfloat) (i - i0) / (i1 - i0) : 0.0f;
+
+				const GLfloat z0 = Height(chunk.x0 + i0, chunk.y0 + j0) * (1.0f - u) + Height(chunk.x0 + i1, chunk.y0 + j0) * u;
+				const GLfloat z1 = Height(chunk.x0 + i0, chunk.y0 + j1) * (1.0f - u) + Height(chunk.x0 + i1, chunk.y0 + j1) * u;
+				const GLfloat delta = fabs(Height(chunk.x0 + i, chunk.y0 + j) - (z0 * (1.0f - v) + z1 * v));
+				if (delta > error)
+					error = delta;
+			}
+		}
+		chunk.error[level] = error;
+	}
+}
+
+/**
+ * Select the level of each chunk from the current OpenGL matrix
+ * and build the chunks that change.
+ */
+void TTiledSurface::SelectLevels(void)
+{
+	GLfloat mv[16], proj[16];
+	GLint viewport[4];
+
+	glGetFloatv(GL_MODELVIEW_MATRIX, mv);
+	glGetFloatv(GL_PROJECTION_MATRIX, proj);
+	glGetIntegerv(GL_VIEWPORT, viewport);
+
+	frustum.Extract(mv, proj);
+
+	for (size_t k = 0; k < chunks.size(); k++)
+	{
+		TSurfaceChunk &chunk = chunks[k];
+		chunk.visible = frustum.BoxVisible(chunk.boxMin, chunk.boxMax);
+
+		// Pixels by unit at the nearest point of the chunk
+		const GLfloat scale = TFrustum::PixelScale(mv, proj, viewport, chunk.boxMin, chunk.boxMax);
+
+		// The coarsest level with an error less than pixelError
+		int level = 0;
+		if (scale > 0.0f)
+		{
+			while ((level < (int) maxLevel) && (chunk.error[level + 1] * scale <= pixelError))
+				level++;
+		}
+
+		chunk.level = level;
+
+		// Free the data of the hidden chunks
+		if (!chunk.visible && (chunk.builtLevel >= 0))
+			FreeChunk(chunk);
+	}
+
+	// Levels are now known, we can build the visible chunks that change
+	visibleChunks = 0;
+	for (GLuint j = 0; j < chunkCountY; j++)
+	{
+		for (GLuint i = 0; i < chunkCountX; i++)
+		{
+			TSurfaceChunk &chunk = chunks[(size_t) j * chunkCountX + i];
+			if (!chunk.visible)
+				continue;
+			visibleChunks++;
+
+			int neighbour[4];
+			neighbour[nbLeft] = (i > 0) ? chunks[(size_t) j * chunkCountX + i - 1].level : chunk.level;
+			neighbour[nbRight] = (i < chunkCountX - 1) ? chunks[(size_t) j * chunkCountX + i + 1].level : chunk.level;
+			neighbour[nbBottom] = (j > 0) ? chunks[(size_t) (j - 1) * chunkCountX + i].level : chunk.level;
+			neighbour[nbTop] = (j < chunkCountY - 1) ? chunks[(size_t) (j + 1) * chunkCountX + i].level : chunk.level;
+
+			bool reindex = false;
+			for (int n = 0; n < 4; n++)
+			{
+				reindex |= (neighbour[n] != chunk.neighbour[n]);
+				chunk.neighbour[n] = neighbour[n];
+			}
+
+			if (chunk.builtLevel != chunk.level)
+			{
+				BuildVertices(chunk);
+				BuildIndices(chunk);
+			}
+			else
+				if (reindex)
+					BuildIndices(chunk);
+		}
+	}
+}
+
+/**
+ * Vertices of the chunk at its level. The normals are computed on the full
+ * resolution grid so they don't change with the level.
+ */
+void TTiledSurface::BuildVertices(TSurfaceChunk &chunk)
+{
+	// Keep the neighbours, they are already updated
+	int neighbour[4];
+	for (int n = 0; n < 4; n++)
+		neighbour[n] = chunk.neighbour[n];
+	FreeChunk(chunk);
+	for (int n = 0; n < 4; n++)
+		chunk.neighbour[n] = neighbour[n];
+	chunk.builtLevel = chunk.level;
+
+	const GLuint s = 1 << chunk.level;
+	const GLuint nx = LevelCount(s, chunk.cx);
+	const GLuint ny = LevelCount(s, chunk.cy);
+	chunk.vertexCount = nx * ny;
+	chunk.vertices = new TVertex[chunk.vertexCount];
+
+	GLuint k = 0;
+	for (GLuint l = 0; l < ny; l++)
+	{
+		const GLuint j = chunk.y0 + LevelPosition(l, s, chunk.cy);
+		const GLuint j0 = (j > 0) ? j - 1 : j;
+		const GLuint j1 = (j < sizeY - 1) ? j + 1 : j;
+
+		for (GLuint m = 0; m < nx; m++)
+		{
+			const GLuint i = chunk.x0 + LevelPosition(m, s, chunk.cx);
+			const GLuint i0 = (i > 0) ? i - 1 : i;
+			const GLuint i1 = (i < sizeX - 1) ? i + 1 : i;
+
+			TVector3D norm(-(Height(i1, j) - Height(i0, j)) / ((i1 - i0) * stepX),
+					-(Height(i, j1) - Height(i, j0)) / ((j1 - j0) * stepY), 1.0f);
+			norm.Normalize();
+
+			chunk.vertices[k].SetVertice(_xMin + i * stepX, _yMin + j * stepY, Height(i, j));
+			chunk.vertices[k].SetNormal(norm.X, norm.Y, norm.Z);
+			k++;
+		}
+	}
+
+#ifdef USE_VBO
+	initOGL();
+	chunk.vboId = createVertexVBO(chunk.vertices, chunk.vertexCount, vertexFormat);
+	if (chunk.vboId == 0)
+		std::cout << "[WARNING] VBO array not created for TiledSurface." << std::endl;
+	DeleteAndNull(chunk.vertices);
+#endif
+}
+
+/**
+ * Triangles of the chunk. On a border with a coarser neighbour, the vertices
+ * that the neighbour doesn't have are moved on the previous vertex of the neighbour.
+ * So the border is the same on each side (no crack), the triangles that become
+ * degenerated are removed.
+ */
+void TTiledSurface::BuildIndices(TSurfaceChunk &chunk)
+{
+	FreeChunk(chunk, true);
+
+	const GLuint s = 1 << chunk.level;
+	const GLuint nx = LevelCount(s, chunk.cx);
+	const GLuint ny = LevelCount(s, chunk.cy);
+
+	// Snap the vertex k of a border of c cells to the step ns of the neighbour
+	auto snap = [s](GLuint k, GLuint c, int neighbour) -> GLuint
+	{
+		const GLuint ns = 1 << neighbour;
+		const GLuint p = LevelPosition(k, s, c);
+		if ((ns <= s) || (p == c))
+			return k;
+		return ((p / ns) * ns) / s;
+	};
+
+	auto index = [&](GLuint m, GLuint l) -> GLushort
+	{
+		if (l == 0)
+			m = snap(m, chunk.cx, chunk.neighbour[nbBottom]);
+		else
+			if (l == ny - 1)
+				m = snap(m, chunk.cx, chunk.neighbour[nbTop]);
+		if (m == 0)
+			l = snap(l, chunk.cy, chunk.neighbour[nbLeft]);
+		else
+			if (m == nx - 1)
+				l = snap(l, chunk.cy, chunk.neighbour[nbRight]);
+		return (GLushort) (l * nx + m);
+	};
+
+	chunk.indices = new GLushort[6 * (nx - 1) * (ny - 1)];
+	GLuint k = 0;
+	GLushort tri[6];
+	for (GLuint l = 0; l < ny - 1; l++)
+	{
+		for (GLuint m = 0; m < nx - 1; m++)
+		{
+			// Same triangles as TSurface : (V0, V1, VsizeX), (V1, VsizeX+1, VsizeX)
+			tri[0] = index(m, l);
+			tri[1] = index(m + 1, l);
+			tri[2] = index(m, l + 1);
+			tri[3] = tri[1];
+			tri[4] = index(m + 1, l + 1);
+			tri[5] = tri[2];
+			for (int t = 0; t < 6; t += 3)
+			{
+				if ((tri[t] != tri[t + 1]) && (tri[t + 1] != tri[t + 2]) && (tri[t] != tri[t + 2]))
+				{
+					chunk.indices[k++] = tri[t];
+					chunk.indices[k++] = tri[t + 1];
+					chunk.indices[k++] = tri[t + 2];
+				}
+			}
+		}
+	}
+	chunk.indiceLength = k;
+
+#ifdef USE_VBO
+	chunk.iboId = createVBO(chunk.indices, SIZE_USHORT(chunk.indiceLength), GL_ELEMENT_ARRAY_BUFFER);
+	if (chunk.iboId == 0)
+		std::cout << "[WARNING] VBO array not created for TiledSurface." << std::endl;
+	DeleteAndNull(chunk.indices);
+#endif
+}
+
+void TTiledSurface::FreeChunk(TSurfaceChunk &chunk, bool onlyIndices)
+{
+	DeleteAndNull(chunk.indices);
+#ifdef USE_VBO
+	DeleteAndNullVBO(1, chunk.iboId);
+#endif
+	chunk.indiceLength = 0;
+	if (onlyIndices)
+		return;
+
+	DeleteAndNull(chunk.vertices);
+#ifdef USE_VBO
+	DeleteAndNullVBO(1, chunk.vboId);
+#endif
+	chunk.vertexCount = 0;
+	chunk.builtLevel = -1;
+	for (int n = 0; n < 4; n++)
+		chunk.neighbour[n] = -1;
+}
+
+void TTiledSurface::FreeChunks(void)
+{
+	for (size_t k = 0; k < chunks.size(); k++)
+		FreeChunk(chunks[k]);
+	chunks.clear();
+}
+
+void TTiledSurface::DoDisplay(TDisplayMode mode)
+{
+	if (!SurfaceComputed)
+		return;
+
+	// In select mode, the projection is restricted around the mouse, keep the levels
+	if (mode == dmRender)
+		SelectLevels();
+
+	glDisable(GL_CULL_FACE);
+
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_NORMAL_ARRAY);
+
+	for (size_t k = 0; k < chunks.size(); k++)
+	{
+		const TSurfaceChunk &chunk = chunks[k];
+		if (!chunk.visible || (chunk.indiceLength == 0))
+			continue;
+
+#ifdef USE_VBO
+
+		if ((chunk.vboId != 0) && (chunk.iboId != 0))
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, chunk.vboId);
+			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, chunk.iboId);
+
+			setVertexPointers(vertexFormat);
+			glDrawElements(GL_TRIANGLES, chunk.indiceLength, GL_UNSIGNED_SHORT, (GLvoid*) 0);
+		}
+
+#else
+
+		glInterleavedArrays(GL_N3F_V3F, SIZE_VERTEX(1), &chunk.vertices[0]);
+		glDrawElements(GL_TRIANGLES, chunk.indiceLength, GL_UNSIGNED_SHORT, &chunk.indices[0]);
+
+#endif
+	}
+
+#ifdef USE_VBO
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+#endif
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_NORMAL_ARRAY);
+
+	glEnable(GL_CULL_FACE);
+}
+
+/**
+ * The union of the boxes of the chunks
+ */
+bool TTiledSurface::GetBounds(TVector3D &boxMin, TVector3D &boxMax)
+{
+	if (chunks.empty() || !SurfaceComputed)
+		return false;
+
+	boxMin = chunks[0].boxMin;
+	boxMax = chunks[0].boxMax;
+	for (const TSurfaceChunk &chunk : chunks)
+		for (int i = 0; i < 3; i++)
+		{
+			boxMin.array[i] = std::min(boxMin.array[i], chunk.boxMin.array[i]);
+			boxMax.array[i] = std::max(boxMax.array[i], chunk.boxMax.array[i]);
+		}
+	return true;
+}
+
+// ********************************************************************************
+// End of file
+// ********************************************************************************
@@ -0,0 +1,123 @@
+#ifndef _TILED_SURFACE_3D_H
+#define _TILED_SURFACE_3D_H
+
+#include "Object3D.h"
+#include "Surface.h"
+#include "Frustum.h"
+#include <vector>
+
+namespace GLScene
+{
+
+// Max chunk size is 128 cells so a chunk has less than 65535 vertices (16 bits indices)
+#define TILED_MAX_CHUNK	128
+#define TILED_MAX_LEVEL	7
+
+/**
+ * A chunk of the tiled surface
+ * The chunk is drawn with one vertex out of 2^level. The indices are computed
+ * with the level of the 4 neighbours so the borders are crack free.
+ */
+typedef struct TSurfaceChunk
+{
+	public:
+		GLuint x0, y0;     // First vertex of the chunk in the grid
+		GLuint cx, cy;     // Number of cells along X and Y
+		TVector3D boxMin;  // Bounding box for the culling
+		TVector3D boxMax;
+		GLfloat error[TILED_MAX_LEVEL + 1]; // Max height error of each level
+
+		int level;         // Level selected for the current view
+		int builtLevel;    // Level of the vertices, -1 if nothing built
+		int neighbour[4];  // Level of the neighbours used for the indices (left, right, bottom, top)
+		bool visible;
+
+		TVertex *vertices;
+		GLushort *indices;
+		GLuint vertexCount;
+		GLuint indiceLength;
+#ifdef USE_VBO
+		GLuint vboId;  // ID of VBO for vertex and normal interleaved arrays
+		GLuint iboId;  // ID of VBO for index array
+#endif
+} TSurfaceChunk;
+
+/**
+ * TTiledSurface class
+ * A surface z = f(x, y) for very large grid (terrain, wafer, ...).
+ * Params: dimensions of the plane dimX x dimY. This the number of points along X axis and Y axis.
+ * Params: chunkSize, number of cells of a chunk along X and Y, power of 2 (default 64)
+ * Params: position (default (0,0,0))
+ * The grid is split in chunks of chunkSize x chunkSize cells. Only the heights are
+ * kept in memory, each visible chunk build its vertices at the level of detail that give
+ * a screen error less than SetPixelError (geomipmapping).
+ * Two options :
+ * 1) you provide a function to plot via setFunctionZ and an interval with InitializeSurface
+ * 2) you provide directly the heights with SetHeights
+ */
+class TTiledSurface: public TObject3D
+{
+	public:
+		TTiledSurface(GLuint dimX, GLuint dimY, GLuint chunkSize = 64, const TVector3D &pos = GLDefaultPosition);
+		virtual ~TTiledSurface();
+
+		virtual bool GetBounds(TVector3D &boxMin, TVector3D &boxMax);
+
+		void setFunctionZ(TFunctionZ fonc)
+		{
+			FunctionZ = fonc;
+		}
+		void InitializeSurface(double xMin, double xMax, double yMin, double yMax);
+		void SetHeights(const GLfloat *z, double xMin, double xMax, double yMin, double yMax);
+		virtual void SetVertexFormat(TVertexFormat format);
+
+		/// Max error in pixel allowed on the screen (default 2 pixels)
+		void SetPixelError(GLfloat error)
+		{
+			pixelError = error;
+		}
+
+		/// Number of chunks drawn during the last display
+		GLuint GetVisibleChunks(void)
+		{
+			return visibleChunks;
+		}
+
+	protected:
+		void DoDisplay(TDisplayMode mode = dmRender);
+
+	private:
+		GLuint sizeX, sizeY;
+		GLuint chunkSize;
+		GLuint maxLevel;
+		GLuint chunkCountX, chunkCountY;
+		GLfloat *heights = NULL;
+		bool SurfaceComputed;
+
+		TFunctionZ FunctionZ = NULL;
+		double _xMin, _yMin;
+		double stepX, stepY;
+
+		std::vector<TSurfaceChunk> chunks;
+		TFrustum frustum;
+		GLfloat pixelError;
+		GLuint visibleChunks;
+
+		inline GLfloat Height(GLuint i, GLuint j) const
+		{
+			return heights[(size_t) j * sizeX + i];
+		}
+
+		void CreateChunks(void);
+		void ComputeChunkError(TSurfaceChunk &chunk);
+		void SelectLevels(void);
+		void BuildVertices(TSurfaceChunk &chunk);
+		void BuildIndices(TSurfaceChunk &chunk);
+		void FreeChunk(TSurfaceChunk &chunk, bool onlyIndices = false);
+		void FreeChunks(void);
+};
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _TILED_SURFACE_3D_H
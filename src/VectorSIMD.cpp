@@ -0,0 +1,75 @@
+#include "VectorSIMD.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+using namespace GLScene;
+
+/**
+ * The normals of the grid with the scalar TVector3D, then the aligned TVector3DA
+ * (see VectorSIMD.h)
+ */
+void GLScene::VectorSIMD_Benchmark(GLuint dimX, GLuint dimY, int repeat)
+{
+	const size_t length = (size_t) dimX * dimY;
+	std::vector<TVector3D> grid(length), normals(length);
+	std::vector<TVector3DA> gridA(length), normalsA(length);
+	for (GLuint j = 0; j < dimY; j++)
+		for (GLuint i = 0; i < dimX; i++)
+		{
+			const GLfloat x = i * 0.01f, y = j * 0.01f;
+			grid[(size_t) j * dimX + i] = TVector3D(x, y, sinf(x) * cosf(y));
+			gridA[(size_t) j * dimX + i] = TVector3DA(grid[(size_t) j * dimX + i]);
+		}
+
+	double scalarTime = 1e30, simdTime = 1e30;
+	for (int r = 0; r < repeat; r++)
+	{
+		auto start = std::chrono::steady_clock::now();
+		for (GLuint j = 0; j < dimY - 1; j++)
+		{
+			size_t k = (size_t) j * dimX;
+			for (GLuint i = 0; i < dimX - 1; i++, k++)
+			{
+				TVector3D cell = (grid[k + 1] - grid[k]) ^ (grid[k + dimX] - grid[k]);
+				normals[k] = cell.Normalize();
+			}
+		}
+		auto middle = std::chrono::steady_clock::now();
+		for (GLuint j = 0; j < dimY - 1; j++)
+		{
+			size_t k = (size_t) j * dimX;
+			for (GLuint i = 0; i < dimX - 1; i++, k++)
+			{
+				TVector3DA cell = (gridA[k + 1] - gridA[k]) ^ (gridA[k + dimX] - gridA[k]);
+				normalsA[k] = cell.Normalize();
+			}
+		}
+		auto end = std::chrono::steady_clock::now();
+		scalarTime = std::min(scalarTime, std::chrono::duration<double>(middle - start).count());
+		simdTime = std::min(simdTime, std::chrono::duration<double>(end - middle).count());
+	}
+
+	GLfloat error = 0.0f;
+	for (size_t k = 0; k < length; k++)
+		error = std::max(error, (normals[k] - normalsA[k].ToVector3D()).Length());
+
+	const double cells = (double) (dimX - 1) * (dimY - 1);
+	printf("\n******** Vector SIMD Benchmark ***********\n");
+#if defined(VECTOR_SSE)
+	printf("SSE, ");
+#elif defined(VECTOR_NEON)
+	printf("NEON, ");
+#else
+	printf("scalar, ");
+#endif
+	printf("normals of %u x %u vertices\n", dimX, dimY);
+	printf("TVector3D  : %.1f ms, %.1f Mvertices/s\n", scalarTime * 1000.0, cells / scalarTime * 1e-6);
+	printf("TVector3DA : %.1f ms, %.1f Mvertices/s\n", simdTime * 1000.0, cells / simdTime * 1e-6);
+	printf("Max difference %g\n", error);
+	fflush(stdout);
+}
+
+// ********************************************************************************
+// End of file
+// ********************************************************************************
@@ -0,0 +1,516 @@
+#ifndef _VECTOR_SIMD_H
+#define _VECTOR_SIMD_H
+
+#include "Vector3D.h"
+#include "Vector4D.h"
+#include <algorithm>
+
+/* ================================================================== */
+/*                          Compilation option                        */
+/* ================================================================== */
+
+/// Define VECTOR_NO_SIMD to use the scalar code on all the platforms
+//#define VECTOR_NO_SIMD
+
+#if !defined(VECTOR_NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1)))
+	#define VECTOR_SSE
+	#include <xmmintrin.h>
+#elif !defined(VECTOR_NO_SIMD) && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+	#define VECTOR_NEON
+	#include <arm_neon.h>
+#endif
+
+namespace GLScene
+{
+
+/* ================================================================== */
+/*               4 floats in a register (SSE, NEON or scalar)         */
+/* ================================================================== */
+
+#if defined(VECTOR_SSE)
+typedef __m128 TFloat4;
+#elif defined(VECTOR_NEON)
+typedef float32x4_t TFloat4;
+#else
+typedef struct TFloat4
+{
+	public:
+		GLfloat v[4];
+} TFloat4;
+#endif
+
+/// Load 4 floats from a 16 bytes aligned address
+inline TFloat4 Float4Load(const GLfloat *p)
+{
+#if defined(VECTOR_SSE)
+	return _mm_load_ps(p);
+#elif defined(VECTOR_NEON)
+	return vld1q_f32(p);
+#else
+	return {{p[0], p[1], p[2], p[3]}};
+#endif
+}
+
+/// Store 4 floats at a 16 bytes aligned address
+inline void Float4Store(GLfloat *p, TFloat4 a)
+{
+#if defined(VECTOR_SSE)
+	_mm_store_ps(p, a);
+#elif defined(VECTOR_NEON)
+	vst1q_f32(p, a);
+#else
+	p[0] = a.v[0];
+	p[1] = a.v[1];
+	p[2] = a.v[2];
+	p[3] = a.v[3];
+#endif
+}
+
+/// Load 4 floats from any address
+inline TFloat4 Float4LoadU(const GLfloat *p)
+{
+#if defined(VECTOR_SSE)
+	return _mm_loadu_ps(p);
+#elif defined(VECTOR_NEON)
+	return vld1q_f32(p);
+#else
+	return {{p[0], p[1], p[2], p[3]}};
+#endif
+}
+
+/// Store 4 floats at any address
+inline void Float4StoreU(GLfloat *p, TFloat4 a)
+{
+#if defined(VECTOR_SSE)
+	_mm_storeu_ps(p, a);
+#elif defined(VECTOR_NEON)
+	vst1q_f32(p, a);
+#else
+	Float4Store(p, a);
+#endif
+}
+
+inline TFloat4 Float4Set(GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+{
+#if defined(VECTOR_SSE)
+	return _mm_setr_ps(x, y, z, w);
+#elif defined(VECTOR_NEON)
+	const GLfloat p[4] = {x, y, z, w};
+	return vld1q_f32(p);
+#else
+	return {{x, y, z, w}};
+#endif
+}
+
+inline TFloat4 Float4Splat(GLfloat a)
+{
+#if defined(VECTOR_SSE)
+	return _mm_set1_ps(a);
+#elif defined(VECTOR_NEON)
+	return vdupq_n_f32(a);
+#else
+	return {{a, a, a, a}};
+#endif
+}
+
+inline TFloat4 Float4Add(TFloat4 a, TFloat4 b)
+{
+#if defined(VECTOR_SSE)
+	return _mm_add_ps(a, b);
+#elif defined(VECTOR_NEON)
+	return vaddq_f32(a, b);
+#else
+	return {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+#endif
+}
+
+inline TFloat4 Float4Sub(TFloat4 a, TFloat4 b)
+{
+#if defined(VECTOR_SSE)
+	return _mm_sub_ps(a, b);
+#elif defined(VECTOR_NEON)
+	return vsubq_f32(a, b);
+#else
+	return {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}};
+#endif
+}
+
+inline TFloat4 Float4Mul(TFloat4 a, TFloat4 b)
+{
+#if defined(VECTOR_SSE)
+	return _mm_mul_ps(a, b);
+#elif defined(VECTOR_NEON)
+	return vmulq_f32(a, b);
+#else
+	return {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+#endif
+}
+
+inline TFloat4 Float4Div(TFloat4 a, TFloat4 b)
+{
+#if defined(VECTOR_SSE)
+	return _mm_div_ps(a, b);
+#elif defined(VECTOR_NEON) && defined(__aarch64__)
+	return vdivq_f32(a, b);
+#else
+	alignas(16) GLfloat p[4], q[4];
+	Float4Store(p, a);
+	Float4Store(q, b);
+	return Float4Set(p[0] / q[0], p[1] / q[1], p[2] / q[2], p[3] / q[3]);
+#endif
+}
+
+inline TFloat4 Float4Sqrt(TFloat4 a)
+{
+#if defined(VECTOR_SSE)
+	return _mm_sqrt_ps(a);
+#elif defined(VECTOR_NEON) && defined(__aarch64__)
+	return vsqrtq_f32(a);
+#else
+	alignas(16) GLfloat p[4];
+	Float4Store(p, a);
+	return Float4Set(sqrtf(p[0]), sqrtf(p[1]), sqrtf(p[2]), sqrtf(p[3]));
+#endif
+}
+
+inline TFloat4 Float4Min(TFloat4 a, TFloat4 b)
+{
+#if defined(VECTOR_SSE)
+	return _mm_min_ps(a, b);
+#elif defined(VECTOR_NEON)
+	return vminq_f32(a, b);
+#else
+	return {{std::min(a.v[0], b.v[0]), std::min(a.v[1], b.v[1]), std::min(a.v[2], b.v[2]), std::min(a.v[3], b.v[3])}};
+#endif
+}
+
+inline TFloat4 Float4Max(TFloat4 a, TFloat4 b)
+{
+#if defined(VECTOR_SSE)
+	return _mm_max_ps(a, b);
+#elif defined(VECTOR_NEON)
+	return vmaxq_f32(a, b);
+#else
+	return {{std::max(a.v[0], b.v[0]), std::max(a.v[1], b.v[1]), std::max(a.v[2], b.v[2]), std::max(a.v[3], b.v[3])}};
+#endif
+}
+
+/// The mask of the components where a > b, used by Float4Select
+inline TFloat4 Float4Greater(TFloat4 a, TFloat4 b)
+{
+#if defined(VECTOR_SSE)
+	return _mm_cmpgt_ps(a, b);
+#elif defined(VECTOR_NEON)
+	return vreinterpretq_f32_u32(vcgtq_f32(a, b));
+#else
+	return {{(a.v[0] > b.v[0]) ? 1.0f : 0.0f, (a.v[1] > b.v[1]) ? 1.0f : 0.0f, (a.v[2] > b.v[2]) ? 1.0f : 0.0f,
+			(a.v[3] > b.v[3]) ? 1.0f : 0.0f}};
+#endif
+}
+
+/// The components of a where the mask is set, else the components of b
+inline TFloat4 Float4Select(TFloat4 mask, TFloat4 a, TFloat4 b)
+{
+#if defined(VECTOR_SSE)
+	return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b));
+#elif defined(VECTOR_NEON)
+	return vbslq_f32(vreinterpretq_u32_f32(mask), a, b);
+#else
+	return {{(mask.v[0] != 0.0f) ? a.v[0] : b.v[0], (mask.v[1] != 0.0f) ? a.v[1] : b.v[1],
+			(mask.v[2] != 0.0f) ? a.v[2] : b.v[2], (mask.v[3] != 0.0f) ? a.v[3] : b.v[3]}};
+#endif
+}
+
+/// The first component
+inline GLfloat Float4First(TFloat4 a)
+{
+#if defined(VECTOR_SSE)
+	return _mm_cvtss_f32(a);
+#elif defined(VECTOR_NEON)
+	return vgetq_lane_f32(a, 0);
+#else
+	return a.v[0];
+#endif
+}
+
+/// Dot product of (x, y, z) in the 4 components, w is ignored
+inline TFloat4 Float4Dot3(TFloat4 a, TFloat4 b)
+{
+#if defined(VECTOR_SSE)
+	const __m128 m = _mm_mul_ps(a, b);
+	const __m128 x = _mm_shuffle_ps(m, m, _MM_SHUFFLE(0, 0, 0, 0));
+	const __m128 y = _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 1, 1, 1));
+	const __m128 z = _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 2, 2, 2));
+	return _mm_add_ps(_mm_add_ps(x, y), z);
+#elif defined(VECTOR_NEON)
+	const float32x4_t m = vmulq_f32(a, b);
+	return vdupq_n_f32(vgetq_lane_f32(m, 0) + vgetq_lane_f32(m, 1) + vgetq_lane_f32(m, 2));
+#else
+	const GLfloat d = a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2];
+	return {{d, d, d, d}};
+#endif
+}
+
+/// Dot product of the 4 components
+inline TFloat4 Float4Dot4(TFloat4 a, TFloat4 b)
+{
+#if defined(VECTOR_SSE)
+	__m128 m = _mm_mul_ps(a, b);
+	m = _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_add_ps(m, _mm_shuffle_ps(m, m, _MM_SHUFFLE(1, 0, 3, 2)));
+#elif defined(VECTOR_NEON)
+	const float32x4_t m = vmulq_f32(a, b);
+	return vdupq_n_f32(vgetq_lane_f32(m, 0) + vgetq_lane_f32(m, 1) + vgetq_lane_f32(m, 2) + vgetq_lane_f32(m, 3));
+#else
+	const GLfloat d = a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2] + a.v[3] * b.v[3];
+	return {{d, d, d, d}};
+#endif
+}
+
+/// Cross product of (x, y, z), w is 0
+inline TFloat4 Float4Cross3(TFloat4 a, TFloat4 b)
+{
+#if defined(VECTOR_SSE)
+	const __m128 a1 = _mm_shuffle_ps(a, a, _MM_SHUFFLE(3, 0, 2, 1));
+	const __m128 b1 = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 2, 1));
+	const __m128 c = _mm_sub_ps(_mm_mul_ps(a, b1), _mm_mul_ps(a1, b));
+	return _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 0, 2, 1));
+#else
+	alignas(16) GLfloat p[4], q[4];
+	Float4Store(p, a);
+	Float4Store(q, b);
+	return Float4Set(p[1] * q[2] - p[2] * q[1], p[2] * q[0] - p[0] * q[2], p[0] * q[1] - p[1] * q[0], 0.0f);
+#endif
+}
+
+/* ================================================================== */
+/*                    Aligned vectors for bulk arrays                 */
+/* ================================================================== */
+
+/**
+ * TVector3DA : a TVector3D on 16 bytes aligned (W is a padding always 0) for the arrays
+ * computed with SIMD instructions (SSE on x86, NEON on ARM, else scalar code).
+ * The API is the API of TVector3D, convert with TVector3DA(v) and ToVector3D().
+ */
+typedef union alignas(16) TVector3DA
+{
+	public:
+		GLfloat array[4];
+		struct
+		{
+				GLfloat X;
+				GLfloat Y;
+				GLfloat Z;
+				GLfloat W;
+		};
+		TFloat4 simd;
+
+	public:
+		TVector3DA()
+		{
+			simd = Float4Splat(0.0f);
+		}
+
+		TVector3DA(const GLfloat x, const GLfloat y, const GLfloat z)
+		{
+			simd = Float4Set(x, y, z, 0.0f);
+		}
+
+		TVector3DA(const TVector3D &vect)
+		{
+			simd = Float4Set(vect.X, vect.Y, vect.Z, 0.0f);
+		}
+
+		TVector3DA(const TFloat4 &value)
+		{
+			simd = value;
+		}
+
+		inline TVector3D ToVector3D(void) const
+		{
+			return TVector3D(X, Y, Z);
+		}
+
+		inline TVector3DA& operator +=(const TVector3DA &vect)
+		{
+			simd = Float4Add(simd, vect.simd);
+			return *this;
+		}
+
+		inline TVector3DA& operator -=(const TVector3DA &vect)
+		{
+			simd = Float4Sub(simd, vect.simd);
+			return *this;
+		}
+
+		inline TVector3DA& operator *=(const GLfloat val)
+		{
+			simd = Float4Mul(simd, Float4Splat(val));
+			return *this;
+		}
+
+		inline TVector3DA& operator /=(const GLfloat val)
+		{
+			simd = Float4Mul(simd, Float4Splat(1.0f / val));
+			return *this;
+		}
+
+		inline TVector3DA operator -(void) const
+		{
+			return TVector3DA(Float4Sub(Float4Splat(0.0f), simd));
+		}
+
+		inline TVector3DA operator -(const TVector3DA &vect) const
+		{
+			return TVector3DA(Float4Sub(simd, vect.simd));
+		}
+
+		inline TVector3DA operator +(const TVector3DA &vect) const
+		{
+			return TVector3DA(Float4Add(simd, vect.simd));
+		}
+
+		/// Scalar product like dot function
+		inline GLfloat operator *(const TVector3DA &vect) const
+		{
+			return Float4First(Float4Dot3(simd, vect.simd));
+		}
+
+		inline TVector3DA operator *(const GLfloat val) const
+		{
+			return TVector3DA(Float4Mul(simd, Float4Splat(val)));
+		}
+
+		inline TVector3DA operator /(const GLfloat val) const
+		{
+			return TVector3DA(Float4Mul(simd, Float4Splat(1.0f / val)));
+		}
+
+		/// Scalar product
+		inline GLfloat Dot(const TVector3DA &vect) const
+		{
+			return Float4First(Float4Dot3(simd, vect.simd));
+		}
+
+		/// Vectorial product
+		inline TVector3DA Vectorial(const TVector3DA &vect) const
+		{
+			return TVector3DA(Float4Cross3(simd, vect.simd));
+		}
+
+		/// Vector Length
+		inline GLfloat Length(void) const
+		{
+			return sqrtf(Dot(*this));
+		}
+
+		/// Test if vector is nul
+		inline bool IsNull(void) const
+		{
+			return ((fabs(X) + fabs(Y) + fabs(Z)) < Epsilon);
+		}
+
+		/// Normalize, same result as TVector3D::Normalize (exact square root)
+		inline TVector3DA& Normalize()
+		{
+			const TFloat4 norm = Float4Dot3(simd, simd);
+			if (fabs(Float4First(norm)) < Epsilon)
+				simd = Float4Splat(0.0f);
+			else
+				simd = Float4Mul(simd, Float4Div(Float4Splat(1.0f), Float4Sqrt(norm)));
+			return *this;
+		}
+} TVector3DA;
+
+/// Vectorial product
+inline TVector3DA operator ^(const TVector3DA &A, const TVector3DA &B)
+{
+	return TVector3DA(Float4Cross3(A.simd, B.simd));
+}
+
+/**
+ * TVector4DA : a TVector4D on 16 bytes aligned for the arrays computed with SIMD instructions
+ */
+typedef union alignas(16) TVector4DA
+{
+	public:
+		GLfloat array[4];
+		struct
+		{
+				GLfloat R;
+				GLfloat G;
+				GLfloat B;
+				GLfloat Alpha;
+		};
+		TFloat4 simd;
+
+	public:
+		TVector4DA()
+		{
+			simd = Float4Splat(0.0f);
+		}
+
+		TVector4DA(const GLfloat r, const GLfloat g, const GLfloat b, const GLfloat a)
+		{
+			simd = Float4Set(r, g, b, a);
+		}
+
+		TVector4DA(const TVector4D &vect)
+		{
+			simd = Float4Set(vect.R, vect.G, vect.B, vect.Alpha);
+		}
+
+		TVector4DA(const TFloat4 &value)
+		{
+			simd = value;
+		}
+
+		inline TVector4D ToVector4D(void) const
+		{
+			return TVector4D(R, G, B, Alpha);
+		}
+
+		inline TVector4DA operator +(const TVector4DA &vect) const
+		{
+			return TVector4DA(Float4Add(simd, vect.simd));
+		}
+
+		inline TVector4DA operator -(const TVector4DA &vect) const
+		{
+			return TVector4DA(Float4Sub(simd, vect.simd));
+		}
+
+		inline TVector4DA operator *(const GLfloat val) const
+		{
+			return TVector4DA(Float4Mul(simd, Float4Splat(val)));
+		}
+
+		/// Scalar product of the 4 components
+		inline GLfloat Dot(const TVector4DA &vect) const
+		{
+			return Float4First(Float4Dot4(simd, vect.simd));
+		}
+
+		inline GLfloat Length(void) const
+		{
+			return sqrtf(Dot(*this));
+		}
+
+		/// Linear interpolation (1 - t) * this + t * vect, eg for the colors
+		inline TVector4DA Mix(const TVector4DA &vect, const GLfloat t) const
+		{
+			return TVector4DA(Float4Add(simd, Float4Mul(Float4Sub(vect.simd, simd), Float4Splat(t))));
+		}
+} TVector4DA;
+
+/**
+ * Benchmark of the normals of a grid dimX * dimY (the normals of TSurface::ComputeGridNormals) :
+ * the scalar TVector3D array against the aligned TVector3DA array.
+ * VectorSIMD_Benchmark(2048, 2048) for a surface of 4M vertices.
+ */
+void VectorSIMD_Benchmark(GLuint dimX = 2048, GLuint dimY = 2048, int repeat = 5);
+
+} // namespace GLScene
+
+//---------------------------------------------------------------------------
+#endif // _VECTOR_SIMD_H
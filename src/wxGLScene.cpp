@@ -94,14 +94,13 @@ wxGLScene::wxGLScene(wxWindow *parent, const wxGLAttributes &canvasAttrs, wxWind
 	PickedObject = -1;
 	OldPickedObject = -1;
 	display_mode = dmRender;
-	Center_Translation = TVector3D();
 	Projection = glpFrustum;
 
-	InitialView();
-
-	// The default light
+	// The default light and camera
 	light = new TLight();
-//  camera = new TCamera();
+	camera = new TCamera();
+
+	InitialView();
 
 	// Bind events
 	Bind(wxEVT_SIZE, &wxGLScene::OnSize, this);
@@ -128,7 +127,7 @@ wxGLScene::~wxGLScene()
 
 	ClearObject3D(false);
 	delete light;
-//  delete camera;
+	delete camera;
 	delete m_glRC;
 }
 
@@ -360,6 +359,8 @@ void wxGLScene::StopTimer(void)
 
 //---------------------------------------------------------------------------
 // Adjust the projection you want : glFrustum, gluPerspective, glOrtho, gluLookAt, ...
+// The projection is given to the camera (used for the picking of the surfaces)
+// then multiply the current projection matrix.
 void wxGLScene::UpdateProjection(int width, int height)
 {
 	GLdouble ar = (GLdouble) width / (GLdouble) height;
@@ -367,20 +368,21 @@ void wxGLScene::UpdateProjection(int width, int height)
 	switch (Projection)
 	{
 		case glpFrustum:
-			glFrustum(-ar, ar, -1.0, 1.0, 10.0, 100.0);
+			camera->SetFrustum(-ar, ar, -1.0, 1.0, 10.0, 100.0);
 			break;
 		case glpPerspective:
-			gluPerspective(45.0f, ar, 1.0, 300.0f);
+			camera->SetPerspective(45.0f, ar, 1.0, 300.0f);
 			break;
 		case glpOrtho:
-			glOrtho(-ar, ar, -1.0, 1.0, 0.1, 1000.0);
+			camera->SetOrtho(-ar, ar, -1.0, 1.0, 0.1, 1000.0);
 			break;
 		case glpLookAt:
-			gluLookAt(0.0, 0.0, 3.0, 0.0, 0.0, 0.0, 0.0, 1.0, 0.0);
+			camera->SetProjection(TMatrix4::LookAt(TVector3D(0.0, 0.0, 3.0), TVector3D(), TVector3D(0.0, 1.0, 0.0)));
 			break;
 		default:
-			;
+			return;
 	}
+	glMultMatrixf(camera->GetProjection().Array());
 }
 
 //---------------------------------------------------------------------------
@@ -390,9 +392,10 @@ void wxGLScene::InitialView(void)
 	mouse_x = 0, mouse_y = 0;
 	mouse_x0 = 0, mouse_y0 = 0;
 	// First orientation : (1, 1, 1) en face
-	mouse_Xrot = -135.0, mouse_Yrot = -45.0;
-	mouse_scale = 1.0;
-	Center_Translation = {0.0, 0.0, 0.0};
+	camera->SetOrbit(-135.0, -45.0);
+	camera->SetScale(1.0);
+	camera->SetCenter(TVector3D());
+	camera->EndMotion();
 	display_mode = dmRender;
 }
 
@@ -434,6 +437,7 @@ void wxGLScene::OnSize(wxSizeEvent &event)
 	const wxSize size = event.GetSize() * GetContentScaleFactor();
 
 	glViewport(0, 0, size.x, size.y);
+	camera->SetViewport(0, 0, size.x, size.y);
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
 	UpdateProjection(size.x, size.y);
@@ -463,21 +467,26 @@ void wxGLScene::OnPaint(wxPaintEvent &WXUNUSED(event))
 	// Light if needed
 	light->Render();
 
-	//camera->draw();
+	// Smooth motion of the camera, draw again until the camera stops
+	const wxLongLong now = wxGetLocalTimeMillis();
+	const double dt = (now - lastPaintTime).ToDouble() / 1000.0;
+	lastPaintTime = now;
+	if (camera->Update((dt < 0.05) ? dt : 0.05))
+		Refresh(false);
 
-//	if (redraw_view)
+	// Near and far planes around the objects
+	TVector3D boxMin, boxMax;
+	if (camera->GetAutoDepth() && GetSceneBounds(boxMin, boxMax) && camera->FitDepth(boxMin, boxMax))
 	{
+		glMatrixMode(GL_PROJECTION);
 		glLoadIdentity();
-		glTranslated(0.0, 0.0, -50.0);
-
-		glRotatef(mouse_Yrot, 1.0, 0.0, 0.0);
-		glRotatef(mouse_Xrot, 0.0, 0.0, 1.0);
-
-		glScaled(mouse_scale, mouse_scale, mouse_scale);
-
-		glTranslatef(Center_Translation.X, Center_Translation.Y, Center_Translation.Z);
+		UpdateProjection(camera->GetViewport()[2], camera->GetViewport()[3]);
+		glMatrixMode(GL_MODELVIEW);
 	}
 
+//	if (redraw_view)
+	ApplyView();
+
 	// Display objects
 	if (display_mode == dmSelect)
 	{
@@ -505,6 +514,13 @@ void wxGLScene::OnPaint(wxPaintEvent &WXUNUSED(event))
 	display_running = false;
 }
 
+//---------------------------------------------------------------------------
+// The view of the scene : mouse rotations, zoom and center (see TCamera)
+void wxGLScene::ApplyView(void)
+{
+	glLoadMatrixf(camera->GetView().Array());
+}
+
 //---------------------------------------------------------------------------
 // On picking action. Here we redraw sub window
 void wxGLScene::DoPicking(int mod)
@@ -607,6 +623,25 @@ void wxGLScene::DisplayMousePicking(int x, int y)
 	PickList(buff, hits);
 }
 
+//---------------------------------------------------------------------------
+/**
+ * Intersection of the ray under the mouse (x, y) with a surface (see TSurface::RayIntersect).
+ * Nothing is drawn, the ray is computed with the cached view and projection of the camera.
+ * Return false if the surface is not under the mouse.
+ */
+bool wxGLScene::PickSurface(int x, int y, TSurface *surface, TSurfaceHit &hit)
+{
+	if (surface == NULL)
+		return false;
+
+	// The ray goes from the near plane to the far plane
+	TVector3D origin, direction;
+	if (!camera->GetRay(x, y, origin, direction))
+		return false;
+
+	return surface->RayIntersect(origin, direction, hit);
+}
+
 //---------------------------------------------------------------------------
 void wxGLScene::PickList(GLuint *buffer, GLint hits)
 {
@@ -640,6 +675,67 @@ void wxGLScene::PickList(GLuint *buffer, GLint hits)
 	PickedObject = id_min;
 }
 
+/**
+ * The bounding box of the visible objects in the scene (see TObject3D::GetWorldBounds).
+ * With selection, only the picked object and the selected objects.
+ * Return false if there is no object with a size.
+ */
+bool wxGLScene::GetSceneBounds(TVector3D &boxMin, TVector3D &boxMax, bool selection)
+{
+	bool found = false;
+	TVector3D objMin, objMax;
+
+	for (size_t i = 0; i < ObjectCount; i++)
+	{
+		TObject3D *obj = Object3DList[i];
+		if (!obj->Visible)
+			continue;
+		if (selection && ((GLint) i != PickedObject) && !obj->IsSelected())
+			continue;
+		if (!obj->GetWorldBounds(objMin, objMax))
+			continue;
+
+		if (!found)
+		{
+			boxMin = objMin;
+			boxMax = objMax;
+			found = true;
+		}
+		else
+			for (int k = 0; k < 3; k++)
+			{
+				if (objMin.array[k] < boxMin.array[k]) boxMin.array[k] = objMin.array[k];
+				if (objMax.array[k] > boxMax.array[k]) boxMax.array[k] = objMax.array[k];
+			}
+	}
+	return found;
+}
+
+/**
+ * Center and zoom the view on all the objects
+ */
+void wxGLScene::FrameAll(void)
+{
+	TVector3D boxMin, boxMax;
+	if (GetSceneBounds(boxMin, boxMax))
+		camera->Frame(boxMin, boxMax);
+	Refresh(false);
+}
+
+/**
+ * Center and zoom the view on the picked object and the selected objects.
+ * Return false if nothing is selected.
+ */
+bool wxGLScene::FrameSelection(void)
+{
+	TVector3D boxMin, boxMax;
+	if (!GetSceneBounds(boxMin, boxMax, true))
+		return false;
+	camera->Frame(boxMin, boxMax);
+	Refresh(false);
+	return true;
+}
+
 /**
  * Zoom the scene plus if inc > 0
  */
@@ -650,13 +746,13 @@ void wxGLScene::Zoom(const int inc)
 	if (inc >= 1)
 	{
 		for (i = 1; i <= inc; i++)
-			mouse_scale *= ZOOM_FACTOR_PLUS;
+			camera->Zoom(ZOOM_FACTOR_PLUS);
 	}
 	else
 		if (inc <= 1)
 		{
 			for (i = 1; i <= -inc; i++)
-				mouse_scale *= ZOOM_FACTOR_MINUS;
+				camera->Zoom(ZOOM_FACTOR_MINUS);
 		}
 }
 
@@ -665,7 +761,7 @@ void wxGLScene::Zoom(const int inc)
  */
 void wxGLScene::CenterUpDown(const GLfloat incZ)
 {
-	Center_Translation.Z += incZ;
+	camera->SetCenter(camera->GetCenter() + TVector3D(0.0, 0.0, incZ));
 }
 
 /**
@@ -673,7 +769,7 @@ void wxGLScene::CenterUpDown(const GLfloat incZ)
  */
 void wxGLScene::UpDown(const GLfloat incY)
 {
-	mouse_Yrot -= incY;
+	camera->Turn(0.0, -incY);
 }
 
 /**
@@ -681,7 +777,7 @@ void wxGLScene::UpDown(const GLfloat incY)
  */
 void wxGLScene::LeftRight(const GLfloat incX)
 {
-	mouse_Xrot += incX;
+	camera->Turn(incX, 0.0);
 }
 
 /* ================================================================== */
@@ -724,6 +820,16 @@ void wxGLScene::OnChar(wxKeyEvent &event)
 			Zoom(-1);
 			break;
 
+		case WXK_HOME:
+			FrameAll();
+			break;
+
+		case 'f':
+		case 'F':
+			if (!FrameSelection())
+				FrameAll();
+			break;
+
 		case 'l':
 		case 'L':
 			light->SetLightColor(lcModelAmbient, 0.1f);
@@ -789,8 +895,7 @@ void wxGLScene::OnMouseMoved(wxMouseEvent &event)
 		}
 		else
 		{
-			mouse_Xrot += event.GetX() - last_x;
-			mouse_Yrot += event.GetY() - last_y;
+			camera->Drag(last_x, last_y, event.GetX(), event.GetY());
 			Refresh(false);
 		}
 		last_x = event.GetX();
@@ -814,7 +919,7 @@ void wxGLScene::OnMouseWheelMoved(wxMouseEvent &event)
 	event.Skip();
 	float factor = (event.GetWheelRotation() > 0) ? ZOOM_FACTOR_PLUS : ZOOM_FACTOR_MINUS;
 
-	mouse_scale *= factor;
+	camera->Zoom(factor);
 	Refresh(true);
 }
 
@@ -19,6 +19,7 @@
 
 #include "Light.h"
 #include "Camera.h"
+#include "Surface.h"
 
 #ifdef USE_FFMPEG
 #include "ffmpeg_encoder.h"
@@ -83,8 +84,8 @@ class wxGLScene: public wxGLCanvas
 		bool PolygonModeLine = false;
 		bool IsFullScreen = false;
 
-		TVector3D Center_Translation;
 		int mouse_x = 0, mouse_y = 0;
+		wxLongLong lastPaintTime = 0;
 
 		bool timmerRunning = false;
 
@@ -99,11 +100,9 @@ class wxGLScene: public wxGLCanvas
 		// For mouse move
 		bool mouse_dragging = false;
 		int mouse_x0 = 0, mouse_y0 = 0;
-		GLfloat mouse_Xrot = 0.0, mouse_Yrot = 0.0;
-		GLfloat mouse_scale = 0.0;
 
 		TLight *light;
-//    TCamera *camera;
+		TCamera *camera;
 
 		size_t ObjectCount;
 		TObject3DVector Object3DList;
@@ -112,6 +111,7 @@ class wxGLScene: public wxGLCanvas
 
 		/// restore initial parameters
 		void InitialView(void);
+		void ApplyView(void);
 		virtual void UpdateProjection(int width, int height);
 
 		// Picking
@@ -120,6 +120,7 @@ class wxGLScene: public wxGLCanvas
 		void DisplayMousePicking(int x, int y);
 		virtual void DoPicking(int mod);
 		void PickList(GLuint *buffer, GLint hits);
+		bool PickSurface(int x, int y, TSurface *surface, TSurfaceHit &hit);
 
 		virtual bool OnPicking(int mod, TObject3D *Old, TObject3D *New);
 		virtual wxString GetInfoPicking(void);
@@ -149,7 +150,24 @@ class wxGLScene: public wxGLCanvas
 		// Set the center of the scene
 		void SetCenter(const TVector3D &pos)
 		{
-			Center_Translation = pos;
+			camera->SetCenter(pos);
+		}
+
+		// The camera : mode (orbit, arcball, fly), damping, matrices of the view
+		TCamera* GetCamera()
+		{
+			return camera;
+		}
+
+		// Fit the view to the objects
+		bool GetSceneBounds(TVector3D &boxMin, TVector3D &boxMax, bool selection = false);
+		void FrameAll(void);
+		bool FrameSelection(void);
+		// Near and far planes fitted to the objects at each display
+		void SetAutoDepth(bool automatic)
+		{
+			camera->SetAutoDepth(automatic);
+			Refresh(false);
 		}
 
 		int GetWidth() const